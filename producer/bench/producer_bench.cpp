@@ -0,0 +1,127 @@
+// Per-row cost of the producer API on a solver's hot loop, next to the
+// printf it replaces. Build with -DRTPLOTTER_PRODUCER_BENCH=ON, then run
+//   ./rtplotter_producer_bench [rows] [columns]
+#include "rtplotter/Producer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<std::string> columnNames(size_t columns)
+    {
+        std::vector<std::string> names;
+        for (size_t c = 0; c < columns; ++c) names.push_back(c == 0 ? "time" : "probe" + std::to_string(c));
+        return names;
+    }
+
+    // Runs `push` for every row and returns nanoseconds per row
+    template<class Push>
+    double timeRows(long rows, size_t columns, Push push)
+    {
+        std::vector<double> row(columns);
+        const Clock::time_point start = Clock::now();
+        for (long r = 0; r < rows; ++r) {
+            row[0] = double(r);
+            for (size_t c = 1; c < columns; ++c) row[c] = row[0] * 1e-3 + double(c);
+            push(row.data());
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(rows);
+    }
+
+    // Stands in for RTPlotter: copies the records out as SharedRingSource does
+    void drainRing(const std::string& name, std::atomic<bool>& done)
+    {
+        const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return;
+        struct stat info;
+        ::fstat(fd, &info);
+        void* base = ::mmap(nullptr, size_t(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        SharedRingHeader* header = static_cast<SharedRingHeader*>(base);
+        const double* records = reinterpret_cast<const double*>(static_cast<char*>(base) + header->recordsOffset);
+        std::vector<double> sink(header->capacity * header->columnCount);
+        for (;;) {
+            const bool last = done.load();
+            const uint64_t head = header->head.load(std::memory_order_acquire);
+            const uint64_t tail = header->tail.load(std::memory_order_relaxed);
+            if (head == tail) {
+                if (last) break;
+                std::this_thread::yield();
+                continue;
+            }
+            const uint64_t slot = tail % header->capacity;
+            const uint64_t count = std::min(head - tail, header->capacity - slot);
+            std::memcpy(sink.data(), records + slot * header->columnCount, count * header->columnCount * sizeof(double));
+            header->tail.store(tail + count, std::memory_order_release);
+        }
+        ::munmap(base, size_t(info.st_size));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const long rows = argc > 1 ? std::atol(argv[1]) : 5000000;
+    const size_t columns = argc > 2 ? size_t(std::atol(argv[2])) : 8;
+    const std::vector<std::string> names = columnNames(columns);
+    std::printf("%ld rows of %zu doubles\n\n", rows, columns);
+    std::printf("%-36s %10s\n", "", "ns/row");
+
+    // The text RTPlotter would otherwise parse
+    {
+        FILE* out = std::fopen("/tmp/rtplotter_bench.csv", "w");
+        const double ns = timeRows(rows, columns, [&](const double* row) {
+            for (size_t c = 0; c < columns; ++c) std::fprintf(out, c + 1 < columns ? "%.9g," : "%.9g\n", row[c]);
+        });
+        std::fclose(out);
+        std::remove("/tmp/rtplotter_bench.csv");
+        std::printf("%-36s %10.1f\n", "fprintf CSV row", ns);
+    }
+
+    {
+        rtplotter::LogProducer log;
+        if (!log.open("/tmp/rtplotter_bench.rtlog", names)) {
+            std::fprintf(stderr, "log: %s\n", log.error().c_str());
+            return 1;
+        }
+        const double ns = timeRows(rows, columns, [&](const double* row) { log.push(row); });
+        log.close();
+        std::remove("/tmp/rtplotter_bench.rtlog");
+        std::printf("%-36s %10.1f\n", "LogProducer::push (batched writes)", ns);
+    }
+
+    {
+        const std::string name = "/rtplotter_bench";
+        rtplotter::RingProducer ring;
+        if (!ring.create(name, names, 1 << 16)) {
+            std::fprintf(stderr, "ring: %s\n", ring.error().c_str());
+            return 1;
+        }
+        std::atomic<bool> done(false);
+        std::thread viewer(drainRing, name, std::ref(done));
+        const double ns = timeRows(rows, columns, [&](const double* row) { ring.push(row); });
+        done = true;
+        viewer.join();
+        ring.close();
+        ring.unlink();
+        std::printf("%-36s %10.1f\n", "RingProducer::push, viewer draining", ns);
+    }
+
+    {
+        const std::string name = "/rtplotter_bench";
+        rtplotter::RingProducer ring;
+        ring.create(name, names, 1 << 16, rtplotter::RingProducer::DropWhenFull);
+        const double ns = timeRows(rows, columns, [&](const double* row) { ring.push(row); });
+        std::printf("%-36s %10.1f  (%llu dropped)\n", "RingProducer::push, no viewer", ns, (unsigned long long)ring.dropped());
+        ring.close();
+        ring.unlink();
+    }
+    return 0;
+}
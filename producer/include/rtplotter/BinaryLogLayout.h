@@ -0,0 +1,38 @@
+#ifndef RTPLOTTER_BINARYLOGLAYOUT_H
+#define RTPLOTTER_BINARYLOGLAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the append-only binary log (.rtlog) written by
+// rtplotter::LogProducer and read by CSVReader. No Qt: producers include it
+// as is.
+//
+//   BinaryLogHeader | column names | records
+//
+// The names are columnCount slots of kNameBytes, NUL padded. A record is
+// columnCount doubles in the byte order of the writer; records are only
+// appended, so a reader takes the whole records present and leaves a
+// partial last one for its next read.
+struct BinaryLogHeader
+{
+    static constexpr char kMagic[8] = { 'R', 'T', 'P', 'L', 'O', 'G', '\r', '\n' };
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kNameBytes = 64;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t columnCount;
+    // Byte offset of the first record
+    uint64_t recordsOffset;
+
+    static uint64_t namesOffset() { return sizeof(BinaryLogHeader); }
+    // Records start on a 64-byte boundary after the names
+    static uint64_t recordsOffsetFor(uint32_t columnCount)
+    {
+        const uint64_t end = namesOffset() + uint64_t(columnCount) * kNameBytes;
+        return (end + 63) / 64 * 64;
+    }
+};
+
+#endif // RTPLOTTER_BINARYLOGLAYOUT_H
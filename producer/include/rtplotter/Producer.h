@@ -0,0 +1,295 @@
+#ifndef RTPLOTTER_PRODUCER_H
+#define RTPLOTTER_PRODUCER_H
+
+#include "rtplotter/SharedRingLayout.h"
+#include "rtplotter/BinaryLogLayout.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Header-only producer side of RTPlotter's binary inputs, for solvers: no Qt,
+// and no allocation, lock or system call per row on the hot loop.
+//
+//   rtplotter::RingProducer ring;
+//   ring.create("/solver", {"time", "p", "U"});
+//   for (...) ring.push({time, p, U});
+//
+// RingProducer writes the shared-memory ring read by `RTPlotter --shm`;
+// LogProducer appends to a binary log (.rtlog) that RTPlotter opens and
+// tails like a CSV file. Each is used from one thread. POSIX only.
+namespace rtplotter {
+
+class RingProducer
+{
+public:
+    // What push() does while the viewer has not freed a slot
+    enum FullPolicy { WaitWhenFull, DropWhenFull };
+
+    RingProducer() = default;
+    ~RingProducer() { close(); }
+    RingProducer(const RingProducer&) = delete;
+    RingProducer& operator=(const RingProducer&) = delete;
+
+    // Creates the ring `name` ("/solver") for `capacity` records, replacing
+    // any ring left under that name. With WaitWhenFull the solver stalls once
+    // `capacity` records are pending and no viewer reads them.
+    bool create(const std::string& name, const std::vector<std::string>& columns,
+                uint64_t capacity = 1 << 16, FullPolicy policy = WaitWhenFull)
+    {
+        close();
+        m_error.clear();
+        if (columns.empty() || capacity == 0) return fail("no columns or no capacity");
+        const uint32_t columnCount = uint32_t(columns.size());
+        ::shm_unlink(name.c_str());
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) return fail(std::strerror(errno));
+        const size_t bytes = size_t(SharedRingHeader::byteSize(columnCount, capacity));
+        if (::ftruncate(fd, off_t(bytes)) != 0) {
+            ::close(fd);
+            return fail(std::strerror(errno));
+        }
+        void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) return fail(std::strerror(errno));
+
+        // The object is zero-filled: magic stays 0 until the ring is ready
+        m_header = static_cast<SharedRingHeader*>(base);
+        m_header->version = SharedRingHeader::kVersion;
+        m_header->columnCount = columnCount;
+        m_header->capacity = capacity;
+        m_header->recordsOffset = SharedRingHeader::recordsOffsetFor(columnCount);
+        m_header->head.store(0, std::memory_order_relaxed);
+        m_header->closed.store(0, std::memory_order_relaxed);
+        m_header->tail.store(0, std::memory_order_relaxed);
+        char* names = static_cast<char*>(base) + SharedRingHeader::namesOffset();
+        for (uint32_t c = 0; c < columnCount; ++c) {
+            std::strncpy(names + c * SharedRingHeader::kNameBytes, columns[c].c_str(), SharedRingHeader::kNameBytes - 1);
+        }
+
+        m_name = name;
+        m_bytes = bytes;
+        m_records = reinterpret_cast<double*>(static_cast<char*>(base) + m_header->recordsOffset);
+        m_columnCount = columnCount;
+        m_capacity = capacity;
+        m_policy = policy;
+        m_head = 0;
+        m_freeUntil = capacity;
+        m_dropped = 0;
+        m_header->magic.store(SharedRingHeader::kMagic, std::memory_order_release);
+        return true;
+    }
+
+    // Copies one record of columnCount() values and publishes it; false when
+    // the ring was full (DropWhenFull) or is closed
+    bool push(const double* values)
+    {
+        if (m_head == m_freeUntil && !waitForSlot()) {
+            ++m_dropped;
+            return false;
+        }
+        std::memcpy(m_records + (m_head % m_capacity) * m_columnCount, values, m_columnCount * sizeof(double));
+        m_header->head.store(++m_head, std::memory_order_release);
+        return true;
+    }
+    bool push(std::initializer_list<double> values)
+    {
+        return values.size() == m_columnCount && push(values.begin());
+    }
+
+    // Tells the viewer that no record follows. The ring stays readable until
+    // unlink(), so a viewer still drains the last records.
+    void close()
+    {
+        if (!m_header) return;
+        m_header->closed.store(1, std::memory_order_release);
+        ::munmap(m_header, m_bytes);
+        m_header = nullptr;
+        m_records = nullptr;
+        m_freeUntil = m_head;
+    }
+    // Removes the name; viewers already attached keep their mapping
+    void unlink()
+    {
+        if (!m_name.empty()) ::shm_unlink(m_name.c_str());
+    }
+
+    size_t columnCount() const { return m_columnCount; }
+    uint64_t pushed() const { return m_head; }
+    uint64_t dropped() const { return m_dropped; }
+    const std::string& error() const { return m_error; }
+
+private:
+    SharedRingHeader* m_header = nullptr;
+    double* m_records = nullptr;
+    size_t m_bytes = 0;
+    size_t m_columnCount = 0;
+    uint64_t m_capacity = 0;
+    FullPolicy m_policy = WaitWhenFull;
+    // Records published, and the head up to which slots are known to be free
+    uint64_t m_head = 0;
+    uint64_t m_freeUntil = 0;
+    uint64_t m_dropped = 0;
+    std::string m_name;
+    std::string m_error;
+
+    // The viewer's tail is loaded only when the cached one says full, so
+    // push() reads the consumer's cache line about once per lap of the ring
+    bool waitForSlot()
+    {
+        if (!m_header) return false;
+        for (;;) {
+            m_freeUntil = m_header->tail.load(std::memory_order_acquire) + m_capacity;
+            if (m_head < m_freeUntil) return true;
+            if (m_policy == DropWhenFull) return false;
+            std::this_thread::yield();
+        }
+    }
+
+    bool fail(const char* message)
+    {
+        m_error = message;
+        return false;
+    }
+};
+
+class LogProducer
+{
+public:
+    LogProducer() = default;
+    ~LogProducer() { close(); }
+    LogProducer(const LogProducer&) = delete;
+    LogProducer& operator=(const LogProducer&) = delete;
+
+    // Creates (truncates) the log at `path`. Records are written in batches
+    // of `batchRecords`, and at the latest `flushInterval` after the previous
+    // write while rows keep coming; call flush() before a long pause.
+    bool open(const std::string& path, const std::vector<std::string>& columns,
+              size_t batchRecords = 4096,
+              std::chrono::milliseconds flushInterval = std::chrono::milliseconds(250))
+    {
+        close();
+        m_error.clear();
+        if (columns.empty() || batchRecords == 0) return fail("no columns or no batch");
+        const uint32_t columnCount = uint32_t(columns.size());
+        m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (m_fd < 0) return fail(std::strerror(errno));
+
+        std::vector<char> header(size_t(BinaryLogHeader::recordsOffsetFor(columnCount)), '\0');
+        BinaryLogHeader fixed;
+        std::memcpy(fixed.magic, BinaryLogHeader::kMagic, sizeof(fixed.magic));
+        fixed.version = BinaryLogHeader::kVersion;
+        fixed.columnCount = columnCount;
+        fixed.recordsOffset = header.size();
+        std::memcpy(header.data(), &fixed, sizeof(fixed));
+        char* names = header.data() + BinaryLogHeader::namesOffset();
+        for (uint32_t c = 0; c < columnCount; ++c) {
+            std::strncpy(names + c * BinaryLogHeader::kNameBytes, columns[c].c_str(), BinaryLogHeader::kNameBytes - 1);
+        }
+        if (!writeAll(header.data(), header.size())) {
+            close();
+            return false;
+        }
+
+        m_columnCount = columnCount;
+        m_batch.assign(batchRecords * columnCount, 0.0);
+        m_used = 0;
+        m_flushInterval = flushInterval;
+        m_lastWrite = m_lastClock = Clock::now();
+        m_clockStride = m_untilClock = 1;
+        return true;
+    }
+
+    // Copies one record of columnCount() values into the batch; false when a
+    // write failed (see error())
+    bool push(const double* values)
+    {
+        std::memcpy(m_batch.data() + m_used, values, m_columnCount * sizeof(double));
+        m_used += m_columnCount;
+        if (m_used == m_batch.size()) return flush();
+        if (--m_untilClock == 0) return checkClock();
+        return true;
+    }
+    bool push(std::initializer_list<double> values)
+    {
+        return values.size() == m_columnCount && push(values.begin());
+    }
+
+    // Writes the batched records; RTPlotter sees them on its next read
+    bool flush()
+    {
+        const bool written = m_fd >= 0 && writeAll(m_batch.data(), m_used * sizeof(double));
+        m_used = 0;
+        m_lastWrite = Clock::now();
+        return written;
+    }
+    void close()
+    {
+        if (m_fd < 0) return;
+        if (m_used > 0) flush();
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    size_t columnCount() const { return m_columnCount; }
+    const std::string& error() const { return m_error; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    // Rows between two clock reads, at most
+    static constexpr unsigned kMaxClockStride = 1024;
+
+    int m_fd = -1;
+    size_t m_columnCount = 0;
+    std::vector<double> m_batch;
+    size_t m_used = 0;
+    std::chrono::milliseconds m_flushInterval{250};
+    Clock::time_point m_lastWrite;
+    Clock::time_point m_lastClock;
+    unsigned m_clockStride = 1;
+    unsigned m_untilClock = 1;
+    std::string m_error;
+
+    // Fast loops read the clock every few hundred rows, slow ones on every
+    // row, so a slow solver's rows are not held back for long
+    bool checkClock()
+    {
+        const Clock::time_point now = Clock::now();
+        const bool fast = now - m_lastClock < m_flushInterval / 16;
+        m_clockStride = fast ? std::min(m_clockStride * 2, kMaxClockStride) : std::max(m_clockStride / 2, 1u);
+        m_untilClock = m_clockStride;
+        m_lastClock = now;
+        return now - m_lastWrite >= m_flushInterval ? flush() : true;
+    }
+
+    bool writeAll(const void* data, size_t bytes)
+    {
+        const char* next = static_cast<const char*>(data);
+        while (bytes > 0) {
+            const ssize_t count = ::write(m_fd, next, bytes);
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) return fail(std::strerror(errno));
+            next += count;
+            bytes -= size_t(count);
+        }
+        return true;
+    }
+
+    bool fail(const char* message)
+    {
+        m_error = message;
+        return false;
+    }
+};
+
+} // namespace rtplotter
+
+#endif // RTPLOTTER_PRODUCER_H
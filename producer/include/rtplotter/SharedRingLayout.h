@@ -0,0 +1,64 @@
+#ifndef RTPLOTTER_SHAREDRINGLAYOUT_H
+#define RTPLOTTER_SHAREDRINGLAYOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the POSIX shared-memory ring a solver writes binary records to
+// (rtplotter::RingProducer) and SharedRingSource reads. No Qt: producers
+// include it as is.
+//
+//   SharedRingHeader | column names | records
+//
+// The producer creates the object (shm_open name such as "/solver"), fills
+// the header and the names (columnCount slots of kNameBytes, NUL padded),
+// then stores magic last. A record is columnCount doubles; record i lives in
+// slot i % capacity. One producer and one consumer, no locks:
+//  - the producer copies a record into slot head % capacity, then stores
+//    head + 1 (release); it waits or drops while head - tail == capacity
+//  - the consumer loads head (acquire), copies records [tail, head) out,
+//    then stores the new tail (release) to free their slots
+// Both indices only grow, so head - tail is the number of pending records.
+struct SharedRingHeader
+{
+    // "RTPR" in memory on little-endian hosts
+    static constexpr uint32_t kMagic = 0x52505452;
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kNameBytes = 64;
+
+    // Stored last (release), so a consumer that sees it sees the rest
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t columnCount;
+    uint32_t reserved;
+    // Records the ring holds
+    uint64_t capacity;
+    // Byte offset of slot 0 from the start of the object
+    uint64_t recordsOffset;
+
+    // Written by the producer only; the consumer's index is on another
+    // cache line so the two sides do not invalidate each other's
+    alignas(64) std::atomic<uint64_t> head;
+    // Set once the producer is done: the consumer stops after the last record
+    std::atomic<uint32_t> closed;
+    alignas(64) std::atomic<uint64_t> tail;
+
+    static uint64_t namesOffset() { return sizeof(SharedRingHeader); }
+    // Slot 0 starts on a cache line after the names
+    static uint64_t recordsOffsetFor(uint32_t columnCount)
+    {
+        const uint64_t end = namesOffset() + uint64_t(columnCount) * kNameBytes;
+        return (end + 63) / 64 * 64;
+    }
+    static uint64_t byteSize(uint32_t columnCount, uint64_t capacity)
+    {
+        return recordsOffsetFor(columnCount) + capacity * columnCount * sizeof(double);
+    }
+};
+
+// The indices are shared between processes: they must not hide a lock
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "32-bit atomics must be lock-free");
+
+#endif // RTPLOTTER_SHAREDRINGLAYOUT_H
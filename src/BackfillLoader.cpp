@@ -0,0 +1,298 @@
+#include "BackfillLoader.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+#include <limits>
+
+namespace {
+    // First chunk size; each following chunk is twice as large up to the cap
+    const qint64 kInitialChunkBytes = 4 * 1024 * 1024;
+    const qint64 kMaximumChunkBytes = 256 * 1024 * 1024;
+    // Chunks are read and parsed in slices so that a cancel takes effect quickly
+    const qint64 kSliceBytes = 4 * 1024 * 1024;
+}
+
+void BackfillWorker::readChunk(int generation, const CSVReader& settings, int columnCount, qint64 dataOffset, qint64 end, qint64 maxBytes)
+{
+    QFile file(settings.getFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open file:" << settings.getFilePath();
+        emit chunkFailed(generation);
+        return;
+    }
+
+    // Move forward to a row boundary; a line longer than the chunk widens it
+    qint64 start = qMax(dataOffset, end - maxBytes);
+    while (start > dataOffset) {
+        file.seek(start - 1);
+        QByteArray bytes = file.read(qMin<qint64>(end - start + 1, 64 * 1024));
+        int newline = bytes.indexOf('\n');
+        if (newline >= 0) {
+            start += newline;
+            break;
+        }
+        start = qMax(dataOffset, start - maxBytes);
+    }
+
+    file.seek(start);
+    QVector<QVector<double>> columns;
+    QVector<int> headerRows;
+    QStringList addedHeader;
+    QByteArray pending;
+    qint64 position = start;
+    while (position < end) {
+        if (m_activeGeneration->loadAcquire() != generation) return; // superseded
+        QByteArray slice = file.read(qMin(kSliceBytes, end - position));
+        if (slice.isEmpty()) {
+            emit chunkFailed(generation);
+            return;
+        }
+        position += slice.size();
+        pending.append(slice);
+
+        // Only whole lines are parsed; the remainder waits for the next slice
+        int cut = position < end ? pending.lastIndexOf('\n') + 1 : pending.size();
+        QVector<QVector<double>> part;
+        QVector<int> partHeaderRows;
+        settings.parseRows(pending.left(cut), columnCount, part, &partHeaderRows, &addedHeader);
+        pending.remove(0, cut);
+        const int rowsBefore = columns.isEmpty() ? 0 : columns.at(0).size();
+        for (int row : partHeaderRows) headerRows.append(rowsBefore + row);
+        if (columns.isEmpty()) {
+            columns = part;
+        } else {
+            // A slice may add columns; the rows before it are gaps there
+            while (columns.size() < part.size()) columns.append(QVector<double>(rowsBefore, std::numeric_limits<double>::quiet_NaN()));
+            for (int c = 0; c < columns.size() && c < part.size(); ++c) columns[c] += part.at(c);
+        }
+        columnCount = qMax(columnCount, int(columns.size()));
+    }
+    emit chunkReady(generation, start, columns, headerRows, addedHeader);
+}
+
+void BackfillWorker::readWhole(int generation, const CSVReader& reader)
+{
+    CSVReader whole = reader;
+    // Stops between chunks once superseded
+    const bool parsed = whole.parse([&](qint64 bytes, qint64 totalBytes) {
+        if (m_activeGeneration->loadAcquire() != generation) return false;
+        emit wholeProgress(generation, bytes, totalBytes, whole.getRowCount());
+        return true;
+    });
+    if (m_activeGeneration->loadAcquire() != generation) return;
+    if (parsed) emit wholeReady(generation, whole);
+    else emit chunkFailed(generation);
+}
+
+BackfillLoader::BackfillLoader(QObject *parent) : QObject(parent),
+    m_reader(nullptr),
+    m_generation(0),
+    m_activeGeneration(0),
+    m_nextEnd(0),
+    m_splicedOffset(0),
+    m_pendingRows(0),
+    m_columnCount(0),
+    m_chunkBytes(kInitialChunkBytes),
+    m_startOffset(0),
+    m_firstOffset(0),
+    m_loadedRows(0)
+{
+    m_worker = new BackfillWorker(&m_activeGeneration);
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(this, &BackfillLoader::requestChunk, m_worker, &BackfillWorker::readChunk);
+    connect(this, &BackfillLoader::requestWhole, m_worker, &BackfillWorker::readWhole);
+    connect(m_worker, &BackfillWorker::chunkReady, this, &BackfillLoader::onChunkReady);
+    connect(m_worker, &BackfillWorker::chunkFailed, this, &BackfillLoader::onChunkFailed);
+    connect(m_worker, &BackfillWorker::wholeProgress, this, &BackfillLoader::onWholeProgress);
+    connect(m_worker, &BackfillWorker::wholeReady, this, &BackfillLoader::onWholeReady);
+    m_thread.start();
+}
+
+BackfillLoader::~BackfillLoader()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void BackfillLoader::start(CSVReader* reader)
+{
+    cancel();
+    if (!reader || reader->isComplete()) return;
+    m_reader = reader;
+    // The worker only needs the parser settings, not the loaded columns
+    m_settings = CSVReader();
+    m_settings.fromJson(reader->toJson());
+    m_loadedRows = 0;
+    m_clock.start();
+    if (reader->isHeaderOnly()) {
+        // Offsets count compressed bytes, from the start of the file
+        m_startOffset = m_nextEnd = QFileInfo(reader->getFilePath()).size();
+        m_firstOffset = 0;
+        qDebug() << "Background parse started:" << reader->getFilePath();
+        emit requestWhole(m_generation, *reader);
+        return;
+    }
+    m_chunkBytes = kInitialChunkBytes;
+    m_startOffset = reader->getLoadedOffset();
+    m_nextEnd = m_splicedOffset = reader->getLoadedOffset();
+    m_firstOffset = reader->getDataOffset();
+    m_columnCount = reader->getRawHeaders().size();
+    qDebug() << "Backfill started:" << reader->getFilePath() << "from byte" << reader->getLoadedOffset();
+    requestNext();
+}
+
+void BackfillLoader::cancel()
+{
+    // Chunks still queued or in flight carry the old generation and are dropped
+    ++m_generation;
+    m_activeGeneration.storeRelease(m_generation);
+    m_pending.clear();
+    m_pendingRows = 0;
+    if (m_reader) {
+        m_reader = nullptr;
+        emit finished();
+    }
+}
+
+void BackfillLoader::stop()
+{
+    if (!m_reader) return;
+    if (!m_pending.isEmpty() && m_reader->getLoadedOffset() == m_splicedOffset) {
+        splice();
+        emit rowsPrepended();
+    }
+    cancel();
+}
+
+void BackfillLoader::requestNext()
+{
+    emit requestChunk(m_generation, m_settings, m_columnCount, m_reader->getDataOffset(), m_nextEnd, m_chunkBytes);
+}
+
+void BackfillLoader::splice()
+{
+    QStringList addedHeader;
+    for (const Chunk& chunk : m_pending) {
+        if (chunk.addedHeader.size() > addedHeader.size()) addedHeader = chunk.addedHeader;
+    }
+    // Oldest chunk first; columns a chunk does not have are gaps there
+    QVector<QVector<double>> columns(m_columnCount);
+    for (QVector<double>& column : columns) column.reserve(m_pendingRows);
+    QVector<int> headerRows;
+    int rows = 0;
+    for (int i = m_pending.size() - 1; i >= 0; --i) {
+        const Chunk& chunk = m_pending.at(i);
+        const int chunkRows = chunk.columns.isEmpty() ? 0 : chunk.columns.at(0).size();
+        for (int row : chunk.headerRows) headerRows.append(rows + row);
+        for (int c = 0; c < columns.size(); ++c) {
+            if (c < chunk.columns.size()) columns[c] += chunk.columns.at(c);
+            else columns[c].insert(columns[c].size(), chunkRows, std::numeric_limits<double>::quiet_NaN());
+        }
+        rows += chunkRows;
+    }
+    m_pending.clear();
+    m_pendingRows = 0;
+    m_reader->prependRows(columns, headerRows, addedHeader, m_nextEnd);
+    m_splicedOffset = m_nextEnd;
+}
+
+void BackfillLoader::onChunkReady(int generation, qint64 start, const QVector<QVector<double>>& columns, const QVector<int>& headerRows, const QStringList& addedHeader)
+{
+    if (generation != m_generation || !m_reader) return;
+    // A reparse (truncation, new settings) moves the loaded range: stop quietly
+    if (m_reader->getLoadedOffset() != m_splicedOffset) {
+        cancel();
+        return;
+    }
+
+    const int rows = columns.isEmpty() ? 0 : columns.at(0).size();
+    Chunk chunk;
+    chunk.columns = columns;
+    chunk.headerRows = headerRows;
+    chunk.addedHeader = addedHeader;
+    m_pending.append(chunk);
+    m_pendingRows += rows;
+    m_loadedRows += rows;
+    m_columnCount = qMax(m_columnCount, int(columns.size()));
+    m_nextEnd = start;
+    const bool complete = m_nextEnd <= m_reader->getDataOffset();
+    qint64 total = QFileInfo(m_reader->getFilePath()).size() - m_reader->getDataOffset();
+    emit progress(total - (m_nextEnd - m_reader->getDataOffset()), total);
+
+    // Splicing once the held-back rows outnumber the loaded ones at least
+    // doubles the reader each time
+    if (complete || m_pendingRows >= m_reader->getRowCount()) {
+        splice();
+        emit rowsPrepended();
+        if (!m_reader || generation != m_generation) return; // cancelled by a receiver
+    }
+    if (complete) {
+        qDebug() << "Backfill finished:" << m_reader->getFilePath() << m_reader->getRowCount() << "rows";
+        m_reader = nullptr;
+        emit finished();
+        return;
+    }
+    m_chunkBytes = qMin(2 * m_chunkBytes, kMaximumChunkBytes);
+    requestNext();
+}
+
+double BackfillLoader::bytesPerSecond() const
+{
+    if (!m_reader || m_clock.elapsed() <= 0) return 0.0;
+    return (m_startOffset - m_nextEnd) * 1000.0 / m_clock.elapsed();
+}
+
+double BackfillLoader::rowsPerSecond() const
+{
+    if (!m_reader || m_clock.elapsed() <= 0) return 0.0;
+    return m_loadedRows * 1000.0 / m_clock.elapsed();
+}
+
+double BackfillLoader::remainingSeconds() const
+{
+    double rate = bytesPerSecond();
+    if (rate <= 0.0) return -1.0;
+    return (m_nextEnd - m_firstOffset) / rate;
+}
+
+void BackfillLoader::onWholeProgress(int generation, qint64 bytes, qint64 totalBytes, int rows)
+{
+    if (generation != m_generation || !m_reader) return;
+    m_startOffset = totalBytes;
+    m_nextEnd = totalBytes - qMin(bytes, totalBytes);
+    m_loadedRows = rows;
+    emit progress(totalBytes - m_nextEnd, totalBytes);
+}
+
+void BackfillLoader::onWholeReady(int generation, const CSVReader& reader)
+{
+    if (generation != m_generation || !m_reader) return;
+    // A reparse or another file replaced the header-only reader: stop quietly
+    if (!m_reader->isHeaderOnly() || m_reader->getFilePath() != reader.getFilePath()) {
+        cancel();
+        return;
+    }
+    // Derived channels and the segment key may have changed meanwhile
+    const QList<DerivedChannel> channels = m_reader->getDerivedChannels();
+    const QString segmentKey = m_reader->getSegmentKey();
+    const bool sameChannels = derivedChannelsToJson(channels) == derivedChannelsToJson(reader.getDerivedChannels());
+    *m_reader = reader;
+    if (!sameChannels) m_reader->setDerivedChannels(channels);
+    m_reader->setSegmentKey(segmentKey);
+    m_loadedRows = m_reader->getRowCount();
+    m_nextEnd = 0;
+    emit progress(m_startOffset, m_startOffset);
+    emit rowsPrepended();
+    if (!m_reader || generation != m_generation) return; // cancelled by a receiver
+    qDebug() << "Background parse finished:" << m_reader->getFilePath() << m_reader->getRowCount() << "rows";
+    m_reader = nullptr;
+    emit finished();
+}
+
+void BackfillLoader::onChunkFailed(int generation)
+{
+    if (generation != m_generation) return;
+    qWarning() << "Backfill stopped: could not read" << m_settings.getFilePath();
+    cancel();
+}
@@ -0,0 +1,118 @@
+#ifndef BACKFILLLOADER_H
+#define BACKFILLLOADER_H
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include "CSVReader.h"
+
+// Reads and parses one byte range ending at a row boundary, off the GUI thread
+class BackfillWorker : public QObject
+{
+    Q_OBJECT
+public:
+    // A chunk stops between slices once `activeGeneration` moves past it
+    explicit BackfillWorker(const QAtomicInt* activeGeneration) : m_activeGeneration(activeGeneration) {}
+
+public slots:
+    // Parses the rows of [start, end), where start is moved forward to the
+    // first line break at or after end - maxBytes (but not before dataOffset)
+    void readChunk(int generation, const CSVReader& settings, int columnCount, qint64 dataOffset, qint64 end, qint64 maxBytes);
+    // Parses a file that can only be read from its start (a compressed
+    // file, a binary log) with the settings and derived channels of `reader`
+    void readWhole(int generation, const CSVReader& reader);
+
+signals:
+    // `headerRows`: rows of the chunk that follow a repeated header line;
+    // `addedHeader`: names of a header line that added columns, if any
+    void chunkReady(int generation, qint64 start, const QVector<QVector<double>>& columns, const QVector<int>& headerRows, const QStringList& addedHeader);
+    void chunkFailed(int generation);
+    // Compressed bytes read by readWhole() so far, and the rows they held
+    void wholeProgress(int generation, qint64 bytes, qint64 totalBytes, int rows);
+    void wholeReady(int generation, const CSVReader& reader);
+
+private:
+    const QAtomicInt* m_activeGeneration;
+};
+
+// Loads the history of a tail-first open (CSVReader::parseTail) in reverse
+// chunks, newest first. Chunks are parsed on a worker thread and held back
+// until they hold as many rows as the reader; they are then prepended in one
+// splice. Each row is thus copied a bounded number of times and consumers
+// rebuild O(log n) times over the whole load. A reader opened header-only
+// (CSVReader::isHeaderOnly) is parsed whole on the worker instead, and its
+// rows replace the reader's in one step.
+class BackfillLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BackfillLoader(QObject *parent = nullptr);
+    ~BackfillLoader();
+
+    // Starts loading the rows before reader->getLoadedOffset(), or all of
+    // them for a header-only reader
+    void start(CSVReader* reader);
+    // Drops chunks in flight and held back; emits finished() if a load was
+    // running
+    void cancel();
+    // Prepends the chunks already parsed, then cancels
+    void stop();
+    bool isRunning() const { return m_reader != nullptr; }
+
+    // Throughput since start() and the estimated time left, for display
+    double bytesPerSecond() const;
+    double rowsPerSecond() const;
+    double remainingSeconds() const;
+
+signals:
+    void requestChunk(int generation, const CSVReader& settings, int columnCount, qint64 dataOffset, qint64 end, qint64 maxBytes);
+    void requestWhole(int generation, const CSVReader& reader);
+    void progress(qint64 loadedBytes, qint64 totalBytes);
+    // The reader gained older rows, or all of them after a whole parse;
+    // getAppendStart() is 0
+    void rowsPrepended();
+    void finished();
+
+private slots:
+    void onChunkReady(int generation, qint64 start, const QVector<QVector<double>>& columns, const QVector<int>& headerRows, const QStringList& addedHeader);
+    void onChunkFailed(int generation);
+    void onWholeProgress(int generation, qint64 bytes, qint64 totalBytes, int rows);
+    void onWholeReady(int generation, const CSVReader& reader);
+
+private:
+    // A parsed range not yet prepended to the reader
+    struct Chunk
+    {
+        QVector<QVector<double>> columns;
+        QVector<int> headerRows;
+        QStringList addedHeader;
+    };
+
+    CSVReader* m_reader;
+    CSVReader m_settings;
+    int m_generation;
+    QAtomicInt m_activeGeneration;
+    // Start of the oldest parsed chunk, where the next one ends
+    qint64 m_nextEnd;
+    // The reader's loaded offset after the last splice
+    qint64 m_splicedOffset;
+    // Newest first
+    QList<Chunk> m_pending;
+    int m_pendingRows;
+    int m_columnCount;
+    qint64 m_chunkBytes;
+    qint64 m_startOffset;
+    // Where the bytes left to read end: the data offset, or 0 for a whole parse
+    qint64 m_firstOffset;
+    qint64 m_loadedRows;
+    QElapsedTimer m_clock;
+    QThread m_thread;
+    BackfillWorker* m_worker;
+
+    void requestNext();
+    void splice();
+};
+
+#endif // BACKFILLLOADER_H
@@ -1,22 +1,121 @@
 #include "CSVReader.h"
+#include "LineTokenizer.h"
+#include "CompressedFile.h"
+#include "rtplotter/BinaryLogLayout.h"
 #include <QFile>
-#include <QTextStream>
 #include <QDebug>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // parse() and readNewLines() read the file in chunks of this size
+    const qint64 kReadChunk = 4 * 1024 * 1024;
+
+    // Calls `line(begin, end)` for every non-empty line of [data, end),
+    // without its line break. The unterminated last line is only passed when
+    // `atEnd`; returns where the bytes not consumed begin.
+    template <typename LineFunction>
+    const char* forEachLine(const char* data, const char* end, bool atEnd, LineFunction line)
+    {
+        while (data < end) {
+            const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+            if (!newline && !atEnd) break;
+            const char* stop = newline ? newline : end;
+            const char* lineEnd = (stop > data && stop[-1] == '\r') ? stop - 1 : stop;
+            if (lineEnd > data) line(data, lineEnd);
+            data = newline ? newline + 1 : end;
+        }
+        return data;
+    }
+
+    const double kMissing = std::numeric_limits<double>::quiet_NaN();
+
+    // Whether a field names a column: it has a letter and is not a spelling
+    // of NaN or infinity. Fortran overflow markers (*****) name nothing.
+    bool isColumnName(const QString& field)
+    {
+        const QString name = field.trimmed();
+        if (std::none_of(name.begin(), name.end(), [](QChar c) { return c.isLetter(); })) return false;
+        QString value = name.toLower();
+        if (value.startsWith("+") || value.startsWith("-")) value = value.mid(1);
+        return value != "nan" && value != "inf" && value != "infinity";
+    }
+
+    // Names of a line without numbers that may be a header: one non-empty
+    // text field per column, at least one of them a name. Empty for any
+    // other line, such as a row of overflow markers, which is a row of gaps.
+    QStringList headerFields(const LineTokenizer& tokenizer, const char* begin, const char* end)
+    {
+        QStringList fields = tokenizer.split(begin, end);
+        for (const QString& field : fields) {
+            if (field.trimmed().isEmpty()) return QStringList();
+        }
+        if (std::none_of(fields.constBegin(), fields.constEnd(), isColumnName)) return QStringList();
+        return fields;
+    }
+
+    QString placeholderName(int column)
+    {
+        return QString("Col%1").arg(column + 1);
+    }
+
+    // How a header line met after the data starts is read. With more names
+    // than the previous row has fields, or than there are named columns, it
+    // introduces columns (a solver adding monitors mid-run); with as many,
+    // it is the header written again by a job restarted from a checkpoint.
+    enum HeaderKind { NotHeader, AddedColumns, RepeatedHeader };
+
+    HeaderKind headerKind(const QStringList& fields, int previousFields, int namedColumns, int columns)
+    {
+        if (fields.isEmpty()) return NotHeader;
+        if (fields.size() > previousFields || fields.size() > namedColumns) return AddedColumns;
+        if (fields.size() == previousFields || fields.size() == columns) return RepeatedHeader;
+        return NotHeader;
+    }
+
+    // Columns before the first one named after its position
+    int namedColumnCount(const QStringList& headers)
+    {
+        for (int c = 0; c < headers.size(); ++c) {
+            if (headers.at(c) == placeholderName(c)) return c;
+        }
+        return headers.size();
+    }
+}
 
 CSVReader::CSVReader()
     : m_separator(','),
       m_startLine(1),
       m_hasHeader(true),
       m_ignoreNonNumeric(false),
-      m_fileSize(0)
+      m_whitespaceSeparated(false),
+      m_rawColumnCount(0),
+      m_rowCount(0),
+      m_appendStart(0),
+      m_fileSize(0),
+      m_dataOffset(0),
+      m_loadedOffset(0),
+      m_segmentFirst(std::numeric_limits<double>::quiet_NaN()),
+      m_lastFieldCount(0),
+      m_schemaVersion(0),
+      m_decodedSize(0),
+      m_binaryLog(false),
+      m_headerOnly(false),
+      m_isStream(false),
+      m_streamStarted(false)
 {
 }
 
 void CSVReader::setFile(const QString& path)
 {
     m_filePath = path;
+    // A file is read again by parse() and readNewLines(), unlike a stream
+    m_isStream = false;
 }
 
 void CSVReader::setSeparator(QChar sep)
@@ -39,6 +138,24 @@ void CSVReader::setIgnoreNonNumeric(bool ignore)
     m_ignoreNonNumeric = ignore;
 }
 
+void CSVReader::setWhitespaceSeparated(bool whitespace)
+{
+    m_whitespaceSeparated = whitespace;
+}
+
+void CSVReader::setCommentPrefix(const QString& prefix)
+{
+    m_commentPrefix = prefix;
+}
+
+void CSVReader::setFixedWidths(const QVector<int>& widths)
+{
+    m_fixedWidths.clear();
+    for (int width : widths) {
+        if (width > 0) m_fixedWidths.append(width);
+    }
+}
+
 QString CSVReader::getFilePath() const
 {
     return m_filePath;
@@ -64,66 +181,755 @@ bool CSVReader::getIgnoreNonNumeric() const
     return m_ignoreNonNumeric;
 }
 
-bool CSVReader::parse()
+bool CSVReader::getWhitespaceSeparated() const
+{
+    return m_whitespaceSeparated;
+}
+
+QString CSVReader::getCommentPrefix() const
+{
+    return m_commentPrefix;
+}
+
+QVector<int> CSVReader::getFixedWidths() const
 {
-    m_data.clear();
+    return m_fixedWidths;
+}
+
+bool CSVReader::parse(const std::function<bool(qint64, qint64)>& progress)
+{
+    if (m_isStream) {
+        qWarning() << "A stream cannot be parsed again:" << m_filePath;
+        return false;
+    }
+
+    clearRows();
+
+    if (isBinaryLog(m_filePath)) {
+        return parseBinaryLog(progress);
+    }
+    if (CompressedFile::detect(m_filePath) != CompressedFile::Plain) {
+        return parseCompressed(progress);
+    }
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open file:" << m_filePath;
+        return false;
+    }
+
+    LineTokenizer tokenizer(*this);
+    readPreamble(file, tokenizer);
+    file.seek(m_dataOffset);
+    QVector<double> row;
+    QByteArray buffer;
+    while (!file.atEnd()) {
+        QByteArray chunk = file.read(kReadChunk);
+        if (chunk.isEmpty()) break;
+        buffer.append(chunk);
+        const char* data = buffer.constData();
+        const char* rest = appendLines(data, data + buffer.size(), file.atEnd(), tokenizer, row);
+        buffer.remove(0, int(rest - data));
+        if (progress && !progress(file.pos(), file.size())) return false;
+    }
+
+    m_derived.update(m_columns, m_rawColumnCount, 0, m_rowCount);
+    updateSegments(0);
+
+    m_fileSize = file.pos() - buffer.size();
+    m_loadedOffset = m_dataOffset;
+    file.close();
+    return true;
+}
+
+void CSVReader::clearRows()
+{
+    m_columns.clear();
     m_headers.clear();
+    m_rawHeaders.clear();
+    m_rawColumnCount = 0;
+    m_rowCount = 0;
+    m_appendStart = 0;
+    m_headerRows.clear();
+    // A decoder left by a previous compressed file would be read again
+    m_source.reset();
+    m_decodedPending.clear();
+    m_binaryLog = false;
+    m_headerOnly = false;
+    m_isStream = false;
+    m_streamStarted = false;
+    m_streamPending.clear();
+}
+
+bool CSVReader::parseCompressed(const std::function<bool(qint64, qint64)>& progress)
+{
+    const qint64 compressedSize = QFile(m_filePath).size();
+    m_source = QSharedPointer<CompressedFile>::create(m_filePath);
+    if (!m_source->open()) {
+        qWarning() << "Could not decode file:" << m_filePath << m_source->errorString();
+        m_source.reset();
+        return false;
+    }
+
+    // Decoding runs on a second thread, a few chunks ahead of the parsing
+    m_source->startReadAhead(kReadChunk);
+    LineTokenizer tokenizer(*this);
+    QVector<double> row;
+    QByteArray buffer;
+    bool inData = false;
+    for (;;) {
+        const QByteArray chunk = m_source->read(kReadChunk);
+        const bool drained = chunk.isEmpty();
+        // A line cut by the writer's last flush waits for the rest of it
+        const bool atEnd = drained && m_source->atStreamEnd();
+        buffer.append(chunk);
+        if (!inData) {
+            if (!readPreamble(buffer, drained, tokenizer)) continue;
+            buffer.remove(0, int(m_dataOffset));
+            inData = true;
+        }
+        const char* data = buffer.constData();
+        const char* rest = appendLines(data, data + buffer.size(), atEnd, tokenizer, row);
+        buffer.remove(0, int(rest - data));
+        if (drained) break;
+        if (progress && !progress(m_source->compressedOffset(), compressedSize)) return false;
+    }
+    m_decodedPending = buffer;
+
+    m_derived.update(m_columns, m_rawColumnCount, 0, m_rowCount);
+    updateSegments(0);
+
+    // Offsets are in decoded bytes, except the size used to notice growth
+    m_fileSize = m_source->compressedOffset();
+    m_decodedSize = m_source->decodedOffset();
+    m_loadedOffset = m_dataOffset;
+    return true;
+}
+
+bool CSVReader::readNewCompressed()
+{
+    // Copies of a reader share its decoder; one that fell behind decodes
+    // again up to where it stopped
+    if (m_source->decodedOffset() != m_decodedSize) {
+        m_source = QSharedPointer<CompressedFile>::create(m_filePath);
+        if (!m_source->open() || !m_source->skip(m_decodedSize)) {
+            qWarning() << "Could not decode file:" << m_filePath << m_source->errorString();
+            return false;
+        }
+    }
+
+    int firstRow = m_rowCount;
+    LineTokenizer tokenizer(*this);
+    QVector<double> row;
+    QByteArray buffer = m_decodedPending;
+    for (;;) {
+        const QByteArray chunk = m_source->read(kReadChunk);
+        const bool drained = chunk.isEmpty();
+        const bool atEnd = drained && m_source->atStreamEnd();
+        buffer.append(chunk);
+        const char* data = buffer.constData();
+        const char* rest = appendLines(data, data + buffer.size(), atEnd, tokenizer, row);
+        buffer.remove(0, int(rest - data));
+        if (drained) break;
+    }
+    m_decodedPending = buffer;
+
+    m_derived.update(m_columns, m_rawColumnCount, firstRow, m_rowCount);
+    updateSegments(firstRow);
+    m_appendStart = firstRow;
+    m_fileSize = m_source->compressedOffset();
+    m_decodedSize = m_source->decodedOffset();
+    return true;
+}
+
+bool CSVReader::isBinaryLog(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    return file.read(sizeof(BinaryLogHeader::kMagic)) == QByteArray(BinaryLogHeader::kMagic, int(sizeof(BinaryLogHeader::kMagic)));
+}
 
+bool CSVReader::parseBinaryLog(const std::function<bool(qint64, qint64)>& progress)
+{
     QFile file(m_filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Could not open file:" << m_filePath;
         return false;
     }
+    if (!readBinaryHeader(file) || !readBinaryRecords(file, progress)) return false;
+    m_appendStart = 0;
+    return true;
+}
 
-    QTextStream in(&file);
-    int currentLine = 0;
+bool CSVReader::readBinaryHeader(QFile& file)
+{
+    BinaryLogHeader header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header))
+        || header.version != BinaryLogHeader::kVersion || header.columnCount == 0
+        || header.recordsOffset < BinaryLogHeader::recordsOffsetFor(header.columnCount)) {
+        qWarning() << "Not a supported binary log:" << m_filePath;
+        return false;
+    }
+    const QByteArray names = file.read(qint64(header.columnCount) * BinaryLogHeader::kNameBytes);
+    if (names.size() != int(header.columnCount * BinaryLogHeader::kNameBytes)) {
+        qWarning() << "Truncated binary log header:" << m_filePath;
+        return false;
+    }
+    for (uint32_t c = 0; c < header.columnCount; ++c) {
+        const char* name = names.constData() + c * BinaryLogHeader::kNameBytes;
+        m_rawHeaders.append(QString::fromUtf8(name, int(strnlen(name, BinaryLogHeader::kNameBytes))));
+    }
+    initColumns(int(header.columnCount));
+    m_binaryLog = true;
+    m_dataOffset = qint64(header.recordsOffset);
+    m_loadedOffset = m_dataOffset;
+    m_fileSize = m_dataOffset;
+    return true;
+}
 
-    while (!in.atEnd()) {
-        currentLine++;
-        QString line = in.readLine();
+bool CSVReader::readBinaryRecords(QFile& file, const std::function<bool(qint64, qint64)>& progress)
+{
+    const int firstRow = m_rowCount;
+    const qint64 recordBytes = qint64(m_rawColumnCount) * qint64(sizeof(double));
+    const int chunkRecords = int(qMax<qint64>(1, kReadChunk / recordBytes));
+    QVector<double> records(chunkRecords * m_rawColumnCount);
+    if (!file.seek(m_fileSize)) {
+        qWarning() << "Could not seek to position" << m_fileSize << "in file" << m_filePath;
+        return false;
+    }
+    // Whole records only: a partial last one is read once it is complete
+    for (;;) {
+        const int count = int(qMin<qint64>(chunkRecords, (file.size() - m_fileSize) / recordBytes));
+        if (count <= 0) break;
+        if (file.read(reinterpret_cast<char*>(records.data()), count * recordBytes) != count * recordBytes) break;
+        appendRecords(records.constData(), count);
+        if (progress && !progress(m_fileSize, file.size())) return false;
+    }
+    m_appendStart = firstRow;
+    return true;
+}
+
+void CSVReader::beginStream(const QString& name)
+{
+    m_filePath = name;
+    clearRows();
+    m_isStream = true;
+    m_fileSize = 0;
+    m_dataOffset = 0;
+    m_loadedOffset = 0;
+    updateSegments(0);
+}
+
+void CSVReader::appendStream(const QByteArray& bytes, bool atEnd)
+{
+    const int firstRow = m_rowCount;
+    m_appendStart = firstRow;
+    m_streamPending.append(bytes);
+    m_fileSize += bytes.size();
+
+    LineTokenizer tokenizer(*this);
+    if (!m_streamStarted) {
+        if (!readPreamble(m_streamPending, atEnd, tokenizer)) {
+            // Not complete until the header has arrived
+            m_dataOffset = 0;
+            return;
+        }
+        m_streamPending.remove(0, int(m_dataOffset));
+        m_loadedOffset = m_dataOffset;
+        m_streamStarted = true;
+    }
+
+    QVector<double> row;
+    const char* data = m_streamPending.constData();
+    const char* rest = appendLines(data, data + m_streamPending.size(), atEnd, tokenizer, row);
+    m_streamPending.remove(0, int(rest - data));
+
+    m_derived.update(m_columns, m_rawColumnCount, firstRow, m_rowCount);
+    updateSegments(firstRow);
+}
+
+void CSVReader::beginRecords(const QString& name, const QStringList& columns)
+{
+    beginStream(name);
+    m_rawHeaders = columns;
+    initColumns(columns.size());
+    m_streamStarted = true;
+}
+
+void CSVReader::appendRecords(const double* records, int count)
+{
+    const int firstRow = m_rowCount;
+    m_appendStart = firstRow;
+    if (count <= 0 || m_rawColumnCount == 0) return;
+
+    // Row-major records are scattered into the columns in one pass
+    QVector<double*> out(m_rawColumnCount);
+    for (int c = 0; c < m_rawColumnCount; ++c) {
+        QVector<double>& column = m_columns[c];
+        if (column.capacity() < firstRow + count) column.reserve(qMax(firstRow + count, 2 * column.capacity()));
+        column.resize(firstRow + count);
+        out[c] = column.data() + firstRow;
+    }
+    const double* record = records;
+    for (int r = 0; r < count; ++r, record += m_rawColumnCount) {
+        for (int c = 0; c < m_rawColumnCount; ++c) out[c][r] = record[c];
+    }
+    m_rowCount += count;
+    m_fileSize += qint64(count) * m_rawColumnCount * qint64(sizeof(double));
+
+    m_derived.update(m_columns, m_rawColumnCount, firstRow, m_rowCount);
+    updateSegments(firstRow);
+}
+
+bool CSVReader::isStream() const
+{
+    return m_isStream;
+}
+
+bool CSVReader::parseTail(qint64 tailBytes)
+{
+    // Compressed data can only be decoded from its start
+    if (isBinaryLog(m_filePath) || CompressedFile::detect(m_filePath) != CompressedFile::Plain) {
+        return parseHeader();
+    }
+
+    clearRows();
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open file:" << m_filePath;
+        return false;
+    }
+
+    readPreamble(file, LineTokenizer(*this));
+    const qint64 fileSize = file.size();
+
+    // The tail starts after the first line break found going back from EOF
+    qint64 start = qMax(m_dataOffset, fileSize - tailBytes);
+    if (start > m_dataOffset) {
+        file.seek(start - 1);
+        qint64 boundary = -1;
+        while (boundary < 0 && !file.atEnd()) {
+            QByteArray bytes = file.read(64 * 1024);
+            int newline = bytes.indexOf('\n');
+            if (newline >= 0) boundary = file.pos() - bytes.size() + newline + 1;
+        }
+        start = boundary < 0 ? fileSize : boundary;
+    }
+    file.seek(start);
+    QByteArray tail = file.read(fileSize - start);
+
+    QVector<QVector<double>> columns;
+    QStringList addedHeader;
+    parseRows(tail, m_rawColumnCount, columns, &m_headerRows, &addedHeader);
+    if (m_rawColumnCount == 0 && !columns.isEmpty()) {
+        initColumns(columns.size());
+    } else if (columns.size() > m_rawColumnCount) {
+        extendColumns(columns.size(), addedHeader);
+    }
+    for (int c = 0; c < m_rawColumnCount && c < columns.size(); ++c) {
+        m_columns[c].swap(columns[c]);
+    }
+    m_rowCount = columns.isEmpty() ? 0 : m_columns.at(0).size();
+    m_derived.update(m_columns, m_rawColumnCount, 0, m_rowCount);
+    updateSegments(0);
 
+    m_fileSize = fileSize;
+    m_loadedOffset = start;
+    file.close();
+    return true;
+}
+
+bool CSVReader::parseHeader()
+{
+    clearRows();
+    if (isBinaryLog(m_filePath)) {
+        QFile file(m_filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Could not open file:" << m_filePath;
+            return false;
+        }
+        if (!readBinaryHeader(file)) return false;
+    } else {
+        CompressedFile source(m_filePath);
+        if (!source.open()) {
+            qWarning() << "Could not decode file:" << m_filePath << source.errorString();
+            return false;
+        }
+        LineTokenizer tokenizer(*this);
+        QByteArray head;
+        for (;;) {
+            const QByteArray chunk = source.read(kReadChunk);
+            head.append(chunk);
+            if (readPreamble(head, chunk.isEmpty(), tokenizer)) break;
+        }
+        // Without a header line the first rows give the number of columns
+        if (m_rawColumnCount == 0) {
+            QVector<QVector<double>> columns;
+            parseRows(head.left(head.lastIndexOf('\n') + 1).mid(int(m_dataOffset)), 0, columns);
+            if (!columns.isEmpty()) initColumns(columns.size());
+        }
+        m_fileSize = 0;
+        m_loadedOffset = m_dataOffset;
+    }
+    updateSegments(0);
+    m_headerOnly = true;
+    m_appendStart = 0;
+    return true;
+}
+
+bool CSVReader::isHeaderOnly() const
+{
+    return m_headerOnly;
+}
+
+bool CSVReader::readPreamble(const QByteArray& head, bool atEnd, const LineTokenizer& tokenizer)
+{
+    // Lines before the start line and the header are read forwards
+    qint64 offset = 0;
+    int currentLine = 0;
+    m_dataOffset = -1;
+    while (offset < head.size()) {
+        const int newline = head.indexOf('\n', int(offset));
+        if (newline < 0 && !atEnd) return false;
+        const qint64 next = newline < 0 ? head.size() : newline + 1;
+        currentLine++;
         if (currentLine < m_startLine) {
+            offset = next;
             continue;
         }
-
         if (m_hasHeader && currentLine == m_startLine) {
-            m_headers = line.split(m_separator);
-            continue;
+            qint64 end = next;
+            while (end > offset && (head.at(int(end - 1)) == '\n' || head.at(int(end - 1)) == '\r')) --end;
+            m_rawHeaders = tokenizer.header(head.constData() + offset, head.constData() + end);
+            initColumns(m_rawHeaders.size());
+            m_dataOffset = next;
+            return true;
         }
+        m_dataOffset = offset;
+        return true;
+    }
+    if (!atEnd) return false;
+    m_dataOffset = head.size();
+    return true;
+}
 
-        QStringList fields = line.split(m_separator);
-        QVector<double> row;
-        bool isNumeric = false;
+void CSVReader::readPreamble(QFile& file, const LineTokenizer& tokenizer)
+{
+    QByteArray head;
+    while (!readPreamble(head, file.atEnd(), tokenizer)) head += file.read(64 * 1024);
+}
 
-        for (const QString& field : fields) {
-            bool ok;
-            double value = field.toDouble(&ok);
-            if (ok) {
-                row.append(value);
-                isNumeric = true;
-            } else {
-                row.append(0.0); // Or some other default value
+const char* CSVReader::appendLines(const char* data, const char* end, bool atEnd, const LineTokenizer& tokenizer, QVector<double>& row)
+{
+    return forEachLine(data, end, atEnd, [&](const char* begin, const char* stop) {
+        if (tokenizer.isComment(begin, stop)) return;
+        const int columns = m_rawColumnCount > 0 ? m_rawColumnCount : tokenizer.fieldCount(begin, stop);
+        if (columns == 0) return;
+        row.resize(columns);
+        int fields = 0;
+        if (tokenizer.tokenize(begin, stop, row, &fields) == 0) {
+            if (m_hasHeader && m_rawColumnCount > 0) {
+                const QStringList names = headerFields(tokenizer, begin, stop);
+                switch (headerKind(names, m_lastFieldCount, namedColumnCount(m_rawHeaders), columns)) {
+                case AddedColumns:
+                    extendColumns(names.size(), names);
+                    m_lastFieldCount = names.size();
+                    return;
+                case RepeatedHeader:
+                    m_headerRows.append(m_rowCount);
+                    return;
+                case NotHeader:
+                    break;
+                }
             }
+            if (m_ignoreNonNumeric) return;
+        } else if (fields > columns && m_rawColumnCount > 0) {
+            // A longer row without a header line: the new columns are unnamed
+            fields = tokenizer.fieldCount(begin, stop);
+            extendColumns(fields, QStringList());
+            row.resize(fields);
+            tokenizer.tokenize(begin, stop, row);
         }
+        m_lastFieldCount = fields;
+        appendRow(row);
+    });
+}
 
-        if (m_ignoreNonNumeric && !isNumeric) {
-            continue;
+int CSVReader::parseRows(const QByteArray& bytes, int columnCount, QVector<QVector<double>>& columns, QVector<int>* headerRows, QStringList* addedHeader) const
+{
+    columns.clear();
+    LineTokenizer tokenizer(*this);
+    QVector<double> row;
+    int rows = 0;
+    int lastFields = columnCount;
+    int namedColumns = columnCount;
+    // Columns added by a header line or a longer row; earlier rows are gaps
+    auto widen = [&](int count) {
+        row.resize(count);
+        while (!columns.isEmpty() && columns.size() < count) columns.append(QVector<double>(rows, kMissing));
+    };
+    // Same rules as parse(), so a tail-first open yields the same rows
+    forEachLine(bytes.constData(), bytes.constData() + bytes.size(), true, [&](const char* begin, const char* end) {
+        if (tokenizer.isComment(begin, end)) return;
+        if (row.isEmpty()) {
+            const int count = columnCount > 0 ? columnCount : tokenizer.fieldCount(begin, end);
+            if (count == 0) return;
+            row.resize(count);
+            if (lastFields == 0) lastFields = namedColumns = count;
+        }
+        int fields = 0;
+        if (tokenizer.tokenize(begin, end, row, &fields) == 0) {
+            if (m_hasHeader) {
+                const QStringList names = headerFields(tokenizer, begin, end);
+                switch (headerKind(names, lastFields, namedColumns, row.size())) {
+                case AddedColumns:
+                    if (names.size() > row.size()) widen(names.size());
+                    if (addedHeader && names.size() > addedHeader->size()) *addedHeader = names;
+                    lastFields = names.size();
+                    namedColumns = qMax(namedColumns, int(names.size()));
+                    return;
+                case RepeatedHeader:
+                    if (headerRows) headerRows->append(rows);
+                    return;
+                case NotHeader:
+                    break;
+                }
+            }
+            if (m_ignoreNonNumeric) return;
+        } else if (fields > row.size()) {
+            fields = tokenizer.fieldCount(begin, end);
+            widen(fields);
+            tokenizer.tokenize(begin, end, row);
+        }
+        lastFields = fields;
+        if (columns.isEmpty()) {
+            columns = QVector<QVector<double>>(row.size());
         }
+        for (int c = 0; c < columns.size(); ++c) {
+            columns[c].append(row.at(c));
+        }
+        ++rows;
+    });
+    return rows;
+}
 
-        m_data.append(row);
+void CSVReader::prependRows(const QVector<QVector<double>>& columns, const QVector<int>& headerRows, const QStringList& addedHeader, qint64 offset)
+{
+    if (m_rawColumnCount == 0 && !columns.isEmpty()) {
+        initColumns(columns.size());
+    } else if (columns.size() > m_rawColumnCount || !addedHeader.isEmpty()) {
+        // Also names columns first seen in longer rows of the tail
+        extendColumns(qMax(m_rawColumnCount, int(columns.size())), addedHeader);
     }
+    const int added = columns.isEmpty() ? 0 : columns.at(0).size();
+    for (int c = 0; c < m_rawColumnCount; ++c) {
+        QVector<double> merged;
+        merged.reserve(added + m_rowCount);
+        if (c < columns.size()) merged += columns.at(c);
+        else merged.fill(kMissing, added);
+        merged += m_columns.at(c);
+        m_columns[c].swap(merged);
+    }
+    m_rowCount += added;
+    m_loadedOffset = offset;
+    QVector<int> rows = headerRows;
+    for (int row : m_headerRows) rows.append(row + added);
+    m_headerRows.swap(rows);
+    // Derived channels are causal, so they are recomputed over all rows
+    rebuildDerivedColumns();
+    updateSegments(0);
+    m_appendStart = 0;
+}
 
-    if (!m_hasHeader) {
-        if (!m_data.isEmpty()) {
-            for (int i = 0; i < m_data.first().size(); ++i) {
-                m_headers.append(QString("Col%1").arg(i + 1));
-            }
+qint64 CSVReader::getDataOffset() const
+{
+    return m_dataOffset;
+}
+
+qint64 CSVReader::getFileSize() const
+{
+    return m_fileSize;
+}
+
+qint64 CSVReader::getLoadedOffset() const
+{
+    return m_loadedOffset;
+}
+
+bool CSVReader::isComplete() const
+{
+    return !m_headerOnly && m_loadedOffset <= m_dataOffset;
+}
+
+QStringList CSVReader::splitFields(const QString& line) const
+{
+    QByteArray bytes = line.toUtf8();
+    return LineTokenizer(*this).split(bytes.constData(), bytes.constData() + bytes.size());
+}
+
+bool CSVReader::isCommentLine(const QString& line) const
+{
+    QByteArray bytes = line.toUtf8();
+    return LineTokenizer(*this).isComment(bytes.constData(), bytes.constData() + bytes.size());
+}
+
+void CSVReader::initColumns(int rawCount)
+{
+    m_rawColumnCount = rawCount;
+    m_lastFieldCount = rawCount;
+    // Without a header line, columns are named after their position
+    for (int i = m_rawHeaders.size(); i < rawCount; ++i) {
+        m_rawHeaders.append(placeholderName(i));
+    }
+    m_columns = QVector<QVector<double>>(m_rawColumnCount);
+    rebuildDerivedColumns();
+    ++m_schemaVersion;
+}
+
+void CSVReader::extendColumns(int rawCount, const QStringList& names)
+{
+    // Unnamed columns take the name given by a later header line
+    bool renamed = false;
+    for (int c = 0; c < m_rawColumnCount && c < names.size(); ++c) {
+        if (m_rawHeaders.at(c) == placeholderName(c) && names.at(c) != m_rawHeaders.at(c)) {
+            m_rawHeaders[c] = names.at(c);
+            renamed = true;
         }
     }
+    if (rawCount <= m_rawColumnCount && !renamed) return;
 
-    m_fileSize = file.size();
-    file.close();
-    return true;
+    // Raw columns stay first: the derived ones are dropped and rebuilt
+    m_columns.resize(m_rawColumnCount);
+    for (int c = m_rawColumnCount; c < rawCount; ++c) {
+        m_columns.append(QVector<double>(m_rowCount, kMissing));
+        m_rawHeaders.append(c < names.size() ? names.at(c) : placeholderName(c));
+    }
+    if (rawCount > m_rawColumnCount) {
+        qDebug() << "CSVReader: columns" << m_rawHeaders.mid(m_rawColumnCount) << "added at row" << m_rowCount << "of" << m_filePath;
+        m_rawColumnCount = rawCount;
+    }
+    rebuildDerivedColumns();
+    ++m_schemaVersion;
+}
+
+void CSVReader::appendRow(const QVector<double>& row)
+{
+    if (m_rawColumnCount == 0) {
+        initColumns(row.size());
+    }
+    // Short rows are padded with gaps so that all columns keep the same length
+    for (int c = 0; c < m_rawColumnCount; ++c) {
+        m_columns[c].append(c < row.size() ? row.at(c) : kMissing);
+    }
+    ++m_rowCount;
+}
+
+void CSVReader::rebuildDerivedColumns()
+{
+    m_columns.resize(m_rawColumnCount);
+    m_columns.resize(m_rawColumnCount + m_derived.size());
+    m_derived.bind(m_rawHeaders);
+    m_derived.update(m_columns, m_rawColumnCount, 0, m_rowCount);
+    m_headers = m_rawHeaders + m_derived.names();
+}
+
+void CSVReader::setDerivedChannels(const QList<DerivedChannel>& channels)
+{
+    m_derived.setChannels(channels);
+    if (m_rawColumnCount > 0) {
+        rebuildDerivedColumns();
+        updateSegments(0);
+    }
+    m_appendStart = 0;
+}
+
+QList<DerivedChannel> CSVReader::getDerivedChannels() const
+{
+    return m_derived.channels();
+}
+
+int CSVReader::getRowCount() const
+{
+    return m_rowCount;
+}
+
+int CSVReader::getColumnCount() const
+{
+    return m_columns.size();
+}
+
+int CSVReader::getSchemaVersion() const
+{
+    return m_schemaVersion;
+}
+
+int CSVReader::getColumnIndex(const QString& name) const
+{
+    return m_headers.indexOf(name);
+}
+
+const QVector<double>& CSVReader::getColumn(int index) const
+{
+    static const QVector<double> empty;
+    if (index < 0 || index >= m_columns.size()) return empty;
+    return m_columns.at(index);
+}
+
+int CSVReader::getAppendStart() const
+{
+    return m_appendStart;
+}
+
+void CSVReader::setSegmentKey(const QString& column)
+{
+    if (column == m_segmentKey) return;
+    m_segmentKey = column;
+    updateSegments(0);
+}
+
+QString CSVReader::getSegmentKey() const
+{
+    return m_segmentKey;
+}
+
+const QVector<int>& CSVReader::getSegmentStarts() const
+{
+    return m_segmentStarts;
+}
+
+void CSVReader::updateSegments(int firstRow)
+{
+    if (firstRow <= 0) {
+        firstRow = 0;
+        m_segmentStarts.clear();
+        m_segmentFirst = std::numeric_limits<double>::quiet_NaN();
+    }
+    if (m_rowCount == 0) return;
+    if (m_segmentStarts.isEmpty()) m_segmentStarts.append(0);
+
+    const int keyIndex = qMax(0, m_segmentKey.isEmpty() ? 0 : getColumnIndex(m_segmentKey));
+    const QVector<double>& key = getColumn(keyIndex);
+    const bool hasKey = key.size() >= m_rowCount;
+    auto header = std::lower_bound(m_headerRows.constBegin(), m_headerRows.constEnd(), firstRow);
+    // A drop below the first key of the run is taken as a restart, a drop
+    // within the run is not; gaps (NaN) never compare lower
+    for (int r = firstRow; r < m_rowCount; ++r) {
+        const double value = hasKey ? key[r] : 0.0;
+        bool restart = value < m_segmentFirst;
+        while (header != m_headerRows.constEnd() && *header <= r) {
+            restart |= *header == r;
+            ++header;
+        }
+        if (restart && r > 0) {
+            m_segmentStarts.append(r);
+            m_segmentFirst = std::numeric_limits<double>::quiet_NaN();
+        }
+        if (std::isnan(m_segmentFirst)) m_segmentFirst = value;
+    }
+    if (m_segmentStarts.size() > 1 && firstRow == 0) {
+        qDebug() << "CSVReader:" << m_segmentStarts.size() << "runs (restarts) in" << m_filePath;
+    }
 }
 
 QStringList CSVReader::getHeaders() const
@@ -131,20 +937,30 @@ QStringList CSVReader::getHeaders() const
     return m_headers;
 }
 
+QStringList CSVReader::getRawHeaders() const
+{
+    return m_rawHeaders;
+}
+
 QJsonObject CSVReader::toJson() const
 {
     QJsonObject obj;
-    obj["filePath"] = m_filePath;
+    if (!m_isStream) obj["filePath"] = m_filePath;
     obj["separator"] = QString(m_separator);
     obj["startLine"] = m_startLine;
     obj["hasHeader"] = m_hasHeader;
     obj["ignoreNonNumeric"] = m_ignoreNonNumeric;
+    obj["whitespaceSeparated"] = m_whitespaceSeparated;
+    obj["commentPrefix"] = m_commentPrefix;
+    QJsonArray widths;
+    for (int width : m_fixedWidths) widths.append(width);
+    obj["fixedWidths"] = widths;
     return obj;
 }
 
 void CSVReader::fromJson(const QJsonObject& obj)
 {
-    if (obj.contains("filePath")) m_filePath = obj["filePath"].toString();
+    if (obj.contains("filePath")) setFile(obj["filePath"].toString());
     if (obj.contains("separator")) {
         QString s = obj["separator"].toString();
         if (!s.isEmpty()) m_separator = s.at(0);
@@ -152,67 +968,77 @@ void CSVReader::fromJson(const QJsonObject& obj)
     if (obj.contains("startLine")) m_startLine = obj["startLine"].toInt();
     if (obj.contains("hasHeader")) m_hasHeader = obj["hasHeader"].toBool();
     if (obj.contains("ignoreNonNumeric")) m_ignoreNonNumeric = obj["ignoreNonNumeric"].toBool();
-}
-
-QVector<QVector<double>> CSVReader::getData() const
-{
-    return m_data;
+    if (obj.contains("whitespaceSeparated")) m_whitespaceSeparated = obj["whitespaceSeparated"].toBool();
+    if (obj.contains("commentPrefix")) m_commentPrefix = obj["commentPrefix"].toString();
+    if (obj.contains("fixedWidths")) {
+        QVector<int> widths;
+        for (const QJsonValue& width : obj["fixedWidths"].toArray()) widths.append(width.toInt());
+        setFixedWidths(widths);
+    }
 }
 
 bool CSVReader::readNewLines()
 {
+    // Stream bytes are pushed with appendStream(); the parse() of a file
+    // read header-only will read what has been added since
+    if (m_isStream || m_headerOnly) {
+        m_appendStart = m_rowCount;
+        return true;
+    }
+
     QFile file(m_filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Could not open file:" << m_filePath;
         return false;
     }
 
     if (file.size() < m_fileSize) {
-        // File has been truncated or replaced, re-parse from the beginning
+        // File has been truncated or replaced, re-parse from the beginning;
+        // files read from their start only are parsed off the GUI thread
         m_fileSize = 0;
-        return parse();
+        return m_source || m_binaryLog ? parseHeader() : parse();
     }
 
     if (file.size() == m_fileSize) {
         // No new data
+        m_appendStart = m_rowCount;
         file.close();
         return true;
     }
 
+    if (m_source) {
+        file.close();
+        return readNewCompressed();
+    }
+    if (m_binaryLog) {
+        return readBinaryRecords(file);
+    }
+
     if (!file.seek(m_fileSize)) {
         qWarning() << "Could not seek to position" << m_fileSize << "in file" << m_filePath;
         file.close();
         return false;
     }
 
-    QTextStream in(&file);
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        if (line.isEmpty()) continue;
-
-        QStringList fields = line.split(m_separator);
-        QVector<double> row;
-        bool isNumeric = false;
-
-        for (const QString& field : fields) {
-            bool ok;
-            double value = field.toDouble(&ok);
-            if (ok) {
-                row.append(value);
-                isNumeric = true;
-            } else {
-                row.append(0.0);
-            }
-        }
-
-        if (m_ignoreNonNumeric && !isNumeric) {
-            continue;
-        }
-
-        m_data.append(row);
+    int firstRow = m_rowCount;
+    LineTokenizer tokenizer(*this);
+    QVector<double> row;
+    QByteArray buffer;
+    while (!file.atEnd()) {
+        QByteArray chunk = file.read(kReadChunk);
+        if (chunk.isEmpty()) break;
+        buffer.append(chunk);
+        const char* data = buffer.constData();
+        const char* rest = appendLines(data, data + buffer.size(), file.atEnd(), tokenizer, row);
+        buffer.remove(0, int(rest - data));
     }
 
-    m_fileSize = file.size();
+    // Derived channels and segments only see the appended rows
+    m_derived.update(m_columns, m_rawColumnCount, firstRow, m_rowCount);
+    updateSegments(firstRow);
+    m_appendStart = firstRow;
+
+    m_fileSize = file.pos() - buffer.size();
     file.close();
     return true;
 }
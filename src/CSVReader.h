@@ -5,6 +5,13 @@
 #include <QVector>
 #include <QStringList>
 #include <QJsonObject>
+#include <QSharedPointer>
+#include <functional>
+#include "DerivedChannels.h"
+
+class QFile;
+class LineTokenizer;
+class CompressedFile;
 
 class CSVReader {
 public:
@@ -15,11 +22,91 @@ public:
     void setStartLine(int line);
     void setHasHeader(bool has);
     void setIgnoreNonNumeric(bool ignore);
+    // Fields are separated by runs of spaces and tabs instead of the separator
+    void setWhitespaceSeparated(bool whitespace);
+    // Lines starting with this prefix (after leading blanks) are skipped; a
+    // prefixed header line is read without it. Empty: no comments.
+    void setCommentPrefix(const QString& prefix);
+    // Fixed-width columns (Fortran output): field widths in bytes, used
+    // instead of any separator when not empty
+    void setFixedWidths(const QVector<int>& widths);
+    // Replaces the derived channels and recomputes them once over the loaded rows
+    void setDerivedChannels(const QList<DerivedChannel>& channels);
 
-    bool parse();
+    // gzip and zstd files are decoded while they are parsed; offsets are
+    // then in decoded bytes, except getFileSize() (compressed bytes read).
+    // Binary logs (see isBinaryLog()) are read as records, ignoring the
+    // separator settings. `progress` is called between chunks with the
+    // (compressed) bytes read and the file size; returning false stops the
+    // parse, which then fails.
+    bool parse(const std::function<bool(qint64, qint64)>& progress = nullptr);
+    // Tail-first open: reads the header, then at most `tailBytes` before EOF
+    // starting at a row boundary. Older rows are added with prependRows().
+    // Compressed files and binary logs can only be read from their start:
+    // only their header is read (see isHeaderOnly()).
+    bool parseTail(qint64 tailBytes);
+    // The columns are known but the rows are left to a parse(), run off the
+    // GUI thread by BackfillLoader; readNewLines() adds nothing until then
+    bool isHeaderOnly() const;
     QStringList getHeaders() const;
-    QVector<QVector<double>> getData() const;
+    QStringList getRawHeaders() const;
     bool readNewLines();
+    // Append-only binary log written by rtplotter::LogProducer (.rtlog)
+    static bool isBinaryLog(const QString& path);
+    // Streams (standard input, named pipes) are never read twice nor seeked:
+    // beginStream() clears the rows, then appendStream() parses the bytes
+    // pushed by the caller. The preamble is read from the first bytes; an
+    // unterminated last line waits for the next call unless `atEnd`.
+    // parse() and readNewLines() leave a stream untouched until setFile()
+    // names a file; toJson() omits the stream's name.
+    void beginStream(const QString& name);
+    void appendStream(const QByteArray& bytes, bool atEnd);
+    bool isStream() const;
+    // Binary records (see SharedRingSource) are a stream whose raw columns
+    // are named up front; appendRecords() copies `count` records of
+    // getRawHeaders().size() doubles each, row after row, with no parsing
+    void beginRecords(const QString& name, const QStringList& columns);
+    void appendRecords(const double* records, int count);
+
+    // Column store: raw columns first, then derived channels
+    int getRowCount() const;
+    int getColumnCount() const;
+    int getColumnIndex(const QString& name) const;
+    const QVector<double>& getColumn(int index) const;
+    // First row added by the last parse() (always 0) or readNewLines()
+    int getAppendStart() const;
+    // Columns only grow while reading: a header line with more names than
+    // the previous row has fields, or a longer row, adds raw columns whose
+    // earlier rows are gaps (NaN). Existing indices of raw columns are kept.
+    // Incremented whenever the raw columns or their names change.
+    int getSchemaVersion() const;
+
+    // Restarts from a checkpoint split the rows into segments: a row that
+    // follows a repeated header line, or whose key is below the first key of
+    // its segment, starts a new one. Keys that merely go down (X-Y data,
+    // noise) stay in their segment. The key is the named column (the plot X
+    // axis), the first column when empty.
+    void setSegmentKey(const QString& column);
+    QString getSegmentKey() const;
+    // First row of each segment in ascending order; {0} without restarts,
+    // empty without rows. Appended rows only extend the list.
+    const QVector<int>& getSegmentStarts() const;
+
+    // Byte offsets of the first data line and of the first loaded row; they
+    // differ only while a tail-first open is being backfilled
+    qint64 getDataOffset() const;
+    // Bytes of the file covered by the last parse or readNewLines()
+    qint64 getFileSize() const;
+    qint64 getLoadedOffset() const;
+    bool isComplete() const;
+    // Parses whole lines into `columnCount` raw columns (0: from the first
+    // row), more if columns are added. Touches no reader state, so it may run
+    // on a worker thread. The rows that follow a repeated header are added to
+    // `headerRows`; `addedHeader` receives the widest header adding columns.
+    int parseRows(const QByteArray& bytes, int columnCount, QVector<QVector<double>>& columns, QVector<int>* headerRows = nullptr, QStringList* addedHeader = nullptr) const;
+    // Inserts rows read from [offset, getLoadedOffset()) before the loaded
+    // ones; consumers see getAppendStart() == 0 and rebuild
+    void prependRows(const QVector<QVector<double>>& columns, const QVector<int>& headerRows, const QStringList& addedHeader, qint64 offset);
 
     QString getFilePath() const;
     QJsonObject toJson() const;
@@ -28,6 +115,14 @@ public:
     int getStartLine() const;
     bool getHasHeader() const;
     bool getIgnoreNonNumeric() const;
+    bool getWhitespaceSeparated() const;
+    QString getCommentPrefix() const;
+    QVector<int> getFixedWidths() const;
+
+    // Splits a line with the current separator rules
+    QStringList splitFields(const QString& line) const;
+    bool isCommentLine(const QString& line) const;
+    QList<DerivedChannel> getDerivedChannels() const;
 
 private:
     QString m_filePath;
@@ -35,9 +130,71 @@ private:
     int m_startLine;
     bool m_hasHeader;
     bool m_ignoreNonNumeric;
+    bool m_whitespaceSeparated;
+    QString m_commentPrefix;
+    QVector<int> m_fixedWidths;
     QStringList m_headers;
-    QVector<QVector<double>> m_data;
+    QStringList m_rawHeaders;
+    QVector<QVector<double>> m_columns;
+    int m_rawColumnCount;
+    int m_rowCount;
+    int m_appendStart;
+    DerivedChannelEngine m_derived;
     qint64 m_fileSize;
+    qint64 m_dataOffset;
+    qint64 m_loadedOffset;
+    QString m_segmentKey;
+    // Rows that follow a repeated header line
+    QVector<int> m_headerRows;
+    QVector<int> m_segmentStarts;
+    // First key of the last segment (NaN until it has one), where the next
+    // scan resumes
+    double m_segmentFirst;
+    // Fields of the last data row, to tell added columns from a repeated header
+    int m_lastFieldCount;
+    int m_schemaVersion;
+    // Decoder of a compressed file, kept so readNewLines() resumes where it
+    // stopped; null for plain files
+    QSharedPointer<CompressedFile> m_source;
+    qint64 m_decodedSize;
+    // Decoded bytes of an unterminated last line, parsed once its line break
+    // is decoded or the compressed stream ends
+    QByteArray m_decodedPending;
+    bool m_binaryLog;
+    bool m_headerOnly;
+    bool m_isStream;
+    bool m_streamStarted;
+    // Stream bytes of the preamble or of an unterminated line
+    QByteArray m_streamPending;
+
+    // Empties the columns and drops the state of the previous source, before
+    // a file or stream is read from its start
+    void clearRows();
+    // Skips the lines before the start line and reads the header, if any;
+    // sets m_dataOffset
+    void readPreamble(QFile& file, const LineTokenizer& tokenizer);
+    // Same from the first bytes of the data; false when `head` ends before
+    // the preamble does and more bytes follow
+    bool readPreamble(const QByteArray& head, bool atEnd, const LineTokenizer& tokenizer);
+    // Reads the preamble of a compressed file or the header of a binary log
+    bool parseHeader();
+    bool parseCompressed(const std::function<bool(qint64, qint64)>& progress);
+    bool readNewCompressed();
+    // Reads the column names of a binary log; sets the offsets to its first record
+    bool readBinaryHeader(QFile& file);
+    bool parseBinaryLog(const std::function<bool(qint64, qint64)>& progress);
+    // Appends the whole records from m_fileSize on; false if `progress` stops it
+    bool readBinaryRecords(QFile& file, const std::function<bool(qint64, qint64)>& progress = nullptr);
+    // Appends the rows of the lines of [data, end); returns where the
+    // unconsumed (unterminated) bytes begin
+    const char* appendLines(const char* data, const char* end, bool atEnd, const LineTokenizer& tokenizer, QVector<double>& row);
+    void initColumns(int rawCount);
+    // Adds raw columns up to `rawCount`, named from `names` when given
+    void extendColumns(int rawCount, const QStringList& names);
+    void appendRow(const QVector<double>& row);
+    void rebuildDerivedColumns();
+    // Looks for restarts among rows [firstRow, m_rowCount); 0 starts over
+    void updateSegments(int firstRow);
 };
 
 #endif // CSVREADER_H
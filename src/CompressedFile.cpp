@@ -0,0 +1,308 @@
+#include "CompressedFile.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QDebug>
+#include <cstring>
+
+#ifdef RTPLOTTER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+    // Compressed bytes read from the file at a time
+    const qint64 kInputBytes = 1024 * 1024;
+    // Decoded chunks the read-ahead thread may hold before it waits
+    const int kReadAheadChunks = 3;
+}
+
+struct CompressedFile::Decoder
+{
+#ifdef RTPLOTTER_HAVE_ZLIB
+    z_stream zlib;
+    bool zlibReady = false;
+    // The last gzip member is complete; another may follow
+    bool memberEnded = false;
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+    ZSTD_DCtx* zstd = nullptr;
+    ZSTD_inBuffer input = { nullptr, 0, 0 };
+    // The last frame is complete and flushed
+    bool frameEnded = false;
+#endif
+};
+
+CompressedFile::Format CompressedFile::detect(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return Plain;
+    const QByteArray magic = file.read(4);
+    if (magic.startsWith("\x1f\x8b")) return Gzip;
+    if (magic == QByteArray("\x28\xb5\x2f\xfd", 4)) return Zstd;
+    return Plain;
+}
+
+bool CompressedFile::isSupported(Format format)
+{
+    switch (format) {
+    case Plain: return true;
+#ifdef RTPLOTTER_HAVE_ZLIB
+    case Gzip: return true;
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+    case Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+QString CompressedFile::formatName(Format format)
+{
+    switch (format) {
+    case Gzip: return "gzip";
+    case Zstd: return "zstd";
+    default: return "plain";
+    }
+}
+
+CompressedFile::CompressedFile(const QString& path) :
+    m_path(path),
+    m_format(detect(path)),
+    m_file(path),
+    m_fileOffset(0),
+    m_readOffset(0),
+    m_streamEnded(false),
+    m_decoder(nullptr),
+    m_readAhead(nullptr),
+    m_readAheadDone(false),
+    m_stopping(false)
+{
+}
+
+CompressedFile::~CompressedFile()
+{
+    stopReadAhead();
+    if (!m_decoder) return;
+#ifdef RTPLOTTER_HAVE_ZLIB
+    if (m_decoder->zlibReady) inflateEnd(&m_decoder->zlib);
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+    if (m_decoder->zstd) ZSTD_freeDCtx(m_decoder->zstd);
+#endif
+    delete m_decoder;
+}
+
+bool CompressedFile::open()
+{
+    if (!isSupported(m_format)) {
+        m_error = QString("%1 support was not built in").arg(formatName(m_format));
+        return false;
+    }
+    // Unbuffered, so that bytes appended after the end was reached are seen
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_input.resize(kInputBytes);
+    m_decoder = new Decoder;
+#ifdef RTPLOTTER_HAVE_ZLIB
+    if (m_format == Gzip) {
+        std::memset(&m_decoder->zlib, 0, sizeof(z_stream));
+        // 15 + 32: largest window, gzip or zlib header detected automatically
+        if (inflateInit2(&m_decoder->zlib, 15 + 32) != Z_OK) {
+            m_error = "gzip: could not initialize the decoder";
+            return false;
+        }
+        m_decoder->zlibReady = true;
+    }
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+    if (m_format == Zstd) {
+        m_decoder->zstd = ZSTD_createDCtx();
+        if (!m_decoder->zstd) {
+            m_error = "zstd: could not initialize the decoder";
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+QString CompressedFile::errorString() const
+{
+    return m_error;
+}
+
+qint64 CompressedFile::compressedOffset() const
+{
+    qint64 pending = 0;
+#ifdef RTPLOTTER_HAVE_ZLIB
+    if (m_decoder && m_format == Gzip) pending = m_decoder->zlib.avail_in;
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+    if (m_decoder && m_format == Zstd) pending = qint64(m_decoder->input.size - m_decoder->input.pos);
+#endif
+    return m_fileOffset - pending;
+}
+
+bool CompressedFile::fillInput()
+{
+    const qint64 count = m_file.read(m_input.data(), m_input.size());
+    if (count <= 0) return false;
+    m_fileOffset += count;
+#ifdef RTPLOTTER_HAVE_ZLIB
+    if (m_format == Gzip) {
+        m_decoder->zlib.next_in = reinterpret_cast<Bytef*>(m_input.data());
+        m_decoder->zlib.avail_in = uInt(count);
+    }
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+    if (m_format == Zstd) {
+        m_decoder->input.src = m_input.constData();
+        m_decoder->input.size = size_t(count);
+        m_decoder->input.pos = 0;
+    }
+#endif
+    return true;
+}
+
+QByteArray CompressedFile::decode(qint64 maxBytes)
+{
+    QByteArray out;
+    if (!m_decoder || !m_error.isEmpty() || maxBytes <= 0) return out;
+    out.resize(maxBytes);
+    qint64 produced = 0;
+
+    if (m_format == Plain) {
+        produced = qMax<qint64>(0, m_file.read(out.data(), maxBytes));
+        m_fileOffset += produced;
+    }
+#ifdef RTPLOTTER_HAVE_ZLIB
+    if (m_format == Gzip) {
+        z_stream& z = m_decoder->zlib;
+        while (produced < maxBytes) {
+            const bool hasInput = z.avail_in > 0 || fillInput();
+            if (m_decoder->memberEnded) {
+                // Members are concatenated by `cat a.gz b.gz` and by writers
+                // that close and reopen the stream
+                if (!hasInput) break;
+                inflateReset(&z);
+                m_decoder->memberEnded = false;
+            }
+            const qint64 before = produced;
+            z.next_out = reinterpret_cast<Bytef*>(out.data() + produced);
+            z.avail_out = uInt(maxBytes - produced);
+            const int status = inflate(&z, Z_NO_FLUSH);
+            produced = maxBytes - z.avail_out;
+            if (status == Z_STREAM_END) {
+                m_decoder->memberEnded = true;
+                continue;
+            }
+            if (status != Z_OK && status != Z_BUF_ERROR) {
+                m_error = QString("gzip: %1").arg(z.msg ? z.msg : "corrupt data");
+                break;
+            }
+            // The rest of the member has not been written yet
+            if (produced == before && (status == Z_BUF_ERROR || !hasInput)) break;
+        }
+    }
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+    if (m_format == Zstd) {
+        ZSTD_inBuffer& input = m_decoder->input;
+        ZSTD_outBuffer output = { out.data(), size_t(maxBytes), 0 };
+        while (output.pos < output.size) {
+            const bool hasInput = input.pos < input.size || fillInput();
+            const size_t before = output.pos;
+            const size_t consumed = input.pos;
+            // Frames follow each other without a reset
+            const size_t status = ZSTD_decompressStream(m_decoder->zstd, &output, &input);
+            if (ZSTD_isError(status)) {
+                m_error = QString("zstd: %1").arg(ZSTD_getErrorName(status));
+                break;
+            }
+            // A call without progress past a frame end hints at the next one
+            if (output.pos > before || input.pos > consumed || status == 0) m_decoder->frameEnded = status == 0;
+            if (!hasInput && output.pos == before) break;
+        }
+        produced = qint64(output.pos);
+    }
+#endif
+
+    if (!m_error.isEmpty()) qWarning() << "Could not decode" << m_path << ":" << m_error;
+    m_streamEnded = m_format == Plain || !m_error.isEmpty();
+#ifdef RTPLOTTER_HAVE_ZLIB
+    if (m_format == Gzip) m_streamEnded = m_streamEnded || m_decoder->memberEnded;
+#endif
+#ifdef RTPLOTTER_HAVE_ZSTD
+    if (m_format == Zstd) m_streamEnded = m_streamEnded || (m_decoder->frameEnded && m_decoder->input.pos == m_decoder->input.size);
+#endif
+    out.resize(produced);
+    return out;
+}
+
+void CompressedFile::startReadAhead(qint64 chunkBytes)
+{
+    if (m_readAhead || !m_decoder) return;
+    m_readAheadDone = false;
+    m_stopping = false;
+    m_readAhead = QThread::create([this, chunkBytes]() {
+        for (;;) {
+            const QByteArray chunk = decode(chunkBytes);
+            QMutexLocker locker(&m_mutex);
+            if (chunk.isEmpty() || m_stopping) break;
+            m_queue.append(chunk);
+            m_changed.wakeAll();
+            while (m_queue.size() >= kReadAheadChunks && !m_stopping) m_changed.wait(&m_mutex);
+        }
+        QMutexLocker locker(&m_mutex);
+        m_readAheadDone = true;
+        m_changed.wakeAll();
+    });
+    m_readAhead->start();
+}
+
+void CompressedFile::stopReadAhead()
+{
+    if (!m_readAhead) return;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_changed.wakeAll();
+    }
+    m_readAhead->wait();
+    delete m_readAhead;
+    m_readAhead = nullptr;
+}
+
+QByteArray CompressedFile::read(qint64 maxBytes)
+{
+    QByteArray chunk;
+    if (m_readAhead) {
+        QMutexLocker locker(&m_mutex);
+        while (m_queue.isEmpty() && !m_readAheadDone) m_changed.wait(&m_mutex);
+        if (!m_queue.isEmpty()) {
+            chunk = m_queue.takeFirst();
+            m_changed.wakeAll();
+        }
+    }
+    // Once the thread has reached the end, the decoder is used directly
+    if (chunk.isEmpty()) {
+        stopReadAhead();
+        chunk = decode(maxBytes);
+    }
+    m_readOffset += chunk.size();
+    return chunk;
+}
+
+bool CompressedFile::skip(qint64 bytes)
+{
+    while (bytes > 0) {
+        const QByteArray chunk = read(qMin(bytes, 4 * kInputBytes));
+        if (chunk.isEmpty()) return false;
+        bytes -= chunk.size();
+    }
+    return true;
+}
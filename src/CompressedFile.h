@@ -0,0 +1,84 @@
+#ifndef COMPRESSEDFILE_H
+#define COMPRESSEDFILE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+class QThread;
+
+// Streaming decoder for compressed data files (.csv.gz, .csv.zst), detected
+// from their magic bytes. Decoding stops at the last byte written so far and
+// resumes from there once the file grows, so a compressed file that is still
+// being written can be tailed like a plain one. Concatenated gzip members and
+// zstd frames are decoded one after the other.
+//
+// The decoders are optional: gzip needs zlib (RTPLOTTER_HAVE_ZLIB) and zstd
+// needs libzstd (RTPLOTTER_HAVE_ZSTD) at build time.
+class CompressedFile
+{
+public:
+    enum Format { Plain, Gzip, Zstd };
+
+    static Format detect(const QString& path);
+    static bool isSupported(Format format);
+    static QString formatName(Format format);
+
+    explicit CompressedFile(const QString& path);
+    ~CompressedFile();
+    CompressedFile(const CompressedFile&) = delete;
+    CompressedFile& operator=(const CompressedFile&) = delete;
+
+    bool open();
+    QString errorString() const;
+    Format format() const { return m_format; }
+
+    // Decodes at most `maxBytes`; empty once everything written so far has
+    // been decoded, or on a decoding error
+    QByteArray read(qint64 maxBytes);
+    // Decodes and drops `bytes`, to resume where another decoder stopped
+    bool skip(qint64 bytes);
+    // Decodes on a second thread, a few chunks of `chunkBytes` ahead of
+    // read(), until the current end of the file. Neither format can be
+    // decoded in parallel, but decoding overlaps with the parsing.
+    void startReadAhead(qint64 chunkBytes);
+
+    // Compressed bytes consumed and decoded bytes returned by read() and
+    // skip(); the former is exact once read() has returned empty
+    qint64 compressedOffset() const;
+    qint64 decodedOffset() const { return m_readOffset; }
+    // Once read() has returned empty: the decoded data ends with a complete
+    // gzip member or zstd frame, rather than with a writer's flush in the
+    // middle of one
+    bool atStreamEnd() const { return m_streamEnded; }
+
+private:
+    struct Decoder;
+
+    QString m_path;
+    Format m_format;
+    QFile m_file;
+    QByteArray m_input;
+    qint64 m_fileOffset;
+    qint64 m_readOffset;
+    bool m_streamEnded;
+    QString m_error;
+    Decoder* m_decoder;
+
+    // Read-ahead state; the decoder belongs to the thread while it runs
+    QThread* m_readAhead;
+    QMutex m_mutex;
+    QWaitCondition m_changed;
+    QList<QByteArray> m_queue;
+    bool m_readAheadDone;
+    bool m_stopping;
+
+    QByteArray decode(qint64 maxBytes);
+    bool fillInput();
+    void stopReadAhead();
+};
+
+#endif // COMPRESSEDFILE_H
@@ -0,0 +1,203 @@
+#include "ConvergenceMonitor.h"
+#include "CSVReader.h"
+#include <cmath>
+#include <limits>
+
+QJsonObject MonitorRule::toJson() const
+{
+    QJsonObject obj;
+    obj["column"] = column;
+    obj["kind"] = static_cast<int>(kind);
+    obj["threshold"] = threshold;
+    obj["window"] = window;
+    if (kind == OutsideBand) {
+        obj["lower"] = lower;
+        obj["upper"] = upper;
+    }
+    return obj;
+}
+
+MonitorRule MonitorRule::fromJson(const QJsonObject& obj)
+{
+    MonitorRule rule;
+    rule.column = obj.value("column").toString();
+    rule.kind = static_cast<Kind>(obj.value("kind").toInt());
+    rule.threshold = obj.value("threshold").toDouble(3.0);
+    rule.window = qMax(2, obj.value("window").toInt(100));
+    rule.lower = obj.value("lower").toDouble(0.0);
+    rule.upper = obj.value("upper").toDouble(1.0);
+    return rule;
+}
+
+QString MonitorRule::kindName(Kind kind)
+{
+    switch (kind) {
+        case OrderDrop: return QStringLiteral("Drop by N orders");
+        case RelativeChange: return QStringLiteral("Relative change below");
+        case LogSlope: return QStringLiteral("Log slope near zero");
+        case OutsideBand: return QStringLiteral("Outside band");
+    }
+    return QString();
+}
+
+QJsonArray monitorRulesToJson(const QList<MonitorRule>& rules)
+{
+    QJsonArray array;
+    for (const MonitorRule& rule : rules) {
+        array.append(rule.toJson());
+    }
+    return array;
+}
+
+QList<MonitorRule> monitorRulesFromJson(const QJsonArray& array)
+{
+    QList<MonitorRule> rules;
+    for (const QJsonValue& v : array) {
+        if (!v.isObject()) continue;
+        MonitorRule rule = MonitorRule::fromJson(v.toObject());
+        if (!rule.column.isEmpty()) rules.append(rule);
+    }
+    return rules;
+}
+
+void ConvergenceMonitor::setRules(const QList<MonitorRule>& rules)
+{
+    m_rules = rules;
+    m_states = QVector<State>(m_rules.size());
+}
+
+void ConvergenceMonitor::bind(const QStringList& headers)
+{
+    m_states = QVector<State>(m_rules.size());
+    for (int i = 0; i < m_rules.size(); ++i) {
+        const MonitorRule& rule = m_rules.at(i);
+        State& state = m_states[i];
+        state.columnIndex = headers.indexOf(rule.column);
+        state.sum.reset(rule.window);
+        state.slope.reset(rule.window);
+    }
+}
+
+QList<int> ConvergenceMonitor::update(const CSVReader& reader, int firstRow, int rowCount)
+{
+    QList<int> newlyMet;
+    for (int i = 0; i < m_rules.size(); ++i) {
+        const MonitorRule& rule = m_rules.at(i);
+        State& state = m_states[i];
+        if (state.columnIndex < 0 || state.columnIndex >= reader.getColumnCount()) continue;
+        const QVector<double>& values = reader.getColumn(state.columnIndex);
+        if (values.size() < rowCount) continue;
+
+        const double* y = values.constData();
+        state.excursion = false;
+        for (int r = firstRow; r < rowCount; ++r) {
+            if (std::isfinite(y[r])) push(rule, state, y[r]);
+        }
+
+        // Rules are edge-triggered: only a transition to "met" is reported
+        bool met = evaluate(rule, state);
+        if (met && !state.met) newlyMet.append(i);
+        state.met = met;
+    }
+    return newlyMet;
+}
+
+void ConvergenceMonitor::push(const MonitorRule& rule, State& state, double value)
+{
+    state.value = value;
+    switch (rule.kind) {
+    case MonitorRule::OrderDrop:
+        state.reference = qMax(state.reference, std::fabs(value));
+        break;
+    case MonitorRule::RelativeChange:
+        state.sum.push(value);
+        state.minimum.push(state.samples, value);
+        state.maximum.push(state.samples, value);
+        state.minimum.expireBefore(state.samples - rule.window + 1);
+        state.maximum.expireBefore(state.samples - rule.window + 1);
+        break;
+    case MonitorRule::LogSlope:
+        if (value != 0.0) state.slope.push(std::log10(std::fabs(value)));
+        break;
+    case MonitorRule::OutsideBand:
+        // A short spike inside a batch must not be hidden by the last value
+        if (!state.excursion && (value < rule.lower || value > rule.upper)) {
+            state.excursion = true;
+            state.reference = value;
+        }
+        break;
+    }
+    ++state.samples;
+}
+
+double ConvergenceMonitor::measure(const MonitorRule& rule, const State& state) const
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    switch (rule.kind) {
+    case MonitorRule::OrderDrop:
+        if (state.reference <= 0.0 || std::isnan(state.value)) return nan;
+        if (state.value == 0.0) return std::numeric_limits<double>::infinity();
+        return std::log10(state.reference / std::fabs(state.value));
+    case MonitorRule::RelativeChange: {
+        if (!state.sum.isFull()) return nan;
+        double range = state.maximum.value() - state.minimum.value();
+        double mean = std::fabs(state.sum.mean());
+        if (mean == 0.0) return range == 0.0 ? 0.0 : std::numeric_limits<double>::infinity();
+        return range / mean;
+    }
+    case MonitorRule::LogSlope:
+        return state.slope.isFull() ? state.slope.slope() : nan;
+    case MonitorRule::OutsideBand:
+        return state.excursion ? state.reference : state.value;
+    }
+    return nan;
+}
+
+bool ConvergenceMonitor::evaluate(const MonitorRule& rule, const State& state) const
+{
+    double m = measure(rule, state);
+    if (std::isnan(m)) return false;
+    switch (rule.kind) {
+    case MonitorRule::OrderDrop: return m >= rule.threshold;
+    case MonitorRule::RelativeChange: return m < rule.threshold;
+    case MonitorRule::LogSlope: return std::fabs(m) < rule.threshold;
+    case MonitorRule::OutsideBand: return m < rule.lower || m > rule.upper;
+    }
+    return false;
+}
+
+bool ConvergenceMonitor::isMet(int rule) const
+{
+    return rule >= 0 && rule < m_states.size() && m_states.at(rule).met;
+}
+
+int ConvergenceMonitor::metCount() const
+{
+    int count = 0;
+    for (const State& state : m_states) {
+        if (state.met) ++count;
+    }
+    return count;
+}
+
+QString ConvergenceMonitor::message(int rule) const
+{
+    if (rule < 0 || rule >= m_rules.size()) return QString();
+    const MonitorRule& r = m_rules.at(rule);
+    const State& state = m_states.at(rule);
+    if (state.columnIndex < 0) return QString("%1: column not found").arg(r.column);
+
+    double m = measure(r, state);
+    QString value = std::isnan(m) ? QStringLiteral("-") : QString::number(m, 'g', 4);
+    switch (r.kind) {
+    case MonitorRule::OrderDrop:
+        return QString("%1 dropped %2 orders of magnitude (target %3)").arg(r.column, value, QString::number(r.threshold));
+    case MonitorRule::RelativeChange:
+        return QString("%1 varied by %2 over the last %3 samples (target < %4)").arg(r.column, value, QString::number(r.window), QString::number(r.threshold));
+    case MonitorRule::LogSlope:
+        return QString("%1 log slope %2 decades/sample over %3 samples (target |slope| < %4)").arg(r.column, value, QString::number(r.window), QString::number(r.threshold));
+    case MonitorRule::OutsideBand:
+        return QString("%1 = %2 (band [%3, %4])").arg(r.column, value, QString::number(r.lower), QString::number(r.upper));
+    }
+    return QString();
+}
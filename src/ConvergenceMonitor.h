@@ -0,0 +1,74 @@
+#ifndef CONVERGENCEMONITOR_H
+#define CONVERGENCEMONITOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "RollingWindow.h"
+
+class CSVReader;
+
+// A convergence or stagnation criterion on one column
+struct MonitorRule {
+    enum Kind { OrderDrop, RelativeChange, LogSlope, OutsideBand };
+    QString column;
+    Kind kind = OrderDrop;
+    double threshold = 3.0; // orders of magnitude, relative change, or |slope| in decades per sample
+    int window = 100;       // samples, for relative change and slope
+    double lower = 0.0;     // band for OutsideBand
+    double upper = 1.0;
+
+    QJsonObject toJson() const;
+    static MonitorRule fromJson(const QJsonObject& obj);
+    static QString kindName(Kind kind);
+};
+
+QJsonArray monitorRulesToJson(const QList<MonitorRule>& rules);
+QList<MonitorRule> monitorRulesFromJson(const QJsonArray& array);
+
+// Evaluates monitor rules on appended rows. Each rule keeps O(window)
+// state, so a batch costs O(batch size) whatever the history length.
+class ConvergenceMonitor
+{
+public:
+    void setRules(const QList<MonitorRule>& rules);
+    QList<MonitorRule> rules() const { return m_rules; }
+    int size() const { return m_rules.size(); }
+
+    // Resolves column names against `headers` and clears the running state
+    void bind(const QStringList& headers);
+    // Feeds rows [firstRow, rowCount) and returns the rules that became met
+    // with this batch
+    QList<int> update(const CSVReader& reader, int firstRow, int rowCount);
+
+    bool isMet(int rule) const;
+    int metCount() const;
+    // Human-readable state of a rule, e.g. "res_p dropped 4.1 orders"
+    QString message(int rule) const;
+
+private:
+    struct State {
+        int columnIndex = -1;
+        bool met = false;
+        double value = std::numeric_limits<double>::quiet_NaN();
+        double reference = 0.0; // largest magnitude, or the out-of-band value
+        bool excursion = false;
+        qint64 samples = 0;
+        RollingSum sum;
+        RollingMinimum minimum;
+        RollingMaximum maximum;
+        RollingSlope slope;
+    };
+
+    QList<MonitorRule> m_rules;
+    QVector<State> m_states;
+
+    void push(const MonitorRule& rule, State& state, double value);
+    double measure(const MonitorRule& rule, const State& state) const;
+    bool evaluate(const MonitorRule& rule, const State& state) const;
+};
+
+#endif // CONVERGENCEMONITOR_H
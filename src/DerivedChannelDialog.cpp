@@ -0,0 +1,95 @@
+#include "DerivedChannelDialog.h"
+#include "ui_DerivedChannelDialog.h"
+#include <QComboBox>
+#include <QSpinBox>
+
+DerivedChannelDialog::DerivedChannelDialog(const QStringList& columns, const QList<DerivedChannel>& channels, const QString& defaultKey, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::DerivedChannelDialog),
+    m_columns(columns),
+    m_defaultKey(defaultKey)
+{
+    ui->setupUi(this);
+    for (const DerivedChannel& channel : channels) {
+        addRow(channel);
+    }
+}
+
+DerivedChannelDialog::~DerivedChannelDialog()
+{
+    delete ui;
+}
+
+void DerivedChannelDialog::addRow(const DerivedChannel& channel)
+{
+    int row = ui->channelTableWidget->rowCount();
+    ui->channelTableWidget->insertRow(row);
+    ui->channelTableWidget->setItem(row, 0, new QTableWidgetItem(channel.name));
+
+    QComboBox* kindComboBox = new QComboBox();
+    for (int k = DerivedChannel::MovingAverage; k <= DerivedChannel::Formula; ++k) {
+        kindComboBox->addItem(DerivedChannel::kindName(static_cast<DerivedChannel::Kind>(k)));
+    }
+    kindComboBox->setCurrentIndex(static_cast<int>(channel.kind));
+    ui->channelTableWidget->setCellWidget(row, 1, kindComboBox);
+
+    QComboBox* sourceComboBox = new QComboBox();
+    sourceComboBox->addItems(m_columns);
+    sourceComboBox->setCurrentIndex(qMax(0, m_columns.indexOf(channel.source)));
+    ui->channelTableWidget->setCellWidget(row, 2, sourceComboBox);
+
+    // Index 0 means "row index" for derivative/integral
+    QComboBox* keyComboBox = new QComboBox();
+    keyComboBox->addItem(tr("(row index)"));
+    keyComboBox->addItems(m_columns);
+    keyComboBox->setCurrentIndex(m_columns.indexOf(channel.key) + 1);
+    ui->channelTableWidget->setCellWidget(row, 3, keyComboBox);
+
+    QSpinBox* windowSpinBox = new QSpinBox();
+    windowSpinBox->setMinimum(1);
+    windowSpinBox->setMaximum(1000000);
+    windowSpinBox->setValue(channel.window);
+    ui->channelTableWidget->setCellWidget(row, 4, windowSpinBox);
+
+    // Only used by the Formula kind, e.g. sqrt(Fx^2+Fy^2)/qinf
+    QTableWidgetItem* formulaItem = new QTableWidgetItem(channel.expression);
+    formulaItem->setToolTip(tr("Formula over column names; quote names with spaces as \"name\""));
+    ui->channelTableWidget->setItem(row, 5, formulaItem);
+}
+
+void DerivedChannelDialog::on_addButton_clicked()
+{
+    DerivedChannel channel;
+    channel.source = m_columns.value(0);
+    channel.key = m_defaultKey;
+    channel.name = QString("%1_avg").arg(channel.source);
+    addRow(channel);
+}
+
+void DerivedChannelDialog::on_removeButton_clicked()
+{
+    int row = ui->channelTableWidget->currentRow();
+    if (row >= 0) {
+        ui->channelTableWidget->removeRow(row);
+    }
+}
+
+QList<DerivedChannel> DerivedChannelDialog::getChannels() const
+{
+    QList<DerivedChannel> channels;
+    for (int i = 0; i < ui->channelTableWidget->rowCount(); ++i) {
+        QTableWidgetItem* nameItem = ui->channelTableWidget->item(i, 0);
+        DerivedChannel channel;
+        channel.name = nameItem ? nameItem->text().trimmed() : QString();
+        if (channel.name.isEmpty()) continue;
+        channel.kind = static_cast<DerivedChannel::Kind>(static_cast<QComboBox*>(ui->channelTableWidget->cellWidget(i, 1))->currentIndex());
+        channel.source = static_cast<QComboBox*>(ui->channelTableWidget->cellWidget(i, 2))->currentText();
+        int keyIndex = static_cast<QComboBox*>(ui->channelTableWidget->cellWidget(i, 3))->currentIndex();
+        channel.key = keyIndex > 0 ? m_columns.value(keyIndex - 1) : QString();
+        channel.window = static_cast<QSpinBox*>(ui->channelTableWidget->cellWidget(i, 4))->value();
+        QTableWidgetItem* formulaItem = ui->channelTableWidget->item(i, 5);
+        channel.expression = formulaItem ? formulaItem->text().trimmed() : QString();
+        channels.append(channel);
+    }
+    return channels;
+}
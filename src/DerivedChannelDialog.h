@@ -0,0 +1,34 @@
+#ifndef DERIVEDCHANNELDIALOG_H
+#define DERIVEDCHANNELDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include "DerivedChannels.h"
+
+namespace Ui {
+class DerivedChannelDialog;
+}
+
+class DerivedChannelDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DerivedChannelDialog(const QStringList& columns, const QList<DerivedChannel>& channels, const QString& defaultKey = QString(), QWidget *parent = nullptr);
+    ~DerivedChannelDialog();
+
+    QList<DerivedChannel> getChannels() const;
+
+private slots:
+    void on_addButton_clicked();
+    void on_removeButton_clicked();
+
+private:
+    Ui::DerivedChannelDialog *ui;
+    QStringList m_columns;
+    QString m_defaultKey;
+
+    void addRow(const DerivedChannel& channel);
+};
+
+#endif // DERIVEDCHANNELDIALOG_H
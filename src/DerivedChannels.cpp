@@ -0,0 +1,227 @@
+#include "DerivedChannels.h"
+#include <QDebug>
+#include <limits>
+#include <cmath>
+
+QJsonObject DerivedChannel::toJson() const
+{
+    QJsonObject obj;
+    obj["name"] = name;
+    obj["source"] = source;
+    obj["key"] = key;
+    obj["kind"] = static_cast<int>(kind);
+    obj["window"] = window;
+    if (kind == Formula) obj["expression"] = expression;
+    return obj;
+}
+
+DerivedChannel DerivedChannel::fromJson(const QJsonObject& obj)
+{
+    DerivedChannel channel;
+    channel.name = obj.value("name").toString();
+    channel.source = obj.value("source").toString();
+    channel.key = obj.value("key").toString();
+    channel.kind = static_cast<Kind>(obj.value("kind").toInt());
+    channel.window = qMax(1, obj.value("window").toInt(10));
+    channel.expression = obj.value("expression").toString();
+    return channel;
+}
+
+QString DerivedChannel::kindName(Kind kind)
+{
+    switch (kind) {
+        case MovingAverage: return QStringLiteral("Moving average");
+        case Derivative: return QStringLiteral("Derivative");
+        case Integral: return QStringLiteral("Integral");
+        case RollingMin: return QStringLiteral("Rolling min");
+        case RollingMax: return QStringLiteral("Rolling max");
+        case RunningMean: return QStringLiteral("Running mean");
+        case Formula: return QStringLiteral("Formula");
+    }
+    return QString();
+}
+
+QJsonArray derivedChannelsToJson(const QList<DerivedChannel>& channels)
+{
+    QJsonArray array;
+    for (const DerivedChannel& channel : channels) {
+        array.append(channel.toJson());
+    }
+    return array;
+}
+
+QList<DerivedChannel> derivedChannelsFromJson(const QJsonArray& array)
+{
+    QList<DerivedChannel> channels;
+    for (const QJsonValue& v : array) {
+        if (!v.isObject()) continue;
+        DerivedChannel channel = DerivedChannel::fromJson(v.toObject());
+        if (!channel.name.isEmpty()) channels.append(channel);
+    }
+    return channels;
+}
+
+void DerivedChannelEngine::setChannels(const QList<DerivedChannel>& channels)
+{
+    m_channels = channels;
+    m_states = QVector<State>(m_channels.size());
+}
+
+QStringList DerivedChannelEngine::names() const
+{
+    QStringList result;
+    for (const DerivedChannel& channel : m_channels) {
+        result.append(channel.name);
+    }
+    return result;
+}
+
+void DerivedChannelEngine::bind(const QStringList& headers)
+{
+    // `headers` are the columns stored before the derived outputs; a channel
+    // may also use the output of any channel declared before it.
+    auto resolve = [&](const QString& name, int channelIndex) {
+        if (name.isEmpty()) return -1;
+        int index = headers.indexOf(name);
+        if (index >= 0) return index;
+        for (int j = 0; j < channelIndex; ++j) {
+            if (m_channels.at(j).name == name) return headers.size() + j;
+        }
+        return -1;
+    };
+
+    m_states = QVector<State>(m_channels.size());
+    for (int c = 0; c < m_channels.size(); ++c) {
+        const DerivedChannel& channel = m_channels.at(c);
+        State& state = m_states[c];
+        state.window.reset(channel.window);
+
+        if (channel.kind == DerivedChannel::Formula) {
+            QString error;
+            if (!state.formula.compile(channel.expression, &error)) {
+                qWarning() << "Invalid formula for" << channel.name << ":" << error;
+                continue;
+            }
+            state.bound = true;
+            for (const QString& variable : state.formula.variables()) {
+                int index = resolve(variable, c);
+                if (index < 0) {
+                    qWarning() << "Formula for" << channel.name << "references unknown column" << variable;
+                    state.bound = false;
+                }
+                state.inputIndices.append(index);
+            }
+            continue;
+        }
+
+        state.sourceIndex = resolve(channel.source, c);
+        state.keyIndex = resolve(channel.key, c);
+        state.bound = state.sourceIndex >= 0;
+    }
+}
+
+void DerivedChannelEngine::update(QVector<QVector<double>>& columns, int firstOutputColumn, int firstRow, int rowCount)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    QVector<double>* store = columns.data();
+
+    for (int c = 0; c < m_channels.size(); ++c) {
+        const DerivedChannel& channel = m_channels.at(c);
+        State& state = m_states[c];
+        QVector<double>& out = store[firstOutputColumn + c];
+        // Rows already computed, by a rebuild when a header added columns in
+        // the middle of the batch, are not appended again
+        const int from = qMax(firstRow, int(out.size()));
+        // Geometric growth: an exact reserve would copy the history per batch
+        if (out.capacity() < rowCount) out.reserve(qMax(rowCount, 2 * out.capacity()));
+
+        if (!state.bound) {
+            while (out.size() < rowCount) out.append(nan);
+            continue;
+        }
+
+        if (channel.kind == DerivedChannel::Formula) {
+            // Whole appended range in one call; the formula runs block-wise
+            QVector<const double*> inputs;
+            for (int index : state.inputIndices) {
+                inputs.append(store[index].constData());
+            }
+            out.resize(rowCount);
+            state.formula.evaluate(inputs, from, rowCount - from, out.data() + from);
+            continue;
+        }
+
+        const double* y = store[state.sourceIndex].constData();
+        const double* x = state.keyIndex >= 0 ? store[state.keyIndex].constData() : nullptr;
+
+        switch (channel.kind) {
+        case DerivedChannel::MovingAverage:
+            for (int r = from; r < rowCount; ++r) {
+                state.window.push(y[r]);
+                out.append(state.window.mean());
+            }
+            break;
+        case DerivedChannel::Derivative:
+            // Gaps (NaN) give NaN and the next sample differentiates against
+            // the last valid one
+            for (int r = from; r < rowCount; ++r) {
+                double key = x ? x[r] : static_cast<double>(r);
+                double value = nan;
+                if (std::isnan(key) || std::isnan(y[r])) {
+                    out.append(value);
+                    continue;
+                }
+                if (state.hasPrevious && key != state.previousKey) {
+                    value = (y[r] - state.previousValue) / (key - state.previousKey);
+                }
+                state.previousKey = key;
+                state.previousValue = y[r];
+                state.hasPrevious = true;
+                out.append(value);
+            }
+            break;
+        case DerivedChannel::Integral:
+            // The trapezoid spans gaps, from the last valid sample to the next
+            for (int r = from; r < rowCount; ++r) {
+                double key = x ? x[r] : static_cast<double>(r);
+                if (std::isnan(key) || std::isnan(y[r])) {
+                    out.append(state.accumulator);
+                    continue;
+                }
+                if (state.hasPrevious) {
+                    state.accumulator += 0.5 * (y[r] + state.previousValue) * (key - state.previousKey);
+                }
+                state.previousKey = key;
+                state.previousValue = y[r];
+                state.hasPrevious = true;
+                out.append(state.accumulator);
+            }
+            break;
+        case DerivedChannel::RollingMin:
+            for (int r = from; r < rowCount; ++r) {
+                state.minimum.push(r, y[r]);
+                state.minimum.expireBefore(r - channel.window + 1);
+                out.append(state.minimum.value());
+            }
+            break;
+        case DerivedChannel::RollingMax:
+            for (int r = from; r < rowCount; ++r) {
+                state.maximum.push(r, y[r]);
+                state.maximum.expireBefore(r - channel.window + 1);
+                out.append(state.maximum.value());
+            }
+            break;
+        case DerivedChannel::RunningMean:
+            for (int r = from; r < rowCount; ++r) {
+                // Gaps leave the mean unchanged
+                const bool valid = !std::isnan(y[r]);
+                state.count += valid;
+                state.accumulator += valid ? (y[r] - state.accumulator) / state.count : 0.0;
+                out.append(state.count > 0 ? state.accumulator : nan);
+            }
+            break;
+        case DerivedChannel::Formula:
+            break;
+        }
+    }
+}
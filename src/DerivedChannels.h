@@ -0,0 +1,70 @@
+#ifndef DERIVEDCHANNELS_H
+#define DERIVEDCHANNELS_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "RollingWindow.h"
+#include "Expression.h"
+
+// A column computed from other columns as rows are appended
+struct DerivedChannel {
+    enum Kind { MovingAverage, Derivative, Integral, RollingMin, RollingMax, RunningMean, Formula };
+    QString name;
+    QString source;
+    QString key;        // abscissa for derivative/integral; empty = row index
+    Kind kind = MovingAverage;
+    int window = 10;    // rows, for moving average and rolling extrema
+    QString expression; // formula over column names (see Expression)
+
+    QJsonObject toJson() const;
+    static DerivedChannel fromJson(const QJsonObject& obj);
+    static QString kindName(Kind kind);
+};
+
+QJsonArray derivedChannelsToJson(const QList<DerivedChannel>& channels);
+QList<DerivedChannel> derivedChannelsFromJson(const QJsonArray& array);
+
+// Maintains the derived columns of a column store. Each channel keeps only
+// O(window) state, so appending a row costs O(1) per channel and the history
+// is never revisited.
+class DerivedChannelEngine
+{
+public:
+    void setChannels(const QList<DerivedChannel>& channels);
+    QList<DerivedChannel> channels() const { return m_channels; }
+    QStringList names() const;
+    int size() const { return m_channels.size(); }
+
+    // Resolves source/key names against `headers` and clears the running state
+    void bind(const QStringList& headers);
+    // Appends derived values for rows [firstRow, rowCount) into the output
+    // columns starting at `firstOutputColumn`; rows an output column already
+    // holds are skipped
+    void update(QVector<QVector<double>>& columns, int firstOutputColumn, int firstRow, int rowCount);
+
+private:
+    struct State {
+        bool bound = false;
+        int sourceIndex = -1;
+        int keyIndex = -1;
+        Expression formula;
+        QVector<int> inputIndices;
+        RollingSum window;
+        RollingMinimum minimum;
+        RollingMaximum maximum;
+        bool hasPrevious = false;
+        double previousKey = 0.0;
+        double previousValue = 0.0;
+        double accumulator = 0.0;
+        qint64 count = 0;
+    };
+
+    QList<DerivedChannel> m_channels;
+    QVector<State> m_states;
+};
+
+#endif // DERIVEDCHANNELS_H
@@ -0,0 +1,173 @@
+#include "DialectSniffer.h"
+#include "CSVReader.h"
+#include <QStringList>
+#include <QMap>
+#include <QDebug>
+
+namespace {
+    const char* const kCommentPrefixes[] = { "#", "%", "//", "!" };
+
+    struct Candidate {
+        char separator;
+        bool whitespace;
+    };
+    // In order of preference when two candidates split the lines equally well
+    const Candidate kCandidates[] = { {',', false}, {';', false}, {'\t', false}, {'|', false}, {' ', true} };
+
+    // A line cut by the sample boundary is dropped
+    QStringList splitLines(const QByteArray& bytes, bool dropFirst, bool dropLast)
+    {
+        QStringList lines;
+        int begin = 0;
+        if (dropFirst) {
+            int newline = bytes.indexOf('\n');
+            begin = newline < 0 ? bytes.size() : newline + 1;
+        }
+        while (begin < bytes.size()) {
+            int end = bytes.indexOf('\n', begin);
+            if (end < 0) {
+                if (dropLast) break;
+                end = bytes.size();
+            }
+            int length = end - begin;
+            if (length > 0 && bytes.at(end - 1) == '\r') --length;
+            lines.append(QString::fromUtf8(bytes.constData() + begin, length));
+            begin = end + 1;
+        }
+        return lines;
+    }
+
+    bool isComment(const QString& line, const QString& prefix)
+    {
+        return !prefix.isEmpty() && line.trimmed().startsWith(prefix);
+    }
+
+    int numericCount(const QStringList& fields)
+    {
+        int count = 0;
+        for (const QString& field : fields) {
+            bool ok = false;
+            field.toDouble(&ok);
+            if (ok) ++count;
+        }
+        return count;
+    }
+}
+
+Dialect::Dialect() :
+    separator(','),
+    whitespaceSeparated(false),
+    startLine(1),
+    hasHeader(true),
+    ignoreNonNumeric(false),
+    columnCount(0)
+{
+}
+
+void Dialect::applyTo(CSVReader& reader) const
+{
+    reader.setSeparator(separator);
+    reader.setWhitespaceSeparated(whitespaceSeparated);
+    reader.setCommentPrefix(commentPrefix);
+    reader.setStartLine(startLine);
+    reader.setHasHeader(hasHeader);
+    reader.setIgnoreNonNumeric(ignoreNonNumeric);
+}
+
+Dialect DialectSniffer::sniff(const QByteArray& head, const QByteArray& tail)
+{
+    Dialect dialect;
+    const bool wholeFile = tail.isEmpty();
+    const QStringList headLines = splitLines(head, false, !wholeFile);
+    const QStringList tailLines = wholeFile ? headLines : splitLines(tail, true, false);
+
+    // Comment prefix: the candidate starting the most non-numeric lines
+    int bestComments = 0;
+    for (const char* prefix : kCommentPrefixes) {
+        int count = 0;
+        for (const QStringList* lines : { &headLines, &tailLines }) {
+            for (const QString& line : *lines) {
+                bool ok = false;
+                line.trimmed().toDouble(&ok);
+                if (!ok && isComment(line, prefix)) ++count;
+            }
+        }
+        if (count > bestComments) {
+            bestComments = count;
+            dialect.commentPrefix = prefix;
+        }
+    }
+
+    // Data lines come from the end of the file, away from any preamble
+    QStringList dataLines;
+    for (const QString& line : tailLines) {
+        if (!line.trimmed().isEmpty() && !isComment(line, dialect.commentPrefix)) dataLines.append(line);
+    }
+    if (dataLines.isEmpty()) return dialect;
+
+    // Separator: constant field count first, then the share of numeric fields
+    double bestScore = 0.0;
+    CSVReader probe;
+    for (const Candidate& candidate : kCandidates) {
+        probe.setSeparator(QChar(candidate.separator));
+        probe.setWhitespaceSeparated(candidate.whitespace);
+        QMap<int, int> lineCounts;
+        for (const QString& line : dataLines) lineCounts[probe.splitFields(line).size()]++;
+        int mode = 0;
+        for (int count : lineCounts.keys()) {
+            if (lineCounts.value(count) > lineCounts.value(mode)) mode = count;
+        }
+        double consistency = double(lineCounts.value(mode)) / dataLines.size();
+        if (mode < 2 || consistency < 0.8) continue;
+
+        int numeric = 0;
+        int fields = 0;
+        for (const QString& line : dataLines) {
+            QStringList split = probe.splitFields(line);
+            if (split.size() != mode) continue;
+            numeric += numericCount(split);
+            fields += split.size();
+        }
+        double score = consistency + double(numeric) / fields;
+        if (score > bestScore) {
+            bestScore = score;
+            dialect.separator = QChar(candidate.separator);
+            dialect.whitespaceSeparated = candidate.whitespace;
+            dialect.columnCount = mode;
+        }
+    }
+    if (dialect.columnCount == 0) dialect.columnCount = 1; // one column per line
+
+    probe.setSeparator(dialect.separator);
+    probe.setWhitespaceSeparated(dialect.whitespaceSeparated);
+
+    // First numeric line, then a header line right before it (blank lines aside)
+    int firstNumeric = -1;
+    for (int i = 0; i < headLines.size() && firstNumeric < 0; ++i) {
+        const QString& line = headLines.at(i);
+        if (line.trimmed().isEmpty() || isComment(line, dialect.commentPrefix)) continue;
+        QStringList fields = probe.splitFields(line);
+        if (fields.size() == dialect.columnCount && numericCount(fields) == fields.size()) firstNumeric = i;
+    }
+    // Non-numeric lines among the data (not the preamble of a small file)
+    const QStringList rows = wholeFile && firstNumeric >= 0 ? headLines.mid(firstNumeric) : dataLines;
+    for (const QString& line : rows) {
+        if (line.trimmed().isEmpty() || isComment(line, dialect.commentPrefix)) continue;
+        if (numericCount(probe.splitFields(line)) == 0) dialect.ignoreNonNumeric = true;
+    }
+    if (firstNumeric < 0) {
+        qDebug() << "DialectSniffer: no numeric line in the head sample";
+        return dialect;
+    }
+    int header = firstNumeric - 1;
+    while (header >= 0 && headLines.at(header).trimmed().isEmpty()) --header;
+    QStringList headerFields;
+    if (header >= 0) {
+        QString line = headLines.at(header);
+        if (isComment(line, dialect.commentPrefix)) line = line.trimmed().mid(dialect.commentPrefix.size()).trimmed();
+        headerFields = probe.splitFields(line);
+    }
+    dialect.hasHeader = headerFields.size() == dialect.columnCount && numericCount(headerFields) < headerFields.size();
+    dialect.startLine = (dialect.hasHeader ? header : firstNumeric) + 1;
+    return dialect;
+}
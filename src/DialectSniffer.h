@@ -0,0 +1,40 @@
+#ifndef DIALECTSNIFFER_H
+#define DIALECTSNIFFER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QChar>
+
+class CSVReader;
+
+// Parser settings inferred from samples of a file
+struct Dialect
+{
+    QChar separator;
+    bool whitespaceSeparated;
+    QString commentPrefix;
+    // Header line when hasHeader, else the first numeric line
+    int startLine;
+    bool hasHeader;
+    // Set when data lines without any number were seen (repeated headers)
+    bool ignoreNonNumeric;
+    // Fields per data line; 0 when nothing could be detected
+    int columnCount;
+
+    Dialect();
+    void applyTo(CSVReader& reader) const;
+};
+
+// Infers the dialect of a delimited or whitespace-aligned text file from its
+// first and last bytes: the separator (the candidate splitting the data lines
+// into a constant number of mostly numeric fields), the comment prefix, the
+// first numeric line and whether the line before it is a header.
+class DialectSniffer
+{
+public:
+    // `head` starts at the beginning of the file and `tail` ends at its end;
+    // `tail` is empty when `head` already holds the whole file
+    static Dialect sniff(const QByteArray& head, const QByteArray& tail);
+};
+
+#endif // DIALECTSNIFFER_H
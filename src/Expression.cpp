@@ -0,0 +1,442 @@
+#include "Expression.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Rows evaluated per instruction dispatch; small enough for the temporaries
+// of a typical expression to stay in cache
+static const int kBlockSize = 1024;
+
+static double applyUnary(Expression::Op op, double x)
+{
+    switch (op) {
+        case Expression::Neg: return -x;
+        case Expression::Abs: return std::fabs(x);
+        case Expression::Sqrt: return std::sqrt(x);
+        case Expression::Square: return x * x;
+        case Expression::Exp: return std::exp(x);
+        case Expression::Log: return std::log(x);
+        case Expression::Log10: return std::log10(x);
+        case Expression::Sin: return std::sin(x);
+        case Expression::Cos: return std::cos(x);
+        case Expression::Tan: return std::tan(x);
+        case Expression::Asin: return std::asin(x);
+        case Expression::Acos: return std::acos(x);
+        case Expression::Atan: return std::atan(x);
+        case Expression::Sinh: return std::sinh(x);
+        case Expression::Cosh: return std::cosh(x);
+        case Expression::Tanh: return std::tanh(x);
+        case Expression::Floor: return std::floor(x);
+        case Expression::Ceil: return std::ceil(x);
+        default: break;
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+static double applyBinary(Expression::Op op, double x, double y)
+{
+    switch (op) {
+        case Expression::Add: return x + y;
+        case Expression::Sub: return x - y;
+        case Expression::Mul: return x * y;
+        case Expression::Div: return x / y;
+        case Expression::Pow: return std::pow(x, y);
+        case Expression::Atan2: return std::atan2(x, y);
+        case Expression::Min: return std::fmin(x, y);
+        case Expression::Max: return std::fmax(x, y);
+        case Expression::Hypot: return std::hypot(x, y);
+        default: break;
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+template <typename F>
+static inline void unaryLoop(F f, const double* a, double* out, int n)
+{
+    for (int i = 0; i < n; ++i) out[i] = f(a[i]);
+}
+
+// At least one of a/b is an array; the other may be a scalar constant
+template <typename F>
+static inline void binaryLoop(F f, const double* a, double ca, const double* b, double cb, double* out, int n)
+{
+    if (a && b) {
+        for (int i = 0; i < n; ++i) out[i] = f(a[i], b[i]);
+    } else if (a) {
+        for (int i = 0; i < n; ++i) out[i] = f(a[i], cb);
+    } else {
+        for (int i = 0; i < n; ++i) out[i] = f(ca, b[i]);
+    }
+}
+
+static void runInstruction(Expression::Op op, const double* a, double ca, const double* b, double cb, double* out, int n)
+{
+    switch (op) {
+        case Expression::Neg: unaryLoop([](double x) { return -x; }, a, out, n); break;
+        case Expression::Abs: unaryLoop([](double x) { return std::fabs(x); }, a, out, n); break;
+        case Expression::Sqrt: unaryLoop([](double x) { return std::sqrt(x); }, a, out, n); break;
+        case Expression::Square: unaryLoop([](double x) { return x * x; }, a, out, n); break;
+        case Expression::Exp: unaryLoop([](double x) { return std::exp(x); }, a, out, n); break;
+        case Expression::Log: unaryLoop([](double x) { return std::log(x); }, a, out, n); break;
+        case Expression::Log10: unaryLoop([](double x) { return std::log10(x); }, a, out, n); break;
+        case Expression::Sin: unaryLoop([](double x) { return std::sin(x); }, a, out, n); break;
+        case Expression::Cos: unaryLoop([](double x) { return std::cos(x); }, a, out, n); break;
+        case Expression::Tan: unaryLoop([](double x) { return std::tan(x); }, a, out, n); break;
+        case Expression::Asin: unaryLoop([](double x) { return std::asin(x); }, a, out, n); break;
+        case Expression::Acos: unaryLoop([](double x) { return std::acos(x); }, a, out, n); break;
+        case Expression::Atan: unaryLoop([](double x) { return std::atan(x); }, a, out, n); break;
+        case Expression::Sinh: unaryLoop([](double x) { return std::sinh(x); }, a, out, n); break;
+        case Expression::Cosh: unaryLoop([](double x) { return std::cosh(x); }, a, out, n); break;
+        case Expression::Tanh: unaryLoop([](double x) { return std::tanh(x); }, a, out, n); break;
+        case Expression::Floor: unaryLoop([](double x) { return std::floor(x); }, a, out, n); break;
+        case Expression::Ceil: unaryLoop([](double x) { return std::ceil(x); }, a, out, n); break;
+        case Expression::Add: binaryLoop([](double x, double y) { return x + y; }, a, ca, b, cb, out, n); break;
+        case Expression::Sub: binaryLoop([](double x, double y) { return x - y; }, a, ca, b, cb, out, n); break;
+        case Expression::Mul: binaryLoop([](double x, double y) { return x * y; }, a, ca, b, cb, out, n); break;
+        case Expression::Div: binaryLoop([](double x, double y) { return x / y; }, a, ca, b, cb, out, n); break;
+        case Expression::Pow: binaryLoop([](double x, double y) { return std::pow(x, y); }, a, ca, b, cb, out, n); break;
+        case Expression::Atan2: binaryLoop([](double x, double y) { return std::atan2(x, y); }, a, ca, b, cb, out, n); break;
+        case Expression::Min: binaryLoop([](double x, double y) { return std::fmin(x, y); }, a, ca, b, cb, out, n); break;
+        case Expression::Max: binaryLoop([](double x, double y) { return std::fmax(x, y); }, a, ca, b, cb, out, n); break;
+        case Expression::Hypot: binaryLoop([](double x, double y) { return std::hypot(x, y); }, a, ca, b, cb, out, n); break;
+    }
+}
+
+// Recursive-descent parser that emits the register program directly.
+// Operations on constants are folded at compile time.
+class ExpressionCompiler
+{
+public:
+    ExpressionCompiler(Expression& expression, const QString& text) :
+        m_expr(expression), m_text(text), m_pos(0)
+    {
+    }
+
+    bool run(QString* error)
+    {
+        Expression::Operand result;
+        bool ok = parseSum(result);
+        if (ok) {
+            skipSpace();
+            if (m_pos < m_text.size()) {
+                ok = fail(QString("Unexpected '%1'").arg(m_text.at(m_pos)));
+            }
+        }
+        if (!ok) {
+            if (error) *error = m_error;
+            return false;
+        }
+        m_expr.m_result = result;
+        return true;
+    }
+
+private:
+    typedef Expression::Operand Operand;
+
+    Expression& m_expr;
+    QString m_text;
+    int m_pos;
+    QString m_error;
+    QVector<int> m_freeTemps;
+
+    bool fail(const QString& message)
+    {
+        if (m_error.isEmpty()) {
+            m_error = QString("%1 at position %2").arg(message).arg(m_pos + 1);
+        }
+        return false;
+    }
+
+    void skipSpace()
+    {
+        while (m_pos < m_text.size() && m_text.at(m_pos).isSpace()) ++m_pos;
+    }
+
+    bool accept(QChar c)
+    {
+        skipSpace();
+        if (m_pos < m_text.size() && m_text.at(m_pos) == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    int allocTemp()
+    {
+        if (!m_freeTemps.isEmpty()) return m_freeTemps.takeLast();
+        return m_expr.m_tempCount++;
+    }
+
+    void release(const Operand& operand)
+    {
+        if (operand.kind == Operand::Temp) m_freeTemps.append(operand.index);
+    }
+
+    Operand constant(double value)
+    {
+        Operand operand;
+        operand.kind = Operand::Constant;
+        operand.value = value;
+        return operand;
+    }
+
+    Operand emitUnary(Expression::Op op, const Operand& a)
+    {
+        if (a.kind == Operand::Constant) return constant(applyUnary(op, a.value));
+        // Element-wise ops may safely write over their own operand
+        release(a);
+        Operand dst;
+        dst.kind = Operand::Temp;
+        dst.index = allocTemp();
+        Expression::Instruction instruction = {op, dst.index, a, Operand()};
+        m_expr.m_program.append(instruction);
+        return dst;
+    }
+
+    Operand emitBinary(Expression::Op op, const Operand& a, const Operand& b)
+    {
+        if (a.kind == Operand::Constant && b.kind == Operand::Constant) {
+            return constant(applyBinary(op, a.value, b.value));
+        }
+        if (op == Expression::Pow && b.kind == Operand::Constant) {
+            if (b.value == 1.0) return a;
+            if (b.value == 2.0) return emitUnary(Expression::Square, a);
+            if (b.value == 0.5) return emitUnary(Expression::Sqrt, a);
+        }
+        release(a);
+        release(b);
+        Operand dst;
+        dst.kind = Operand::Temp;
+        dst.index = allocTemp();
+        Expression::Instruction instruction = {op, dst.index, a, b};
+        m_expr.m_program.append(instruction);
+        return dst;
+    }
+
+    bool parseSum(Operand& out)
+    {
+        if (!parseProduct(out)) return false;
+        while (true) {
+            Expression::Op op;
+            if (accept('+')) op = Expression::Add;
+            else if (accept('-')) op = Expression::Sub;
+            else return true;
+            Operand rhs;
+            if (!parseProduct(rhs)) return false;
+            out = emitBinary(op, out, rhs);
+        }
+    }
+
+    bool parseProduct(Operand& out)
+    {
+        if (!parseUnary(out)) return false;
+        while (true) {
+            Expression::Op op;
+            if (accept('*')) op = Expression::Mul;
+            else if (accept('/')) op = Expression::Div;
+            else return true;
+            Operand rhs;
+            if (!parseUnary(rhs)) return false;
+            out = emitBinary(op, out, rhs);
+        }
+    }
+
+    bool parseUnary(Operand& out)
+    {
+        if (accept('-')) {
+            if (!parseUnary(out)) return false;
+            out = emitUnary(Expression::Neg, out);
+            return true;
+        }
+        if (accept('+')) return parseUnary(out);
+        return parsePower(out);
+    }
+
+    // '^' is right-associative and binds tighter than unary minus on its left
+    bool parsePower(Operand& out)
+    {
+        if (!parsePrimary(out)) return false;
+        if (accept('^')) {
+            Operand exponent;
+            if (!parseUnary(exponent)) return false;
+            out = emitBinary(Expression::Pow, out, exponent);
+        }
+        return true;
+    }
+
+    bool parseNumber(Operand& out)
+    {
+        int start = m_pos;
+        while (m_pos < m_text.size() && (m_text.at(m_pos).isDigit() || m_text.at(m_pos) == '.')) ++m_pos;
+        if (m_pos < m_text.size() && (m_text.at(m_pos) == 'e' || m_text.at(m_pos) == 'E')) {
+            int mark = m_pos++;
+            if (m_pos < m_text.size() && (m_text.at(m_pos) == '+' || m_text.at(m_pos) == '-')) ++m_pos;
+            if (m_pos < m_text.size() && m_text.at(m_pos).isDigit()) {
+                while (m_pos < m_text.size() && m_text.at(m_pos).isDigit()) ++m_pos;
+            } else {
+                m_pos = mark;
+            }
+        }
+        bool ok = false;
+        double value = m_text.mid(start, m_pos - start).toDouble(&ok);
+        if (!ok) {
+            m_pos = start;
+            return fail("Invalid number");
+        }
+        out = constant(value);
+        return true;
+    }
+
+    Operand variable(const QString& name)
+    {
+        int index = m_expr.m_variables.indexOf(name);
+        if (index < 0) {
+            index = m_expr.m_variables.size();
+            m_expr.m_variables.append(name);
+        }
+        Operand operand;
+        operand.kind = Operand::Input;
+        operand.index = index;
+        return operand;
+    }
+
+    bool parseCall(const QString& name, Operand& out)
+    {
+        static const struct { const char* name; Expression::Op op; } unary[] = {
+            {"abs", Expression::Abs}, {"sqrt", Expression::Sqrt}, {"exp", Expression::Exp},
+            {"log", Expression::Log}, {"ln", Expression::Log}, {"log10", Expression::Log10},
+            {"sin", Expression::Sin}, {"cos", Expression::Cos}, {"tan", Expression::Tan},
+            {"asin", Expression::Asin}, {"acos", Expression::Acos}, {"atan", Expression::Atan},
+            {"sinh", Expression::Sinh}, {"cosh", Expression::Cosh}, {"tanh", Expression::Tanh},
+            {"floor", Expression::Floor}, {"ceil", Expression::Ceil}
+        };
+        static const struct { const char* name; Expression::Op op; } binary[] = {
+            {"pow", Expression::Pow}, {"atan2", Expression::Atan2}, {"min", Expression::Min},
+            {"max", Expression::Max}, {"hypot", Expression::Hypot}
+        };
+
+        Operand first;
+        if (!parseSum(first)) return false;
+        for (const auto& f : unary) {
+            if (name == QString(f.name)) {
+                if (!accept(')')) return fail(QString("%1() takes one argument").arg(name));
+                out = emitUnary(f.op, first);
+                return true;
+            }
+        }
+        for (const auto& f : binary) {
+            if (name == QString(f.name)) {
+                if (!accept(',')) return fail(QString("%1() takes two arguments").arg(name));
+                Operand second;
+                if (!parseSum(second)) return false;
+                if (!accept(')')) return fail("Expected ')'");
+                out = emitBinary(f.op, first, second);
+                return true;
+            }
+        }
+        return fail(QString("Unknown function '%1'").arg(name));
+    }
+
+    bool parsePrimary(Operand& out)
+    {
+        skipSpace();
+        if (m_pos >= m_text.size()) return fail("Unexpected end of expression");
+
+        QChar c = m_text.at(m_pos);
+        if (c == '(') {
+            ++m_pos;
+            if (!parseSum(out)) return false;
+            if (!accept(')')) return fail("Expected ')'");
+            return true;
+        }
+        if (c.isDigit() || c == '.') {
+            return parseNumber(out);
+        }
+        if (c == '"' || c == '`') {
+            int end = m_text.indexOf(c, m_pos + 1);
+            if (end < 0) return fail("Unterminated column name");
+            out = variable(m_text.mid(m_pos + 1, end - m_pos - 1));
+            m_pos = end + 1;
+            return true;
+        }
+        if (c.isLetter() || c == '_') {
+            int start = m_pos;
+            while (m_pos < m_text.size() && (m_text.at(m_pos).isLetterOrNumber() || m_text.at(m_pos) == '_' || m_text.at(m_pos) == '.')) ++m_pos;
+            QString name = m_text.mid(start, m_pos - start);
+            if (accept('(')) return parseCall(name.toLower(), out);
+            if (name == "pi") {
+                out = constant(3.14159265358979323846);
+            } else if (name == "e") {
+                out = constant(2.71828182845904523536);
+            } else {
+                out = variable(name);
+            }
+            return true;
+        }
+        return fail(QString("Unexpected '%1'").arg(c));
+    }
+};
+
+Expression::Expression()
+    : m_valid(false),
+      m_tempCount(0)
+{
+}
+
+bool Expression::compile(const QString& text, QString* error)
+{
+    m_text = text;
+    m_variables.clear();
+    m_program.clear();
+    m_result = Operand();
+    m_tempCount = 0;
+    m_scratch.clear();
+
+    ExpressionCompiler compiler(*this, text);
+    m_valid = compiler.run(error);
+    if (!m_valid) {
+        m_variables.clear();
+        m_program.clear();
+    }
+    return m_valid;
+}
+
+void Expression::evaluate(const QVector<const double*>& inputs, int first, int count, double* out) const
+{
+    if (count <= 0) return;
+    if (!m_valid || inputs.size() < m_variables.size()) {
+        std::fill(out, out + count, std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+
+    if (m_scratch.size() != m_tempCount) {
+        m_scratch = QVector<QVector<double>>(m_tempCount, QVector<double>(kBlockSize));
+    }
+    QVector<double*> temps(m_tempCount);
+    for (int t = 0; t < m_tempCount; ++t) {
+        temps[t] = m_scratch[t].data();
+    }
+
+    for (int start = 0; start < count; start += kBlockSize) {
+        const int n = std::min(kBlockSize, count - start);
+        const int offset = first + start;
+        auto pointer = [&](const Operand& operand) -> const double* {
+            if (operand.kind == Operand::Input) return inputs.at(operand.index) + offset;
+            if (operand.kind == Operand::Temp) return temps.at(operand.index);
+            return nullptr;
+        };
+
+        for (const Instruction& instruction : m_program) {
+            runInstruction(instruction.op, pointer(instruction.a), instruction.a.value,
+                           pointer(instruction.b), instruction.b.value, temps[instruction.dst], n);
+        }
+
+        const double* result = pointer(m_result);
+        if (result) {
+            std::copy(result, result + n, out + start);
+        } else {
+            std::fill(out + start, out + start + n, m_result.value);
+        }
+    }
+}
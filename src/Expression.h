@@ -0,0 +1,64 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Arithmetic expression over named columns, e.g. "sqrt(Fx^2+Fy^2)/qinf".
+// The text is parsed once into a flat register program; evaluation runs
+// each instruction over a block of rows at a time, so the interpretive
+// dispatch is paid per block and the inner loops are plain array arithmetic.
+//
+// Syntax: numbers, column names ([A-Za-z_][A-Za-z0-9_.]* or quoted with
+// "..." / `...`), + - * / ^, parentheses, constants pi and e, and the
+// functions abs sqrt exp log log10 sin cos tan asin acos atan sinh cosh tanh
+// floor ceil (one argument) and pow atan2 min max hypot (two arguments).
+class Expression
+{
+public:
+    Expression();
+
+    bool compile(const QString& text, QString* error = nullptr);
+    bool isValid() const { return m_valid; }
+    QString text() const { return m_text; }
+    // Column names referenced by the expression, in input order
+    QStringList variables() const { return m_variables; }
+
+    // inputs[i] points to the column data of variables()[i]; evaluates rows
+    // [first, first + count) and writes `count` values to out
+    void evaluate(const QVector<const double*>& inputs, int first, int count, double* out) const;
+
+    enum Op {
+        Neg, Abs, Sqrt, Square, Exp, Log, Log10, Sin, Cos, Tan, Asin, Acos, Atan,
+        Sinh, Cosh, Tanh, Floor, Ceil,
+        Add, Sub, Mul, Div, Pow, Atan2, Min, Max, Hypot
+    };
+
+    struct Operand {
+        enum Kind { Constant, Input, Temp };
+        Kind kind = Constant;
+        int index = 0;
+        double value = 0.0;
+    };
+
+private:
+    struct Instruction {
+        Op op;
+        int dst;
+        Operand a;
+        Operand b;
+    };
+
+    QString m_text;
+    bool m_valid;
+    QStringList m_variables;
+    QVector<Instruction> m_program;
+    Operand m_result;
+    int m_tempCount;
+    mutable QVector<QVector<double>> m_scratch;
+
+    friend class ExpressionCompiler;
+};
+
+#endif // EXPRESSION_H
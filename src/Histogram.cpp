@@ -0,0 +1,99 @@
+#include "Histogram.h"
+#include <cmath>
+
+IncrementalHistogram::IncrementalHistogram()
+{
+    configure(50, true);
+}
+
+void IncrementalHistogram::configure(int bins, bool autoRange, double lower, double upper)
+{
+    int count = qMax(2, bins);
+    if (count % 2) ++count;
+    m_counts = QVector<qint64>(count, 0);
+    m_autoRange = autoRange;
+    m_fixedLower = lower;
+    m_fixedUpper = upper > lower ? upper : lower + 1.0;
+    reset();
+}
+
+void IncrementalHistogram::reset()
+{
+    m_counts.fill(0);
+    m_initialized = !m_autoRange;
+    m_lower = m_autoRange ? 0.0 : m_fixedLower;
+    m_width = m_autoRange ? 1.0 / m_counts.size() : (m_fixedUpper - m_fixedLower) / m_counts.size();
+    m_total = 0;
+    m_underflow = 0;
+    m_overflow = 0;
+}
+
+int IncrementalHistogram::binIndex(double value) const
+{
+    int bin = static_cast<int>(std::floor((value - m_lower) / m_width));
+    return qBound(0, bin, m_counts.size() - 1);
+}
+
+void IncrementalHistogram::expandToCover(double value)
+{
+    if (!m_initialized) {
+        // Narrow range centred on the first sample; it only ever grows
+        double span = qMax(std::fabs(value), 1.0) * 1e-6;
+        m_width = span / m_counts.size();
+        m_lower = value - 0.5 * span;
+        m_initialized = true;
+    }
+
+    const int bins = m_counts.size();
+    const int half = bins / 2;
+    while (value < m_lower || value >= upper()) {
+        // Merge pairs into one half and double the width towards the value
+        bool growUp = value >= upper();
+        QVector<qint64> merged(bins, 0);
+        int offset = growUp ? 0 : half;
+        for (int i = 0; i < half; ++i) {
+            merged[offset + i] = m_counts[2 * i] + m_counts[2 * i + 1];
+        }
+        if (!growUp) m_lower -= m_width * bins;
+        m_width *= 2.0;
+        m_counts = merged;
+    }
+}
+
+void IncrementalHistogram::add(double value)
+{
+    if (!std::isfinite(value)) return;
+    if (m_autoRange) {
+        expandToCover(value);
+    } else if (value < m_lower) {
+        ++m_underflow;
+        return;
+    } else if (value >= upper()) {
+        ++m_overflow;
+        return;
+    }
+    ++m_counts[binIndex(value)];
+    ++m_total;
+}
+
+void IncrementalHistogram::remove(double value)
+{
+    if (!std::isfinite(value)) return;
+    // Out-of-range samples are not part of m_total
+    if (!m_autoRange) {
+        if (value < m_lower) {
+            if (m_underflow > 0) --m_underflow;
+            return;
+        }
+        if (value >= upper()) {
+            if (m_overflow > 0) --m_overflow;
+            return;
+        }
+    }
+    if (m_total == 0) return;
+    qint64& count = m_counts[binIndex(value)];
+    if (count > 0) {
+        --count;
+        --m_total;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <QVector>
+
+// Histogram with a constant number of bins that supports adding and removing
+// samples in O(1). In auto-range mode the range starts narrow around the
+// first sample and doubles towards out-of-range values by merging adjacent
+// bins, so samples are never re-binned. In fixed mode out-of-range samples
+// are only counted as underflow/overflow.
+class IncrementalHistogram
+{
+public:
+    IncrementalHistogram();
+
+    // `bins` is rounded up to an even count so that bins can be merged pairwise
+    void configure(int bins, bool autoRange, double lower = 0.0, double upper = 1.0);
+    void reset();
+
+    void add(double value);
+    // Removes a sample previously added (sliding windows)
+    void remove(double value);
+
+    int binCount() const { return m_counts.size(); }
+    bool isEmpty() const { return m_total == 0; }
+    double lower() const { return m_lower; }
+    double upper() const { return m_lower + m_width * m_counts.size(); }
+    double binWidth() const { return m_width; }
+    double binCenter(int bin) const { return m_lower + (bin + 0.5) * m_width; }
+    const QVector<qint64>& counts() const { return m_counts; }
+    qint64 total() const { return m_total; }
+    qint64 underflow() const { return m_underflow; }
+    qint64 overflow() const { return m_overflow; }
+
+private:
+    QVector<qint64> m_counts;
+    bool m_autoRange;
+    bool m_initialized;
+    double m_fixedLower;
+    double m_fixedUpper;
+    double m_lower;
+    double m_width;
+    qint64 m_total;
+    qint64 m_underflow;
+    qint64 m_overflow;
+
+    int binIndex(double value) const;
+    void expandToCover(double value);
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,182 @@
+#include "HistogramPanel.h"
+#include "CSVReader.h"
+#include "qcustomplot.h"
+#include <QComboBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QDoubleValidator>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+HistogramPanel::HistogramPanel(QWidget *parent) :
+    QDockWidget(tr("Histogram"), parent),
+    m_reader(nullptr),
+    m_columnIndex(-1),
+    m_firstRow(0),
+    m_consumedRows(0),
+    m_stale(false)
+{
+    QWidget* content = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(content);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    QHBoxLayout* settingsLayout = new QHBoxLayout();
+    m_columnComboBox = new QComboBox(content);
+    settingsLayout->addWidget(m_columnComboBox);
+    settingsLayout->addWidget(new QLabel(tr("Bins:"), content));
+    m_binSpinBox = new QSpinBox(content);
+    m_binSpinBox->setRange(2, 2000);
+    m_binSpinBox->setSingleStep(2);
+    m_binSpinBox->setValue(50);
+    settingsLayout->addWidget(m_binSpinBox);
+    m_rangeComboBox = new QComboBox(content);
+    m_rangeComboBox->addItem(tr("Auto range"));
+    m_rangeComboBox->addItem(tr("Fixed range"));
+    settingsLayout->addWidget(m_rangeComboBox);
+    m_lowerEdit = new QLineEdit("0", content);
+    m_lowerEdit->setValidator(new QDoubleValidator(m_lowerEdit));
+    m_lowerEdit->setMaximumWidth(80);
+    m_lowerEdit->setEnabled(false);
+    settingsLayout->addWidget(m_lowerEdit);
+    m_upperEdit = new QLineEdit("1", content);
+    m_upperEdit->setValidator(new QDoubleValidator(m_upperEdit));
+    m_upperEdit->setMaximumWidth(80);
+    m_upperEdit->setEnabled(false);
+    settingsLayout->addWidget(m_upperEdit);
+    settingsLayout->addWidget(new QLabel(tr("Window:"), content));
+    m_windowSpinBox = new QSpinBox(content);
+    m_windowSpinBox->setRange(0, 100000000);
+    m_windowSpinBox->setSpecialValueText(tr("All rows"));
+    settingsLayout->addWidget(m_windowSpinBox);
+    m_densityCheckBox = new QCheckBox(tr("Density"), content);
+    settingsLayout->addWidget(m_densityCheckBox);
+    settingsLayout->addStretch();
+    layout->addLayout(settingsLayout);
+
+    m_plot = new QCustomPlot(content);
+    m_plot->setInteraction(QCP::iRangeDrag, true);
+    m_plot->setInteraction(QCP::iRangeZoom, true);
+    m_bars = new QCPBars(m_plot->xAxis, m_plot->yAxis);
+    m_bars->setWidthType(QCPBars::wtPlotCoords);
+    m_plot->yAxis->setLabel(tr("Count"));
+    m_plot->setMinimumHeight(200);
+    layout->addWidget(m_plot);
+    setWidget(content);
+
+    connect(m_columnComboBox, &QComboBox::currentIndexChanged, this, &HistogramPanel::onSettingsChanged);
+    connect(m_binSpinBox, &QSpinBox::valueChanged, this, &HistogramPanel::onSettingsChanged);
+    connect(m_rangeComboBox, &QComboBox::currentIndexChanged, this, [this](int index) {
+        m_lowerEdit->setEnabled(index == 1);
+        m_upperEdit->setEnabled(index == 1);
+        onSettingsChanged();
+    });
+    connect(m_lowerEdit, &QLineEdit::editingFinished, this, &HistogramPanel::onSettingsChanged);
+    connect(m_upperEdit, &QLineEdit::editingFinished, this, &HistogramPanel::onSettingsChanged);
+    connect(m_windowSpinBox, &QSpinBox::valueChanged, this, &HistogramPanel::onSettingsChanged);
+    // Normalisation only changes the drawing, not the counts
+    connect(m_densityCheckBox, &QCheckBox::toggled, this, &HistogramPanel::redraw);
+    connect(this, &QDockWidget::visibilityChanged, this, &HistogramPanel::onVisibilityChanged);
+}
+
+void HistogramPanel::setSource(const CSVReader* reader, const QStringList& columns, const QString& defaultColumn)
+{
+    m_reader = reader;
+    QString current = m_columnComboBox->currentText();
+    {
+        QSignalBlocker blocker(m_columnComboBox);
+        m_columnComboBox->clear();
+        m_columnComboBox->addItems(columns);
+        int index = columns.indexOf(current);
+        if (index < 0) index = columns.indexOf(defaultColumn);
+        m_columnComboBox->setCurrentIndex(qMax(0, index));
+    }
+    rebuild();
+}
+
+void HistogramPanel::appendRows(int firstRow)
+{
+    if (!m_reader) return;
+    if (firstRow == 0 || m_reader->getRowCount() < m_consumedRows) {
+        rebuild();
+        return;
+    }
+    if (!isVisible()) {
+        m_stale = true;
+        return;
+    }
+    consume(m_consumedRows, m_reader->getRowCount());
+    redraw();
+}
+
+void HistogramPanel::onSettingsChanged()
+{
+    rebuild();
+}
+
+void HistogramPanel::onVisibilityChanged(bool visible)
+{
+    if (visible && m_stale) rebuild();
+}
+
+void HistogramPanel::rebuild()
+{
+    m_columnIndex = m_reader ? m_reader->getColumnIndex(m_columnComboBox->currentText()) : -1;
+    m_histogram.configure(m_binSpinBox->value(), m_rangeComboBox->currentIndex() == 0,
+                          m_lowerEdit->text().toDouble(), m_upperEdit->text().toDouble());
+    m_firstRow = 0;
+    m_consumedRows = 0;
+    if (!isVisible()) {
+        m_stale = true;
+        return;
+    }
+    m_stale = false;
+    if (m_reader && m_columnIndex >= 0) {
+        // With a sliding window only its rows need to be read
+        int rowCount = m_reader->getRowCount();
+        int window = m_windowSpinBox->value();
+        m_firstRow = window > 0 ? qMax(0, rowCount - window) : 0;
+        m_consumedRows = m_firstRow;
+        consume(m_firstRow, rowCount);
+    }
+    redraw();
+}
+
+void HistogramPanel::consume(int firstRow, int lastRow)
+{
+    if (m_columnIndex < 0 || firstRow >= lastRow) return;
+    const QVector<double>& values = m_reader->getColumn(m_columnIndex);
+    if (values.size() < lastRow) return;
+
+    const double* y = values.constData();
+    const int window = m_windowSpinBox->value();
+    for (int r = firstRow; r < lastRow; ++r) {
+        m_histogram.add(y[r]);
+        // Rows before m_firstRow were never added, so they are not removed
+        if (window > 0 && r - window >= m_firstRow) {
+            m_histogram.remove(y[r - window]);
+        }
+    }
+    m_consumedRows = lastRow;
+}
+
+void HistogramPanel::redraw()
+{
+    const int bins = m_histogram.binCount();
+    const bool density = m_densityCheckBox->isChecked() && m_histogram.total() > 0;
+    const double scale = density ? 1.0 / (m_histogram.total() * m_histogram.binWidth()) : 1.0;
+    QVector<double> keys(bins);
+    QVector<double> values(bins);
+    for (int i = 0; i < bins; ++i) {
+        keys[i] = m_histogram.binCenter(i);
+        values[i] = m_histogram.counts().at(i) * scale;
+    }
+    m_bars->setWidth(m_histogram.binWidth());
+    m_bars->setData(keys, values, true);
+    m_bars->setName(m_columnComboBox->currentText());
+    m_plot->xAxis->setLabel(m_columnComboBox->currentText());
+    m_plot->yAxis->setLabel(density ? tr("Probability density") : tr("Count"));
+    m_plot->rescaleAxes();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
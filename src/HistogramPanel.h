@@ -0,0 +1,55 @@
+#ifndef HISTOGRAMPANEL_H
+#define HISTOGRAMPANEL_H
+
+#include <QDockWidget>
+#include <QStringList>
+#include "Histogram.h"
+
+class QComboBox;
+class QSpinBox;
+class QCheckBox;
+class QLineEdit;
+class QCustomPlot;
+class QCPBars;
+class CSVReader;
+
+// Live histogram / probability density of one column. Each append costs
+// O(new rows): samples leaving the sliding window are subtracted, and the
+// bars are redrawn only while the dock is visible.
+class HistogramPanel : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit HistogramPanel(QWidget *parent = nullptr);
+
+    void setSource(const CSVReader* reader, const QStringList& columns, const QString& defaultColumn);
+    // Accumulates rows appended since the last call; firstRow == 0 restarts
+    void appendRows(int firstRow);
+
+private slots:
+    void onSettingsChanged();
+    void onVisibilityChanged(bool visible);
+
+private:
+    const CSVReader* m_reader;
+    int m_columnIndex;
+    int m_firstRow;     // first row added since the last rebuild
+    int m_consumedRows;
+    bool m_stale;
+    IncrementalHistogram m_histogram;
+    QComboBox* m_columnComboBox;
+    QSpinBox* m_binSpinBox;
+    QComboBox* m_rangeComboBox;
+    QLineEdit* m_lowerEdit;
+    QLineEdit* m_upperEdit;
+    QSpinBox* m_windowSpinBox;
+    QCheckBox* m_densityCheckBox;
+    QCustomPlot* m_plot;
+    QCPBars* m_bars;
+
+    void rebuild();
+    void consume(int firstRow, int lastRow);
+    void redraw();
+};
+
+#endif // HISTOGRAMPANEL_H
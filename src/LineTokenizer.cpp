@@ -0,0 +1,219 @@
+#include "LineTokenizer.h"
+#include "CSVReader.h"
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+namespace {
+    const double kMissing = std::numeric_limits<double>::quiet_NaN();
+
+    inline bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    // Reads a number bounded by [begin, end); surrounding blanks are allowed
+    inline bool readNumber(const char* begin, const char* end, double& value)
+    {
+        bool ok = false;
+        value = QByteArray::fromRawData(begin, int(end - begin)).toDouble(&ok);
+        if (ok) return true;
+        // Fortran double precision exponents (1.0D+03) are only tried on failure
+        const int length = int(end - begin);
+        if (length > 0 && length < 64 && (std::memchr(begin, 'D', length) || std::memchr(begin, 'd', length))) {
+            char buffer[64];
+            for (int i = 0; i < length; ++i) buffer[i] = (begin[i] == 'D' || begin[i] == 'd') ? 'E' : begin[i];
+            value = QByteArray::fromRawData(buffer, length).toDouble(&ok);
+            if (ok) return true;
+        }
+        // Overflow markers (*****), text and empty fields are gaps, not zeros
+        value = kMissing;
+        return false;
+    }
+
+    QString trimmedText(const char* begin, const char* end)
+    {
+        while (begin < end && isBlank(*begin)) ++begin;
+        while (end > begin && isBlank(end[-1])) --end;
+        return QString::fromUtf8(begin, int(end - begin));
+    }
+}
+
+LineTokenizer::LineTokenizer() :
+    m_format(Delimited),
+    m_separator(',')
+{
+}
+
+LineTokenizer::LineTokenizer(const CSVReader& settings) :
+    m_separator(settings.getSeparator().toLatin1()),
+    m_commentPrefix(settings.getCommentPrefix().toUtf8()),
+    m_widths(settings.getFixedWidths())
+{
+    if (!m_widths.isEmpty()) m_format = FixedWidth;
+    else if (settings.getWhitespaceSeparated()) m_format = Whitespace;
+    else m_format = Delimited;
+}
+
+bool LineTokenizer::isComment(const char* begin, const char* end) const
+{
+    if (m_commentPrefix.isEmpty()) return false;
+    while (begin < end && isBlank(*begin)) ++begin;
+    return end - begin >= m_commentPrefix.size()
+        && std::memcmp(begin, m_commentPrefix.constData(), m_commentPrefix.size()) == 0;
+}
+
+int LineTokenizer::fieldCount(const char* begin, const char* end) const
+{
+    switch (m_format) {
+    case Delimited: {
+        end = delimitedEnd(begin, end);
+        int count = 1;
+        for (const char* p = begin; (p = static_cast<const char*>(std::memchr(p, m_separator, end - p))); ++p) ++count;
+        return count;
+    }
+    case Whitespace: {
+        int count = 0;
+        for (const char* p = begin; p < end;) {
+            while (p < end && isBlank(*p)) ++p;
+            if (p == end) break;
+            ++count;
+            while (p < end && !isBlank(*p)) ++p;
+        }
+        return count;
+    }
+    case FixedWidth: {
+        int count = 0;
+        for (qint64 offset = 0; count < m_widths.size() && offset < end - begin; offset += m_widths.at(count++)) {}
+        return count;
+    }
+    }
+    return 0;
+}
+
+int LineTokenizer::tokenize(const char* begin, const char* end, QVector<double>& row, int* fields) const
+{
+    int count = 0;
+    int numeric = 0;
+    switch (m_format) {
+    case Delimited: numeric = tokenizeDelimited(begin, delimitedEnd(begin, end), row.data(), row.size(), count); break;
+    case Whitespace: numeric = tokenizeWhitespace(begin, end, row.data(), row.size(), count); break;
+    case FixedWidth: numeric = tokenizeFixedWidth(begin, end, row.data(), row.size(), count); break;
+    }
+    if (fields) *fields = count;
+    return numeric;
+}
+
+const char* LineTokenizer::delimitedEnd(const char* begin, const char* end) const
+{
+    const char* p = end;
+    while (p > begin && p[-1] != m_separator && isBlank(p[-1])) --p;
+    return p > begin && p[-1] == m_separator ? p - 1 : end;
+}
+
+int LineTokenizer::tokenizeDelimited(const char* p, const char* end, double* row, int columns, int& fields) const
+{
+    int numeric = 0;
+    int c = 0;
+    // Leaving the loop without reaching the end means a separator is left
+    bool more = true;
+    while (c < columns) {
+        const char* stop = static_cast<const char*>(std::memchr(p, m_separator, end - p));
+        if (!stop) stop = end;
+        numeric += readNumber(p, stop, row[c++]);
+        if (stop == end) {
+            more = false;
+            break;
+        }
+        p = stop + 1;
+    }
+    std::fill(row + c, row + columns, kMissing);
+    fields = c + more;
+    return numeric;
+}
+
+int LineTokenizer::tokenizeWhitespace(const char* p, const char* end, double* row, int columns, int& fields) const
+{
+    int numeric = 0;
+    int c = 0;
+    while (c < columns) {
+        while (p < end && isBlank(*p)) ++p;
+        if (p == end) break;
+        const char* stop = p;
+        while (stop < end && !isBlank(*stop)) ++stop;
+        numeric += readNumber(p, stop, row[c++]);
+        p = stop;
+    }
+    std::fill(row + c, row + columns, kMissing);
+    while (p < end && isBlank(*p)) ++p;
+    fields = c + (p < end);
+    return numeric;
+}
+
+int LineTokenizer::tokenizeFixedWidth(const char* p, const char* end, double* row, int columns, int& fields) const
+{
+    int numeric = 0;
+    int c = 0;
+    const int widths = m_widths.size();
+    while (c < columns && c < widths && p < end) {
+        const char* stop = end - p > m_widths.at(c) ? p + m_widths.at(c) : end;
+        numeric += readNumber(p, stop, row[c++]);
+        p = stop;
+    }
+    std::fill(row + c, row + columns, kMissing);
+    fields = c + (c < widths && p < end);
+    return numeric;
+}
+
+QStringList LineTokenizer::split(const char* begin, const char* end) const
+{
+    QStringList fields;
+    switch (m_format) {
+    case Delimited:
+        end = delimitedEnd(begin, end);
+        for (const char* p = begin;;) {
+            const char* stop = static_cast<const char*>(std::memchr(p, m_separator, end - p));
+            if (!stop) stop = end;
+            fields.append(QString::fromUtf8(p, int(stop - p)));
+            if (stop == end) break;
+            p = stop + 1;
+        }
+        break;
+    case Whitespace:
+        for (const char* p = begin; p < end;) {
+            while (p < end && isBlank(*p)) ++p;
+            if (p == end) break;
+            const char* stop = p;
+            while (stop < end && !isBlank(*stop)) ++stop;
+            fields.append(QString::fromUtf8(p, int(stop - p)));
+            p = stop;
+        }
+        break;
+    case FixedWidth:
+        for (int c = 0; c < m_widths.size() && begin < end; ++c) {
+            const char* stop = end - begin > m_widths.at(c) ? begin + m_widths.at(c) : end;
+            fields.append(trimmedText(begin, stop));
+            begin = stop;
+        }
+        break;
+    }
+    return fields;
+}
+
+QStringList LineTokenizer::header(const char* begin, const char* end) const
+{
+    if (!isComment(begin, end)) return split(begin, end);
+    // Space-padded outputs often write their header as "# Time  p  U". The
+    // prefix is blanked out so that fixed-width columns keep their alignment.
+    QByteArray line(begin, int(end - begin));
+    int prefix = 0;
+    while (isBlank(line.at(prefix))) ++prefix;
+    std::memset(line.data() + prefix, ' ', m_commentPrefix.size());
+    const char* p = line.constData();
+    const char* stop = p + line.size();
+    if (m_format == Delimited) {
+        while (p < stop && isBlank(*p)) ++p;
+        while (stop > p && isBlank(stop[-1])) --stop;
+    }
+    return split(p, stop);
+}
@@ -0,0 +1,51 @@
+#ifndef LINETOKENIZER_H
+#define LINETOKENIZER_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+class CSVReader;
+
+// Byte-level field splitting shared by CSVReader and SparseRowIndex. Each
+// line format has its own loop: a single separator character, runs of
+// spaces and tabs (space-padded solver output), or fixed column widths
+// (Fortran output without separators). Lines are given without their line
+// break; numbers are read without a QString round trip.
+class LineTokenizer
+{
+public:
+    enum Format { Delimited, Whitespace, FixedWidth };
+
+    LineTokenizer();
+    // Format, separator, widths and comment prefix of the reader's settings
+    explicit LineTokenizer(const CSVReader& settings);
+
+    Format format() const { return m_format; }
+    bool isComment(const char* begin, const char* end) const;
+    int fieldCount(const char* begin, const char* end) const;
+    // Fills row[0, row.size()) from the fields of a line. Missing and
+    // unparsable fields read as NaN, extra fields are dropped. Returns the
+    // number of fields that are numbers. `fields` receives the number of
+    // fields of the line, row.size() + 1 when some were dropped.
+    int tokenize(const char* begin, const char* end, QVector<double>& row, int* fields = nullptr) const;
+    // Field texts, for headers and previews. Fixed-width fields are trimmed.
+    QStringList split(const char* begin, const char* end) const;
+    // Column names of a header line; a comment prefix is removed first
+    QStringList header(const char* begin, const char* end) const;
+
+private:
+    Format m_format;
+    char m_separator;
+    QByteArray m_commentPrefix;
+    QVector<int> m_widths;
+
+    // End of the fields of a delimited line: a separator closing the line
+    // ("1,2,3," as many solvers write) does not open an empty last field
+    const char* delimitedEnd(const char* begin, const char* end) const;
+    int tokenizeDelimited(const char* p, const char* end, double* row, int columns, int& fields) const;
+    int tokenizeWhitespace(const char* p, const char* end, double* row, int columns, int& fields) const;
+    int tokenizeFixedWidth(const char* p, const char* end, double* row, int columns, int& fields) const;
+};
+
+#endif // LINETOKENIZER_H
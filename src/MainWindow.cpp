@@ -2,6 +2,19 @@
 #include "ui_MainWindow.h"
 #include "qcustomplot.h"
 #include "ParserConfigDialog.h"
+#include "PlotGrid.h"
+#include "DerivedChannelDialog.h"
+#include "StatisticsPanel.h"
+#include "SpectrumPanel.h"
+#include "HistogramPanel.h"
+#include "WaterfallPanel.h"
+#include "MonitorRuleDialog.h"
+#include "OutOfCoreView.h"
+#include "CompressedFile.h"
+#include "BackfillLoader.h"
+#include "StreamSource.h"
+#include "SharedRingSource.h"
+#include "DialectSniffer.h"
 #include <QFileDialog>
 #include <stdexcept>
 #include <QJsonDocument>
@@ -16,6 +29,24 @@
 #include <QSvgRenderer>
 #include <QPixmap>
 #include <QPainter>
+#include <QDoubleSpinBox>
+#include <QProgressDialog>
+#include <QProgressBar>
+#include <QToolButton>
+#include <QHBoxLayout>
+#include <QLocale>
+#include <QTimer>
+
+// Number of graphs above which plots are laid out in the virtualized grid
+static const int kVirtualizedPlotThreshold = 8;
+// Bytes read from the end of a data file before the first plot; older rows
+// are backfilled in the background, so opening time does not grow with the file
+static const qint64 kTailFirstBytes = 4 * 1024 * 1024;
+// Lines (or bytes) of a stream collected before its dialect is sniffed
+static const int kStreamSniffLines = 50;
+static const int kStreamSniffBytes = 64 * 1024;
+// Shared-ring records copied per poll, so that a backlog does not stall the UI
+static const int kRingRecordsPerPoll = 1 << 20;
 
 // Helper to render an SVG resource to a QPixmap at a given size
 static QPixmap loadSvgPixmap(const QString& path, const QSize& size)
@@ -118,7 +149,8 @@ static QIcon loadColoredIcon(const QString& path, const QColor& color = QColor()
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    m_monitorLabel(nullptr)
 {
     ui->setupUi(this);
     // Set window icon from bundled logo
@@ -135,6 +167,72 @@ MainWindow::MainWindow(QWidget *parent) :
     // Use menus/actions declared in the .ui file.
     menuBar()->setFixedHeight(22);
 
+    m_plotManager.setCrosshairEnabled(ui->actionCrosshair->isChecked());
+
+    // Width of the follow-tail window, in X units, next to its toolbar toggle
+    m_followSpanSpinBox = new QDoubleSpinBox(this);
+    m_followSpanSpinBox->setRange(1e-9, 1e12);
+    m_followSpanSpinBox->setDecimals(3);
+    m_followSpanSpinBox->setValue(1000.0);
+    m_followSpanSpinBox->setToolTip(tr("Follow window (X span)"));
+    QList<QAction*> toolActions = ui->toolBar->actions();
+    ui->toolBar->insertWidget(toolActions.value(toolActions.indexOf(ui->actionFollowTail) + 1), m_followSpanSpinBox);
+    connect(m_followSpanSpinBox, &QDoubleSpinBox::valueChanged, this, [this](double span) {
+        if (ui->actionFollowTail->isChecked()) m_plotManager.setFollowSpan(span);
+    });
+
+    // Virtualized plot area used instead of the splitter for large dashboards
+    m_virtualizedPlots = false;
+    m_plotGrid = new PlotGrid(&m_plotManager, this);
+    m_outOfCoreView = new OutOfCoreView(&m_plotManager, this);
+
+    // History of tail-first opens, read backwards on a worker thread
+    m_backfill = new BackfillLoader(this);
+    connect(m_backfill, &BackfillLoader::rowsPrepended, this, [this]() {
+        refreshFromReader(false);
+    });
+    // A complete history is kept so reopening the file needs no new pass
+    connect(m_backfill, &BackfillLoader::finished, this, [this]() {
+        if (m_reader.isComplete()) m_parseCache.store(m_reader);
+    });
+    m_plotGrid->hide();
+    ui->verticalLayout->addWidget(m_plotGrid);
+
+    // Standard input or a named pipe, read on an ingest thread
+    m_stream = new StreamSource(this);
+    m_streamConfigured = false;
+    connect(m_stream, &StreamSource::readyRead, this, &MainWindow::onStreamReadyRead);
+    // Binary records from a solver through shared memory
+    m_ring = new SharedRingSource(this);
+    connect(m_ring, &SharedRingSource::readyRead, this, &MainWindow::onRingReadyRead);
+
+    // Live statistics of the plotted columns, hidden until toggled from View
+    m_statisticsPanel = new StatisticsPanel(this);
+    m_statisticsPanel->setObjectName("statisticsPanel");
+    addDockWidget(Qt::BottomDockWidgetArea, m_statisticsPanel);
+    m_statisticsPanel->hide();
+    ui->menuView->addAction(m_statisticsPanel->toggleViewAction());
+
+    // Welch PSD of a selected column, computed on a worker thread
+    m_spectrumPanel = new SpectrumPanel(this);
+    m_spectrumPanel->setObjectName("spectrumPanel");
+    addDockWidget(Qt::RightDockWidgetArea, m_spectrumPanel);
+    m_spectrumPanel->hide();
+    ui->menuView->addAction(m_spectrumPanel->toggleViewAction());
+
+    m_histogramPanel = new HistogramPanel(this);
+    m_histogramPanel->setObjectName("histogramPanel");
+    addDockWidget(Qt::RightDockWidgetArea, m_histogramPanel);
+    m_histogramPanel->hide();
+    ui->menuView->addAction(m_histogramPanel->toggleViewAction());
+
+    // Colour map of many probe columns against X
+    m_waterfallPanel = new WaterfallPanel(this);
+    m_waterfallPanel->setObjectName("waterfallPanel");
+    addDockWidget(Qt::BottomDockWidgetArea, m_waterfallPanel);
+    m_waterfallPanel->hide();
+    ui->menuView->addAction(m_waterfallPanel->toggleViewAction());
+
     // Initialize recent projects
     m_recentProjectsMenu = ui->menuRecentProjects;
     loadRecentProjects();
@@ -150,9 +248,9 @@ MainWindow::MainWindow(QWidget *parent) :
     // File menu: Open/Save/Save As
     connect(ui->actionOpenProject, &QAction::triggered, this, [this]() {
         qDebug() << "actionOpenProject triggered";
-        QString p = QFileDialog::getOpenFileName(this, tr("Open Project or Data"), "", tr("RTPlotter Project (*.rtp);;CSV Files (*.csv);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
+        QString p = QFileDialog::getOpenFileName(this, tr("Open Project or Data"), "", tr("RTPlotter Project (*.rtp);;CSV Files (*.csv *.csv.gz *.csv.zst);;Binary Logs (*.rtlog);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
         if (!p.isEmpty()) {
-            if (p.endsWith(".csv", Qt::CaseInsensitive)) {
+            if (p.endsWith(".csv", Qt::CaseInsensitive) || CompressedFile::detect(p) != CompressedFile::Plain || CSVReader::isBinaryLog(p)) {
                 importCSV(p);
             } else {
                 if (loadProjectFromPath(p)) {
@@ -224,7 +322,42 @@ MainWindow::MainWindow(QWidget *parent) :
     m_dirty = false;
     m_projectLabel = new QLabel(tr("No project"));
     m_dirtyLabel = new QLabel(tr(""));
+    m_monitorLabel = new QLabel();
+    m_monitorLabel->hide();
+    // History load: progress, throughput, ETA and a cancel button
+    m_historyCancelled = false;
+    m_schemaVersion = 0;
+    m_loadStatus = new QWidget();
+    QHBoxLayout* loadLayout = new QHBoxLayout(m_loadStatus);
+    loadLayout->setContentsMargins(0, 0, 0, 0);
+    m_loadRateLabel = new QLabel();
+    m_loadProgress = new QProgressBar();
+    m_loadProgress->setRange(0, 1000);
+    m_loadProgress->setMaximumWidth(160);
+    m_loadProgress->setFormat(tr("History %p%"));
+    QToolButton* loadCancelButton = new QToolButton();
+    loadCancelButton->setText(tr("Cancel"));
+    loadCancelButton->setToolTip(tr("Stop loading the history; the rows already loaded stay plotted"));
+    loadLayout->addWidget(m_loadRateLabel);
+    loadLayout->addWidget(m_loadProgress);
+    loadLayout->addWidget(loadCancelButton);
+    m_loadStatus->hide();
+    connect(m_backfill, &BackfillLoader::progress, this, [this](qint64 loaded, qint64 total) {
+        m_loadProgress->setValue(total > 0 ? int(1000 * loaded / total) : 0);
+        updateLoadStatus();
+        m_loadStatus->show();
+    });
+    connect(m_backfill, &BackfillLoader::finished, m_loadStatus, &QWidget::hide);
+    connect(loadCancelButton, &QToolButton::clicked, this, [this]() {
+        if (!m_backfill->isRunning()) return;
+        m_backfill->stop();
+        // Replotting (setupPlots) must not restart what the user stopped
+        m_historyCancelled = true;
+        if (ui->statusbar) ui->statusbar->showMessage(tr("History loading cancelled: %1 rows loaded").arg(m_reader.getRowCount()), 5000);
+    });
     if (ui->statusbar) {
+        ui->statusbar->addPermanentWidget(m_loadStatus);
+        ui->statusbar->addPermanentWidget(m_monitorLabel);
         ui->statusbar->addPermanentWidget(m_projectLabel);
         ui->statusbar->addPermanentWidget(m_dirtyLabel);
     }
@@ -280,12 +413,72 @@ void MainWindow::on_actionConfigurePlots_triggered()
         setupPlots();
         m_dirty = true;
         updateStatusBar();
-        if (!m_reader.getFilePath().isEmpty()) {
+        // A stream or ring has no file to keep a sidecar next to
+        if (!m_reader.getFilePath().isEmpty() && !m_reader.isStream()) {
+            saveConfigForFile(m_reader.getFilePath());
+        }
+    }
+}
+
+void MainWindow::on_actionDerivedChannels_triggered()
+{
+    // Default the abscissa of derivatives/integrals to the current X axis
+    QString xName;
+    for (const PlotConfig& pc : m_plotConfigs) {
+        if (pc.role == PlotConfig::XAxis) {
+            xName = pc.name;
+            break;
+        }
+    }
+    DerivedChannelDialog dlg(m_reader.getRawHeaders(), m_reader.getDerivedChannels(), xName, this);
+    if (dlg.exec() == QDialog::Accepted) {
+        m_reader.setDerivedChannels(dlg.getChannels());
+        setupPlots();
+        m_dirty = true;
+        updateStatusBar();
+        // A stream or ring has no file to keep a sidecar next to
+        if (!m_reader.getFilePath().isEmpty() && !m_reader.isStream()) {
             saveConfigForFile(m_reader.getFilePath());
         }
     }
 }
 
+void MainWindow::on_actionConvergenceMonitor_triggered()
+{
+    MonitorRuleDialog dlg(m_reader.getHeaders(), m_monitor.rules(), this);
+    if (dlg.exec() == QDialog::Accepted) {
+        m_monitor.setRules(dlg.getRules());
+        m_monitor.bind(m_reader.getHeaders());
+        updateMonitor(0, false);
+        m_dirty = true;
+        updateStatusBar();
+    }
+}
+
+void MainWindow::on_actionCrosshair_toggled(bool checked)
+{
+    m_plotManager.setCrosshairEnabled(checked);
+}
+
+void MainWindow::on_actionLinkXAxes_toggled(bool checked)
+{
+    m_plotManager.setLinkedXAxes(checked);
+    m_dirty = true;
+    updateStatusBar();
+}
+
+void MainWindow::on_actionFollowTail_toggled(bool checked)
+{
+    m_plotManager.setFollowSpan(checked ? m_followSpanSpinBox->value() : 0.0);
+}
+
+void MainWindow::on_actionLatestRunOnly_toggled(bool checked)
+{
+    m_plotManager.setSegmentMode(checked ? PlotManager::LatestSegment : PlotManager::OverlaySegments);
+    m_dirty = true;
+    updateStatusBar();
+}
+
 void MainWindow::on_actionAbout_triggered()
 {
     // Create a rich About dialog that includes the logo
@@ -321,6 +514,44 @@ void MainWindow::updateStatusBar()
     }
 }
 
+void MainWindow::updateLoadStatus()
+{
+    QLocale locale;
+    QString text = tr("%1/s, %2 rows/s")
+        .arg(locale.formattedDataSize(qint64(m_backfill->bytesPerSecond())))
+        .arg(locale.toString(qint64(m_backfill->rowsPerSecond())));
+    double remaining = m_backfill->remainingSeconds();
+    if (remaining >= 0) {
+        int seconds = int(remaining + 0.5);
+        text += tr(", ETA %1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+    }
+    m_loadRateLabel->setText(text);
+}
+
+void MainWindow::updateMonitor(int firstRow, bool notify)
+{
+    QList<int> newlyMet = m_monitor.update(m_reader, firstRow, m_reader.getRowCount());
+    if (notify && !newlyMet.isEmpty()) {
+        for (int rule : newlyMet) {
+            QString text = m_monitor.message(rule);
+            qInfo() << "Convergence monitor:" << text;
+            if (ui->statusbar) ui->statusbar->showMessage(text, 10000);
+        }
+        // Flashes the taskbar entry when the window is in the background
+        QApplication::alert(this);
+    }
+
+    if (!m_monitorLabel) return;
+    m_monitorLabel->setVisible(m_monitor.size() > 0);
+    if (m_monitor.size() == 0) return;
+    m_monitorLabel->setText(tr("Monitor: %1/%2 met").arg(m_monitor.metCount()).arg(m_monitor.size()));
+    QStringList lines;
+    for (int i = 0; i < m_monitor.size(); ++i) {
+        lines.append(QString("%1 %2").arg(m_monitor.isMet(i) ? QStringLiteral("[x]") : QStringLiteral("[ ]"), m_monitor.message(i)));
+    }
+    m_monitorLabel->setToolTip(lines.join('\n'));
+}
+
 void MainWindow::closeEvent(QCloseEvent* event)
 {
     if (m_dirty) {
@@ -350,12 +581,10 @@ void MainWindow::saveConfigForFile(const QString& filePath)
     QFileInfo fi(filePath);
     QString cfgPath = filePath + ".rtplotter.json";
     QJsonObject root;
-    // Parser config
-    QJsonObject parserObj;
-    parserObj["separator"] = QString(m_reader.getSeparator());
-    parserObj["startLine"] = m_reader.getStartLine();
-    parserObj["hasHeader"] = m_reader.getHasHeader();
-    parserObj["ignoreNonNumeric"] = m_reader.getIgnoreNonNumeric();
+    // Parser config, all of it (whitespace and fixed-width columns, comment
+    // prefix); the sidecar names no path so it survives moving the files
+    QJsonObject parserObj = m_reader.toJson();
+    parserObj.remove("filePath");
     root["parser"] = parserObj;
 
     // Plot configs
@@ -371,9 +600,14 @@ void MainWindow::saveConfigForFile(const QString& filePath)
         plotsArray.append(o);
     }
     root["plots"] = plotsArray;
+    root["derivedChannels"] = derivedChannelsToJson(m_reader.getDerivedChannels());
     // Save logarithmic axes settings
     root["logarithmicYAxis"] = m_logarithmicYAxis;
     root["logarithmicXAxis"] = m_logarithmicXAxis;
+    root["linkXAxes"] = m_plotManager.isLinkedXAxes();
+    root["followTail"] = ui->actionFollowTail->isChecked();
+    root["followSpan"] = m_followSpanSpinBox->value();
+    root["latestRunOnly"] = ui->actionLatestRunOnly->isChecked();
 
     QJsonDocument doc(root);
     QFile f(cfgPath);
@@ -398,17 +632,18 @@ bool MainWindow::loadConfigForFile(const QString& filePath)
     QJsonDocument doc = QJsonDocument::fromJson(data, &err);
     if (err.error != QJsonParseError::NoError) return false;
     QJsonObject root = doc.object();
+    if (root.contains("derivedChannels")) {
+        m_reader.setDerivedChannels(derivedChannelsFromJson(root["derivedChannels"].toArray()));
+    }
     if (root.contains("parser")) {
-        QJsonObject p = root["parser"].toObject();
-        if (p.contains("separator")) {
-            QString s = p["separator"].toString();
-            if (!s.isEmpty()) m_reader.setSeparator(s.at(0));
-        }
-        if (p.contains("startLine")) m_reader.setStartLine(p["startLine"].toInt());
-        if (p.contains("hasHeader")) m_reader.setHasHeader(p["hasHeader"].toBool());
-        if (p.contains("ignoreNonNumeric")) m_reader.setIgnoreNonNumeric(p["ignoreNonNumeric"].toBool());
+        // Keys missing from older sidecars keep their current value
+        m_reader.fromJson(root["parser"].toObject());
         m_reader.setFile(filePath);
-        m_reader.parse();
+        m_backfill->cancel();
+        m_stream->close();
+        m_ring->detach();
+        m_historyCancelled = false;
+        m_parseCache.parse(m_reader, kTailFirstBytes);
     }
     if (root.contains("plots")) {
         QJsonArray arr = root["plots"].toArray();
@@ -434,6 +669,18 @@ bool MainWindow::loadConfigForFile(const QString& filePath)
             m_logarithmicXAxis = root["logarithmicXAxis"].toBool();
             qDebug() << "loadConfigForFile: loaded logarithmicXAxis=" << m_logarithmicXAxis;
         }
+        if (root.contains("linkXAxes")) {
+            ui->actionLinkXAxes->setChecked(root["linkXAxes"].toBool());
+        }
+        if (root.contains("followSpan")) {
+            m_followSpanSpinBox->setValue(root["followSpan"].toDouble());
+        }
+        if (root.contains("followTail")) {
+            ui->actionFollowTail->setChecked(root["followTail"].toBool());
+        }
+        if (root.contains("latestRunOnly")) {
+            ui->actionLatestRunOnly->setChecked(root["latestRunOnly"].toBool());
+        }
         setupPlots();
     }
     // (logarithmic axes already handled above before setupPlots)
@@ -445,7 +692,7 @@ void MainWindow::importCSV(const QString& filePath)
     QString filePathLocal = filePath;
     if (filePathLocal.isEmpty()) {
         qDebug() << "importCSV: showing Open CSV dialog";
-        filePathLocal = QFileDialog::getOpenFileName(this, tr("Open CSV File"), "", tr("CSV Files (*.csv);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
+        filePathLocal = QFileDialog::getOpenFileName(this, tr("Open CSV File"), "", tr("CSV Files (*.csv *.csv.gz *.csv.zst);;Binary Logs (*.rtlog);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
     }
     if (filePathLocal.isEmpty()) return;
 
@@ -460,16 +707,31 @@ void MainWindow::importCSV(const QString& filePath)
         }
     }
 
+    // Binary logs name their columns: there is no parser to configure
+    const bool binaryLog = CSVReader::isBinaryLog(filePathLocal);
+
     // Open parser dialog pre-filled with the file path
     ParserConfigDialog dlg(this);
-    dlg.setFilePath(filePathLocal);
-    if (sidecarObj.contains("parser") && sidecarObj["parser"].isObject()) {
-        dlg.applySettings(sidecarObj["parser"].toObject());
+    if (!binaryLog) {
+        dlg.setParseCache(&m_parseCache);
+        dlg.setFilePath(filePathLocal);
+        if (sidecarObj.contains("parser") && sidecarObj["parser"].isObject()) {
+            dlg.applySettings(sidecarObj["parser"].toObject());
+        }
     }
-    if (dlg.exec() == QDialog::Accepted) {
-        CSVReader reader = dlg.getReader();
-        if (reader.parse()) {
+    if (binaryLog || dlg.exec() == QDialog::Accepted) {
+        CSVReader reader;
+        if (binaryLog) reader.setFile(filePathLocal);
+        else reader = dlg.getReader();
+        if (sidecarObj.contains("derivedChannels")) {
+            reader.setDerivedChannels(derivedChannelsFromJson(sidecarObj["derivedChannels"].toArray()));
+        }
+        if (m_parseCache.parse(reader, kTailFirstBytes)) {
             // update reader
+            m_backfill->cancel();
+            m_stream->close();
+            m_ring->detach();
+            m_historyCancelled = false;
             m_reader = reader;
             m_fileWatcher.watchFile(m_reader.getFilePath());
 
@@ -529,6 +791,7 @@ void MainWindow::importCSV(const QString& filePath)
                     parr.append(o);
                 }
                 root["plots"] = parr;
+                root["derivedChannels"] = derivedChannelsToJson(m_reader.getDerivedChannels());
                 root["logarithmicYAxis"] = m_logarithmicYAxis;
                 root["logarithmicXAxis"] = m_logarithmicXAxis;
                 QFile sf(m_reader.getFilePath() + ".rtplotter.json");
@@ -551,7 +814,8 @@ void MainWindow::saveProjectToPath(const QString& path)
     if (!outPath.endsWith(".rtp")) outPath += ".rtp";
 
     QJsonObject root;
-    root["dataFile"] = m_reader.getFilePath();
+    // A stream cannot be read again: the project keeps only its settings
+    root["dataFile"] = m_reader.isStream() ? QString() : m_reader.getFilePath();
     root["parser"] = m_reader.toJson();
     QJsonArray parr;
     for (const PlotConfig &pc : m_plotConfigs) {
@@ -565,9 +829,15 @@ void MainWindow::saveProjectToPath(const QString& path)
         parr.append(o);
     }
     root["plots"] = parr;
+    root["derivedChannels"] = derivedChannelsToJson(m_reader.getDerivedChannels());
+    root["monitorRules"] = monitorRulesToJson(m_monitor.rules());
     root["paused"] = m_paused;
     root["logarithmicYAxis"] = m_logarithmicYAxis;
     root["logarithmicXAxis"] = m_logarithmicXAxis;
+    root["linkXAxes"] = m_plotManager.isLinkedXAxes();
+    root["followTail"] = ui->actionFollowTail->isChecked();
+    root["followSpan"] = m_followSpanSpinBox->value();
+    root["latestRunOnly"] = ui->actionLatestRunOnly->isChecked();
 
     QSaveFile f(outPath);
     if (!f.open(QIODevice::WriteOnly)) {
@@ -588,6 +858,11 @@ void MainWindow::saveProjectToPath(const QString& path)
 bool MainWindow::loadProjectFromPath(const QString& path)
 {
     if (path.isEmpty()) return false;
+    // Switching project stops the previous history load before anything else
+    m_backfill->cancel();
+    m_stream->close();
+    m_ring->detach();
+    m_historyCancelled = false;
     QFile f(path);
     if (!f.open(QIODevice::ReadOnly)) {
         QMessageBox::warning(this, tr("Open Project"), tr("Could not open project file: %1").arg(path));
@@ -606,12 +881,14 @@ bool MainWindow::loadProjectFromPath(const QString& path)
     if (root.contains("parser") && root["parser"].isObject()) {
         m_reader.fromJson(root["parser"].toObject());
     }
+    // Derived channels must be known before parsing so they are computed with the data
+    m_reader.setDerivedChannels(derivedChannelsFromJson(root["derivedChannels"].toArray()));
     // If dataFile present, set and parse
     if (root.contains("dataFile")) {
         QString df = root["dataFile"].toString();
         if (!df.isEmpty()) {
             m_reader.setFile(df);
-            if (!m_reader.parse()) {
+            if (!m_parseCache.parse(m_reader, kTailFirstBytes)) {
                 QMessageBox::warning(this, tr("Open Project"), tr("Failed to parse data file: %1").arg(df));
                 // continue, but plots won't be shown
             }
@@ -635,6 +912,7 @@ bool MainWindow::loadProjectFromPath(const QString& path)
         }
     }
     setPlotConfig(configs);
+    m_monitor.setRules(monitorRulesFromJson(root["monitorRules"].toArray()));
     // Load logarithmic axes state BEFORE creating plots so the setting is applied
     if (root.contains("logarithmicYAxis")) {
         m_logarithmicYAxis = root["logarithmicYAxis"].toBool();
@@ -644,6 +922,12 @@ bool MainWindow::loadProjectFromPath(const QString& path)
         m_logarithmicXAxis = root["logarithmicXAxis"].toBool();
         qDebug() << "loadProjectFromPath: loaded logarithmicXAxis=" << m_logarithmicXAxis;
     }
+    ui->actionLinkXAxes->setChecked(root["linkXAxes"].toBool());
+    if (root.contains("followSpan")) {
+        m_followSpanSpinBox->setValue(root["followSpan"].toDouble());
+    }
+    ui->actionFollowTail->setChecked(root["followTail"].toBool());
+    ui->actionLatestRunOnly->setChecked(root["latestRunOnly"].toBool());
     // Set reader and setup plots (no dialogs)
     setReader(m_reader);
     // paused state
@@ -662,11 +946,178 @@ bool MainWindow::loadProjectFromPath(const QString& path)
 void MainWindow::onFileChanged(const QString& path)
 {
     try {
+        if (m_outOfCoreView->isOpen()) {
+            // Only the blocks appended since the last pass are indexed
+            if (!m_outOfCoreView->extend()) return;
+            if (m_plotManager.isFollowing()) m_plotManager.followTail();
+            else m_plotManager.resetZoomAll();
+            return;
+        }
         m_reader.readNewLines();
-        QVector<QVector<double>> data = m_reader.getData();
+        refreshFromReader(true);
+        // A replaced compressed file or binary log is read again in the background
+        if (m_reader.isHeaderOnly() && !m_backfill->isRunning()) m_backfill->start(&m_reader);
+    } catch (const std::exception& e) {
+        qCritical() << "Exception in onFileChanged():" << e.what();
+    } catch (...) {
+        qCritical() << "Unknown exception in onFileChanged()";
+    }
+}
+
+void MainWindow::clearDataViews()
+{
+    m_outOfCoreView->close();
+    m_plotConfigs.clear();
+    m_streamHead.clear();
+    m_streamConfigured = false;
+    m_statisticsPanel->clear();
+    m_spectrumPanel->setSource(&m_reader, QStringList(), QString(), QString());
+    m_histogramPanel->setSource(&m_reader, QStringList(), QString());
+    m_waterfallPanel->setSource(&m_reader, QStringList(), QString());
+    m_monitor.bind(QStringList());
+    finishPlots(createPlots());
+}
+
+void MainWindow::configureStreamPlots()
+{
+    m_streamConfigured = true;
+    if (ui->statusbar) ui->statusbar->clearMessage();
+    // Rows keep arriving while the dialog is open
+    PlotConfigDialog plotDlg(m_reader.getHeaders(), QList<PlotConfig>(), this);
+    plotDlg.setLogarithmicYAxis(m_logarithmicYAxis);
+    plotDlg.setLogarithmicXAxis(m_logarithmicXAxis);
+    if (plotDlg.exec() == QDialog::Accepted) {
+        setPlotConfig(plotDlg.getPlotConfig());
+        m_logarithmicYAxis = plotDlg.isLogarithmicYAxis();
+        m_logarithmicXAxis = plotDlg.isLogarithmicXAxis();
+        setupPlots();
+    }
+}
+
+bool MainWindow::openStream(const QString& path)
+{
+    m_backfill->cancel();
+    m_fileWatcher.stop();
+    m_ring->detach();
+    if (!m_stream->open(path)) {
+        qCritical() << "Could not read stream" << path << ":" << m_stream->errorString();
+        return false;
+    }
+
+    // Plots are configured once the first lines have arrived
+    m_reader = CSVReader();
+    m_reader.beginStream(m_stream->name());
+    clearDataViews();
+    if (ui->statusbar) {
+        ui->statusbar->showMessage(tr("Waiting for data on %1").arg(m_stream->name()));
+    }
+    return true;
+}
+
+void MainWindow::onStreamReadyRead()
+{
+    // While paused the bytes stay in the stream buffer; once it is full the
+    // producer blocks on its writes
+    if (m_paused || !m_stream->isOpen()) return;
+    try {
+        QByteArray bytes = m_stream->take();
+        const bool atEnd = m_stream->atEnd();
+        if (!m_streamConfigured) {
+            // The dialect is sniffed from the first whole lines, as for a file
+            m_streamHead.append(bytes);
+            if (!atEnd && m_streamHead.count('\n') < kStreamSniffLines && m_streamHead.size() < kStreamSniffBytes) return;
+            const QByteArray sample = atEnd ? m_streamHead : m_streamHead.left(m_streamHead.lastIndexOf('\n') + 1);
+            DialectSniffer::sniff(sample, QByteArray()).applyTo(m_reader);
+            bytes.swap(m_streamHead);
+            m_streamHead.clear();
+            m_reader.appendStream(bytes, atEnd);
+            configureStreamPlots();
+            return;
+        }
+        m_reader.appendStream(bytes, atEnd);
+        refreshFromReader(true);
+        if (atEnd && ui->statusbar) {
+            ui->statusbar->showMessage(tr("End of %1 after %2 rows").arg(m_stream->name()).arg(m_reader.getRowCount()));
+        }
+    } catch (const std::exception& e) {
+        qCritical() << "Exception in onStreamReadyRead():" << e.what();
+    } catch (...) {
+        qCritical() << "Unknown exception in onStreamReadyRead()";
+    }
+}
+
+bool MainWindow::openSharedRing(const QString& name)
+{
+    m_backfill->cancel();
+    m_fileWatcher.stop();
+    m_stream->close();
+    if (!m_ring->attach(name)) {
+        qCritical() << "Could not attach shared-memory ring" << name << ":" << m_ring->errorString();
+        return false;
+    }
+
+    // The ring names its columns: plots are configured right away, once the
+    // event loop runs
+    m_reader = CSVReader();
+    m_reader.beginRecords(m_ring->name(), m_ring->columnNames());
+    clearDataViews();
+    m_streamConfigured = true;
+    QTimer::singleShot(0, this, &MainWindow::configureStreamPlots);
+    return true;
+}
+
+void MainWindow::onRingReadyRead()
+{
+    // While paused the records stay in the ring; once it is full the
+    // producer waits for free slots
+    if (m_paused || !m_ring->isAttached()) return;
+    try {
+        // A range that wraps around the end of the ring takes two copies
+        for (int span = 0; span < 2; ++span) {
+            if (m_ring->consume(m_reader, kRingRecordsPerPoll) == 0) break;
+            refreshFromReader(true);
+        }
+        if (!m_ring->isAttached()) {
+            QMessageBox::warning(this, tr("Shared-memory ring"), tr("Stopped reading %1: %2").arg(m_reader.getFilePath(), m_ring->errorString()));
+        } else if (m_ring->atEnd() && ui->statusbar) {
+            ui->statusbar->showMessage(tr("End of %1 after %2 rows").arg(m_ring->name()).arg(m_reader.getRowCount()));
+        }
+    } catch (const std::exception& e) {
+        qCritical() << "Exception in onRingReadyRead():" << e.what();
+    } catch (...) {
+        qCritical() << "Unknown exception in onRingReadyRead()";
+    }
+}
+
+void MainWindow::refreshFromReader(bool notify)
+{
+    try {
+        // Columns added mid-file: plots, panels and the monitor are bound
+        // again from the configs, which name their columns (no reparse)
+        if (m_reader.getSchemaVersion() != m_schemaVersion) {
+            QStringList added;
+            for (const QString& name : m_reader.getHeaders()) {
+                if (!m_boundHeaders.contains(name)) added.append(name);
+            }
+            if (!added.isEmpty() && ui->statusbar) {
+                ui->statusbar->showMessage(tr("New columns: %1").arg(added.join(", ")), 10000);
+            }
+            setupPlots();
+            return;
+        }
+
+        int appendStart = m_reader.getAppendStart();
+        m_statisticsPanel->appendRows(appendStart);
+        m_spectrumPanel->appendRows(appendStart);
+        m_histogramPanel->appendRows(appendStart);
+        m_waterfallPanel->appendRows(appendStart);
+        if (appendStart == 0) {
+            m_monitor.bind(m_reader.getHeaders());
+        }
+        updateMonitor(appendStart, notify);
         QStringList headers = m_reader.getHeaders();
 
-        if (data.isEmpty() || headers.isEmpty()) {
+        if (m_reader.getRowCount() == 0 || headers.isEmpty()) {
             return;
         }
 
@@ -681,66 +1132,63 @@ void MainWindow::onFileChanged(const QString& path)
             }
         }
 
-        if(x_axis_index == -1 || x_axis_index >= data.first().size()) {
+        if(x_axis_index == -1 || x_axis_index >= m_reader.getColumnCount()) {
             return;
         }
 
-        QVector<double> x_data;
-        for(int i=0; i < data.size(); ++i)
-        {
-            if (x_axis_index < data[i].size()) {
-                x_data.append(data[i][x_axis_index]);
-            }
-        }
-
-        if (x_data.isEmpty()) {
+        // Nothing appended since the last read
+        if (appendStart > 0 && appendStart >= m_reader.getRowCount()) {
             return;
         }
 
+        const QVector<double>& x_data = m_reader.getColumn(x_axis_index);
+
         for (int i = 0; i < m_plotConfigs.size(); ++i)
         {
             if (m_plotConfigs[i].role == PlotConfig::YAxis)
             {
                 // Trouver l'index réel de cette variable
                 int y_axis_index = headers.indexOf(m_plotConfigs[i].name);
-                if (y_axis_index == -1 || y_axis_index >= data.first().size()) {
+                if (y_axis_index == -1 || y_axis_index >= m_reader.getColumnCount()) {
                     continue;
                 }
 
-                QVector<double> y_data;
-                for(int j=0; j < data.size(); ++j)
-                {
-                    if (y_axis_index < data[j].size()) {
-                        y_data.append(data[j][y_axis_index]);
-                    }
-                }
-
-                if (!y_data.isEmpty()) {
-                    m_plotManager.updateCurve(m_plotConfigs[i].graph, m_plotConfigs[i].name, x_data, y_data);
-                    m_plotManager.resetZoom(m_plotConfigs[i].graph);
+                const QVector<double>& y_data = m_reader.getColumn(y_axis_index);
+                // Only a reload rebuilds the curve; appends add the new rows
+                if (appendStart == 0) {
+                    m_plotManager.updateCurve(m_plotConfigs[i].graph, m_plotConfigs[i].name, x_data, y_data, m_reader.getSegmentStarts());
+                } else {
+                    m_plotManager.appendCurve(m_plotConfigs[i].graph, m_plotConfigs[i].name, x_data, y_data, appendStart, m_reader.getSegmentStarts());
                 }
             }
         }
+        if (m_plotManager.isFollowing()) {
+            m_plotManager.followTail();
+        } else {
+            // One rescale per plot, shared between plots when X axes are linked
+            m_plotManager.resetZoomAll();
+        }
     } catch (const std::exception& e) {
-        qCritical() << "Exception in onFileChanged():" << e.what();
+        qCritical() << "Exception in refreshFromReader():" << e.what();
     } catch (...) {
-        qCritical() << "Unknown exception in onFileChanged()";
+        qCritical() << "Unknown exception in refreshFromReader()";
     }
 }
 
 void MainWindow::setupPlots()
 {
     try {
-        QVector<QVector<double>> data = m_reader.getData();
         QStringList headers = m_reader.getHeaders();
+        m_schemaVersion = m_reader.getSchemaVersion();
+        m_boundHeaders = headers;
 
         qDebug() << "setupPlots() called";
-        qDebug() << "Data size:" << data.size();
+        qDebug() << "Row count:" << m_reader.getRowCount();
         qDebug() << "Headers:" << headers;
         qDebug() << "PlotConfigs size:" << m_plotConfigs.size();
 
         // Vérification basique
-        if (data.isEmpty() || headers.isEmpty()) {
+        if (m_reader.getRowCount() == 0 || headers.isEmpty()) {
             qWarning() << "setupPlots(): No data or headers found!";
             return;
         }
@@ -767,53 +1215,24 @@ void MainWindow::setupPlots()
             return;
         }
 
-        if (x_axis_index >= data.first().size()) {
-            qWarning() << "X-Axis index out of bounds:" << x_axis_index << ">=" << data.first().size();
+        if (x_axis_index >= m_reader.getColumnCount()) {
+            qWarning() << "X-Axis index out of bounds:" << x_axis_index << ">=" << m_reader.getColumnCount();
             return;
         }
 
-        QVector<double> x_data;
-        for(int i=0; i < data.size(); ++i)
-        {
-            if (x_axis_index < data[i].size()) {
-                x_data.append(data[i][x_axis_index]);
-            } else {
-                qWarning() << "Row" << i << "has insufficient columns";
-            }
-        }
+        const QVector<double>& x_data = m_reader.getColumn(x_axis_index);
+        // Restarts are detected on the plotted X axis
+        m_reader.setSegmentKey(headers.at(x_axis_index));
 
-        if (x_data.isEmpty()) {
-            qWarning() << "X data is empty!";
-            return;
-        }
-
-        // Clear existing plots/widgets before creating new ones
-        while (ui->splitter->count() > 0) {
-            QWidget* w = ui->splitter->widget(0);
-            if (w) {
-                w->setParent(nullptr);
-                delete w;
-            }
-        }
-        m_plotManager.clearPlots();
+        // The in-memory reader replaces any file viewed out of core
+        m_outOfCoreView->close();
+        QList<int> plotIds = createPlots();
 
-        QMap<int, QCustomPlot*> plots;
         for (int i = 0; i < m_plotConfigs.size(); ++i)
         {
             if (m_plotConfigs[i].role == PlotConfig::YAxis)
             {
                 int graphNum = m_plotConfigs[i].graph;
-                if (!plots.contains(graphNum))
-                {
-                    QCustomPlot* newPlot = new QCustomPlot();
-                    newPlot->setInteraction(QCP::iRangeDrag, true);
-                    newPlot->setInteraction(QCP::iRangeZoom, true);
-                    newPlot->legend->setVisible(true);
-                    ui->splitter->addWidget(newPlot);
-                    m_plotManager.addPlot(graphNum, newPlot);
-                    plots[graphNum] = newPlot;
-                    qDebug() << "Created plot:" << graphNum;
-                }
 
                 // Trouver l'index réel de cette variable dans les données
                 int y_axis_index = headers.indexOf(m_plotConfigs[i].name);
@@ -822,36 +1241,40 @@ void MainWindow::setupPlots()
                     continue;
                 }
 
-                if (y_axis_index >= data.first().size()) {
-                    qWarning() << "Y-Axis index out of bounds:" << y_axis_index << ">=" << data.first().size();
+                if (y_axis_index >= m_reader.getColumnCount()) {
+                    qWarning() << "Y-Axis index out of bounds:" << y_axis_index << ">=" << m_reader.getColumnCount();
                     continue;
                 }
 
-                QVector<double> y_data;
-                for(int j=0; j < data.size(); ++j)
-                {
-                    if (y_axis_index < data[j].size()) {
-                        y_data.append(data[j][y_axis_index]);
-                    } else {
-                        qWarning() << "Row" << j << "has insufficient columns for Y data";
-                    }
-                }
-
-                if (y_data.isEmpty()) {
-                    qWarning() << "Y data is empty for:" << m_plotConfigs[i].name;
-                    continue;
-                }
+                const QVector<double>& y_data = m_reader.getColumn(y_axis_index);
 
                 qDebug() << "Adding curve:" << m_plotConfigs[i].name << "to plot" << graphNum;
-                m_plotManager.addCurve(graphNum, m_plotConfigs[i], x_data, y_data);
+                m_plotManager.addCurve(graphNum, m_plotConfigs[i], x_data, y_data, m_reader.getSegmentStarts());
             }
         }
 
-        // Apply logarithmic axes setting to all plots
-        for (auto it = plots.begin(); it != plots.end(); ++it) {
-            int plotId = it.key();
-            m_plotManager.setLogarithmicYAxis(plotId, m_logarithmicYAxis);
-            m_plotManager.setLogarithmicXAxis(plotId, m_logarithmicXAxis);
+        finishPlots(plotIds);
+
+        // Side panels follow the plotted columns
+        QStringList yColumns;
+        for (const PlotConfig& pc : m_plotConfigs) {
+            if (pc.role == PlotConfig::YAxis && !yColumns.contains(pc.name)) {
+                yColumns.append(pc.name);
+            }
+        }
+        const QString xName = headers.at(x_axis_index);
+        m_statisticsPanel->setColumns(&m_reader, QStringList(yColumns) << xName, xName);
+        m_spectrumPanel->setSource(&m_reader, headers, yColumns.value(0), xName);
+        m_histogramPanel->setSource(&m_reader, headers, yColumns.value(0));
+        m_waterfallPanel->setSource(&m_reader, yColumns, xName);
+
+        // Existing rows only establish the monitor state; notifications are for new data
+        m_monitor.bind(headers);
+        updateMonitor(0, false);
+
+        // A tail-first open shows the latest rows now and loads the history behind them
+        if (!m_reader.isComplete() && !m_backfill->isRunning() && !m_historyCancelled) {
+            m_backfill->start(&m_reader);
         }
 
         qDebug() << "setupPlots() finished";
@@ -862,6 +1285,149 @@ void MainWindow::setupPlots()
     }
 }
 
+QList<int> MainWindow::createPlots()
+{
+    // Clear existing plots/widgets before creating new ones
+    m_plotGrid->clear();
+    while (ui->splitter->count() > 0) {
+        QWidget* w = ui->splitter->widget(0);
+        if (w) {
+            w->setParent(nullptr);
+            delete w;
+        }
+    }
+    m_plotManager.clearPlots();
+
+    QList<int> plotIds;
+    for (const PlotConfig& pc : m_plotConfigs) {
+        if (pc.role == PlotConfig::YAxis && !plotIds.contains(pc.graph)) {
+            plotIds.append(pc.graph);
+        }
+    }
+    // Large dashboards go to the virtualized grid, which only creates
+    // widgets for the tiles in view
+    m_virtualizedPlots = plotIds.size() > kVirtualizedPlotThreshold;
+
+    for (int graphNum : plotIds)
+    {
+        if (m_virtualizedPlots) {
+            m_plotManager.declarePlot(graphNum);
+        } else {
+            QCustomPlot* newPlot = new QCustomPlot();
+            newPlot->setInteraction(QCP::iRangeDrag, true);
+            newPlot->setInteraction(QCP::iRangeZoom, true);
+            newPlot->legend->setVisible(true);
+            ui->splitter->addWidget(newPlot);
+            m_plotManager.addPlot(graphNum, newPlot);
+        }
+        qDebug() << "Created plot:" << graphNum;
+    }
+    return plotIds;
+}
+
+void MainWindow::finishPlots(const QList<int>& plotIds)
+{
+    // Apply logarithmic axes setting to all plots
+    for (int plotId : plotIds) {
+        m_plotManager.setLogarithmicYAxis(plotId, m_logarithmicYAxis);
+        m_plotManager.setLogarithmicXAxis(plotId, m_logarithmicXAxis);
+    }
+
+    if (m_plotManager.isFollowing()) {
+        m_plotManager.followTail();
+    } else if (m_plotManager.isLinkedXAxes()) {
+        m_plotManager.resetZoomAll();
+    }
+
+    ui->splitter->setVisible(!m_virtualizedPlots);
+    m_plotGrid->setVisible(m_virtualizedPlots);
+    if (m_virtualizedPlots) {
+        m_plotGrid->setPlotIds(plotIds);
+    }
+}
+
+void MainWindow::on_actionOpenLargeFile_triggered()
+{
+    openLargeFile();
+}
+
+void MainWindow::openLargeFile(const QString& filePath)
+{
+    QString filePathLocal = filePath;
+    if (filePathLocal.isEmpty()) {
+        filePathLocal = QFileDialog::getOpenFileName(this, tr("Open Large File"), "", tr("CSV Files (*.csv *.csv.gz *.csv.zst);;Binary Logs (*.rtlog);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
+    }
+    if (filePathLocal.isEmpty()) return;
+
+    // The row index seeks to text lines, which compressed data and binary
+    // logs do not have
+    if (CompressedFile::detect(filePathLocal) != CompressedFile::Plain || CSVReader::isBinaryLog(filePathLocal)) {
+        QMessageBox::information(this, tr("Open large file"), tr("%1 cannot be viewed out of core; it is loaded in memory instead.").arg(QFileInfo(filePathLocal).fileName()));
+        importCSV(filePathLocal);
+        return;
+    }
+
+    ParserConfigDialog dlg(this);
+    dlg.setParseCache(&m_parseCache);
+    dlg.setFilePath(filePathLocal);
+    if (dlg.exec() != QDialog::Accepted) return;
+    CSVReader settings = dlg.getReader();
+
+    // One streaming pass; a saved index is reused or extended instead
+    QProgressDialog progress(tr("Indexing %1...").arg(QFileInfo(filePathLocal).fileName()), tr("Cancel"), 0, 1000, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    bool opened = m_outOfCoreView->open(settings, [&progress](qint64 done, qint64 total) {
+        progress.setValue(total > 0 ? int(1000 * done / total) : 0);
+        QApplication::processEvents();
+        return !progress.wasCanceled();
+    });
+    progress.reset();
+    if (!opened) {
+        if (!progress.wasCanceled()) {
+            QMessageBox::warning(this, tr("Open large file"), tr("Could not index %1.").arg(filePathLocal));
+        }
+        return;
+    }
+
+    const SparseRowIndex& index = m_outOfCoreView->index();
+    PlotConfigDialog plotDlg(index.getHeaders(), QList<PlotConfig>(), this);
+    plotDlg.setLogarithmicYAxis(m_logarithmicYAxis);
+    plotDlg.setLogarithmicXAxis(m_logarithmicXAxis);
+    if (plotDlg.exec() != QDialog::Accepted) {
+        m_outOfCoreView->close();
+        return;
+    }
+    setPlotConfig(plotDlg.getPlotConfig());
+    m_logarithmicYAxis = plotDlg.isLogarithmicYAxis();
+    m_logarithmicXAxis = plotDlg.isLogarithmicXAxis();
+
+    // Samples stay on disk: the in-memory reader and the panels fed by it are emptied
+    m_fileWatcher.stop();
+    m_stream->close();
+    m_ring->detach();
+    // Only the parser settings and the path are kept, so that a saved
+    // project names the file
+    m_reader = CSVReader();
+    m_reader.fromJson(settings.toJson());
+    m_statisticsPanel->clear();
+    m_spectrumPanel->setSource(&m_reader, QStringList(), QString(), QString());
+    m_histogramPanel->setSource(&m_reader, QStringList(), QString());
+    m_waterfallPanel->setSource(&m_reader, QStringList(), QString());
+    m_monitor.bind(QStringList());
+    updateMonitor(0, false);
+
+    QList<int> plotIds = createPlots();
+    m_outOfCoreView->setCurves(m_plotConfigs);
+    finishPlots(plotIds);
+    m_fileWatcher.watchFile(index.getFilePath());
+
+    qInfo() << "Opened out of core:" << index.getFilePath() << index.getRowCount() << "rows," << index.getBlockCount() << "blocks";
+    if (ui->statusbar) {
+        ui->statusbar->showMessage(tr("%1 rows indexed, viewed out of core").arg(index.getRowCount()), 5000);
+    }
+}
+
 void MainWindow::on_actionPause_triggered()
 {
     // Toggle pause state
@@ -874,21 +1440,22 @@ void MainWindow::on_actionPause_triggered()
         ui->actionPause->setToolTip(tr("Resume updates"));
     } else {
         // Resume
-        m_fileWatcher.watchFile(m_reader.getFilePath());
         m_paused = false;
         ui->actionPause->setIcon(loadThemeAwareIcon(":/icons/icons/pause.svg"));
         ui->actionPause->setText(tr("Pause"));
         ui->actionPause->setToolTip(tr("Pause updates"));
+        // A stream catches up with the bytes held back while paused; a ring
+        // is polled again on its own
+        if (m_stream->isOpen()) onStreamReadyRead();
+        else if (!m_reader.isStream()) m_fileWatcher.watchFile(m_reader.getFilePath());
     }
 }
 
 void MainWindow::on_actionResetZoom_triggered()
 {
-    for (QCustomPlot* plot : m_plotManager.getPlots())
-    {
-        plot->rescaleAxes();
-        plot->replot();
-    }
+    if (m_outOfCoreView->isOpen()) m_outOfCoreView->showAll();
+    if (m_plotManager.isFollowing()) m_plotManager.followTail();
+    else m_plotManager.resetZoomAll();
 }
 
 void MainWindow::on_actionExport_triggered()
@@ -897,7 +1464,8 @@ void MainWindow::on_actionExport_triggered()
     QString filePath = QFileDialog::getSaveFileName(this, "Export Plot", "", "PNG (*.png);;JPEG (*.jpg);;PDF (*.pdf)", nullptr, QFileDialog::DontUseNativeDialog);
     if (!filePath.isEmpty())
     {
-        QCustomPlot* plot = qobject_cast<QCustomPlot*>(ui->splitter->widget(0));
+        QCustomPlot* plot = m_virtualizedPlots ? m_plotGrid->firstVisiblePlot()
+                                               : qobject_cast<QCustomPlot*>(ui->splitter->widget(0));
         if (plot)
         {
             if (filePath.endsWith(".png"))
@@ -6,6 +6,20 @@
 #include "CSVReader.h"
 #include "FileWatcher.h"
 #include "PlotManager.h"
+#include "ConvergenceMonitor.h"
+#include "ParseCache.h"
+
+class PlotGrid;
+class QDoubleSpinBox;
+class StatisticsPanel;
+class SpectrumPanel;
+class HistogramPanel;
+class WaterfallPanel;
+class OutOfCoreView;
+class BackfillLoader;
+class StreamSource;
+class SharedRingSource;
+class QProgressBar;
 
 namespace Ui {
 class MainWindow;
@@ -23,22 +37,61 @@ public:
     void setReader(const CSVReader& reader);
     bool loadProjectFromPath(const QString& path);
     void addRecentProject(const QString& path);
+    // Plots rows read from standard input ("-") or a named pipe as they arrive
+    bool openStream(const QString& path);
+    // Plots binary records from a solver's shared-memory ring ("/name")
+    bool openSharedRing(const QString& name);
 
 private slots:
     void onFileChanged(const QString& path);
+    void onStreamReadyRead();
+    void onRingReadyRead();
+    void configureStreamPlots();
     void on_actionPause_triggered();
     void on_actionResetZoom_triggered();
     void on_actionExport_triggered();
     void on_actionOpenCSV_triggered();
+    void on_actionOpenLargeFile_triggered();
     void on_actionConfigurePlots_triggered();
+    void on_actionDerivedChannels_triggered();
+    void on_actionConvergenceMonitor_triggered();
+    void on_actionCrosshair_toggled(bool checked);
+    void on_actionLinkXAxes_toggled(bool checked);
+    void on_actionFollowTail_toggled(bool checked);
+    void on_actionLatestRunOnly_toggled(bool checked);
     void on_actionAbout_triggered();
 
 private:
     Ui::MainWindow *ui;
     QList<PlotConfig> m_plotConfigs;
     CSVReader m_reader;
+    // Parse results shared by the parser dialog, imports and project opens
+    ParseCache m_parseCache;
     FileWatcher m_fileWatcher;
     PlotManager m_plotManager;
+    PlotGrid* m_plotGrid;
+    OutOfCoreView* m_outOfCoreView;
+    BackfillLoader* m_backfill;
+    QWidget* m_loadStatus;
+    QProgressBar* m_loadProgress;
+    QLabel* m_loadRateLabel;
+    bool m_historyCancelled;
+    StreamSource* m_stream;
+    // First bytes of the stream, kept until its dialect is known
+    QByteArray m_streamHead;
+    bool m_streamConfigured;
+    SharedRingSource* m_ring;
+    // Reader columns the plots and panels were bound to (setupPlots)
+    int m_schemaVersion;
+    QStringList m_boundHeaders;
+    bool m_virtualizedPlots;
+    StatisticsPanel* m_statisticsPanel;
+    SpectrumPanel* m_spectrumPanel;
+    HistogramPanel* m_histogramPanel;
+    WaterfallPanel* m_waterfallPanel;
+    ConvergenceMonitor m_monitor;
+    QLabel* m_monitorLabel;
+    QDoubleSpinBox* m_followSpanSpinBox;
     bool m_paused;
     QString m_projectPath;
     bool m_dirty;
@@ -51,7 +104,17 @@ private:
 
     void saveProjectToPath(const QString& path);
     void importCSV(const QString& filePath = QString());
+    // Views a file larger than memory through SparseRowIndex
+    void openLargeFile(const QString& filePath = QString());
     void updateStatusBar();
+    // Throughput and ETA of the running history load
+    void updateLoadStatus();
+    void updateMonitor(int firstRow, bool notify);
+    // Pushes the reader's new rows (or a rebuild when getAppendStart() == 0)
+    // to the plots, panels and monitor
+    void refreshFromReader(bool notify);
+    // Empties the plots and panels before a stream or ring fills the reader
+    void clearDataViews();
     void loadRecentProjects();
     void saveRecentProjects();
     void updateRecentProjectsMenu();
@@ -59,6 +122,8 @@ protected:
     void closeEvent(QCloseEvent* event) override;
 
     void setupPlots();
+    QList<int> createPlots();
+    void finishPlots(const QList<int>& plotIds);
     void saveConfigForFile(const QString& filePath);
     bool loadConfigForFile(const QString& filePath);
 };
@@ -0,0 +1,91 @@
+#include "MonitorRuleDialog.h"
+#include "ui_MonitorRuleDialog.h"
+#include <QComboBox>
+#include <QSpinBox>
+
+MonitorRuleDialog::MonitorRuleDialog(const QStringList& columns, const QList<MonitorRule>& rules, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::MonitorRuleDialog),
+    m_columns(columns)
+{
+    ui->setupUi(this);
+    for (const MonitorRule& rule : rules) {
+        addRow(rule);
+    }
+}
+
+MonitorRuleDialog::~MonitorRuleDialog()
+{
+    delete ui;
+}
+
+void MonitorRuleDialog::addRow(const MonitorRule& rule)
+{
+    int row = ui->ruleTableWidget->rowCount();
+    ui->ruleTableWidget->insertRow(row);
+
+    QComboBox* columnComboBox = new QComboBox();
+    columnComboBox->addItems(m_columns);
+    columnComboBox->setCurrentIndex(qMax(0, m_columns.indexOf(rule.column)));
+    ui->ruleTableWidget->setCellWidget(row, 0, columnComboBox);
+
+    QComboBox* kindComboBox = new QComboBox();
+    for (int k = MonitorRule::OrderDrop; k <= MonitorRule::OutsideBand; ++k) {
+        kindComboBox->addItem(MonitorRule::kindName(static_cast<MonitorRule::Kind>(k)));
+    }
+    kindComboBox->setCurrentIndex(static_cast<int>(rule.kind));
+    ui->ruleTableWidget->setCellWidget(row, 1, kindComboBox);
+
+    // Thresholds are plain text so that values like 1e-6 can be typed
+    QTableWidgetItem* thresholdItem = new QTableWidgetItem(QString::number(rule.threshold));
+    thresholdItem->setToolTip(tr("Orders of magnitude, relative change, or |slope| in decades per sample"));
+    ui->ruleTableWidget->setItem(row, 2, thresholdItem);
+
+    QSpinBox* windowSpinBox = new QSpinBox();
+    windowSpinBox->setMinimum(2);
+    windowSpinBox->setMaximum(1000000);
+    windowSpinBox->setValue(rule.window);
+    ui->ruleTableWidget->setCellWidget(row, 3, windowSpinBox);
+
+    ui->ruleTableWidget->setItem(row, 4, new QTableWidgetItem(QString::number(rule.lower)));
+    ui->ruleTableWidget->setItem(row, 5, new QTableWidgetItem(QString::number(rule.upper)));
+}
+
+void MonitorRuleDialog::on_addButton_clicked()
+{
+    MonitorRule rule;
+    rule.column = m_columns.value(0);
+    addRow(rule);
+}
+
+void MonitorRuleDialog::on_removeButton_clicked()
+{
+    int row = ui->ruleTableWidget->currentRow();
+    if (row >= 0) {
+        ui->ruleTableWidget->removeRow(row);
+    }
+}
+
+QList<MonitorRule> MonitorRuleDialog::getRules() const
+{
+    auto number = [this](int row, int column, double fallback) {
+        QTableWidgetItem* item = ui->ruleTableWidget->item(row, column);
+        bool ok = false;
+        double value = item ? item->text().trimmed().toDouble(&ok) : 0.0;
+        return ok ? value : fallback;
+    };
+
+    QList<MonitorRule> rules;
+    for (int i = 0; i < ui->ruleTableWidget->rowCount(); ++i) {
+        MonitorRule rule;
+        rule.column = static_cast<QComboBox*>(ui->ruleTableWidget->cellWidget(i, 0))->currentText();
+        if (rule.column.isEmpty()) continue;
+        rule.kind = static_cast<MonitorRule::Kind>(static_cast<QComboBox*>(ui->ruleTableWidget->cellWidget(i, 1))->currentIndex());
+        rule.threshold = number(i, 2, rule.threshold);
+        rule.window = static_cast<QSpinBox*>(ui->ruleTableWidget->cellWidget(i, 3))->value();
+        rule.lower = number(i, 4, rule.lower);
+        rule.upper = number(i, 5, rule.upper);
+        rules.append(rule);
+    }
+    return rules;
+}
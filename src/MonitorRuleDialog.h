@@ -0,0 +1,33 @@
+#ifndef MONITORRULEDIALOG_H
+#define MONITORRULEDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include "ConvergenceMonitor.h"
+
+namespace Ui {
+class MonitorRuleDialog;
+}
+
+class MonitorRuleDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MonitorRuleDialog(const QStringList& columns, const QList<MonitorRule>& rules, QWidget *parent = nullptr);
+    ~MonitorRuleDialog();
+
+    QList<MonitorRule> getRules() const;
+
+private slots:
+    void on_addButton_clicked();
+    void on_removeButton_clicked();
+
+private:
+    Ui::MonitorRuleDialog *ui;
+    QStringList m_columns;
+
+    void addRow(const MonitorRule& rule);
+};
+
+#endif // MONITORRULEDIALOG_H
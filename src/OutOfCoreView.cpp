@@ -0,0 +1,146 @@
+#include "OutOfCoreView.h"
+#include "PlotManager.h"
+#include <QDebug>
+#include <limits>
+
+namespace {
+    // Visible ranges up to this many rows are drawn at full resolution
+    const qint64 kMaxDecodedRows = 32 * SparseRowIndex::kRowsPerBlock;
+    // Envelope resolution, roughly one bucket per pixel column
+    const int kEnvelopeBuckets = 2048;
+    // Decoding waits until a pan or zoom gesture pauses
+    const int kRefreshDelayMs = 100;
+}
+
+OutOfCoreView::OutOfCoreView(PlotManager* plots, QObject *parent) : QObject(parent),
+    m_plots(plots),
+    m_keyColumn(-1)
+{
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(kRefreshDelayMs);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &OutOfCoreView::refreshPending);
+    connect(m_plots, &PlotManager::xRangeChanged, this, &OutOfCoreView::onXRangeChanged);
+}
+
+bool OutOfCoreView::open(const CSVReader& settings, const std::function<bool(qint64, qint64)>& progress)
+{
+    close();
+    m_index.setParser(settings);
+    // A saved index is extended rather than rebuilt when the file has grown
+    m_index.load();
+    if (!m_index.build(progress)) {
+        m_index.clear();
+        return false;
+    }
+    m_index.save();
+    return isOpen();
+}
+
+void OutOfCoreView::close()
+{
+    m_refreshTimer.stop();
+    m_pending.clear();
+    m_shownBlocks.clear();
+    m_curves.clear();
+    m_keyColumn = -1;
+    m_index.clear();
+}
+
+void OutOfCoreView::setCurves(const QList<PlotConfig>& configs)
+{
+    m_curves.clear();
+    m_shownBlocks.clear();
+    const QStringList headers = m_index.getHeaders();
+    m_keyColumn = -1;
+    for (const PlotConfig& pc : configs) {
+        if (pc.role == PlotConfig::XAxis) m_keyColumn = headers.indexOf(pc.name);
+    }
+    if (m_keyColumn < 0) {
+        qWarning() << "OutOfCoreView: no X-Axis column";
+        return;
+    }
+    if (!m_index.isAscending(m_keyColumn)) {
+        qWarning() << "OutOfCoreView: X column is not ascending, zooming will not refine" << headers.at(m_keyColumn);
+    }
+
+    for (const PlotConfig& pc : configs) {
+        if (pc.role != PlotConfig::YAxis) continue;
+        int column = headers.indexOf(pc.name);
+        if (column < 0) {
+            qWarning() << "Y-Axis variable not found:" << pc.name;
+            continue;
+        }
+        QVector<double> x, y;
+        samples(column, 0, m_index.getBlockCount() - 1, x, y);
+        m_plots->addCurve(pc.graph, pc, x, y);
+        m_curves.append({pc.graph, pc.name, column});
+        m_shownBlocks.insert(pc.graph, qMakePair(0, m_index.getBlockCount() - 1));
+    }
+}
+
+bool OutOfCoreView::extend()
+{
+    if (!isOpen()) return false;
+    qint64 rows = m_index.getRowCount();
+    if (!m_index.build()) return false;
+    m_index.save();
+    if (m_index.getRowCount() == rows) return true;
+
+    // Every plot is refreshed at its current range with the new blocks
+    for (int plotId : m_shownBlocks.keys()) {
+        QCustomPlot* plot = m_plots->plotWidget(plotId);
+        if (plot) refreshPlot(plotId, plot->xAxis->range().lower, plot->xAxis->range().upper, true);
+        else refreshPlot(plotId, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), true);
+    }
+    return true;
+}
+
+void OutOfCoreView::showAll()
+{
+    m_refreshTimer.stop();
+    m_pending.clear();
+    for (int plotId : m_shownBlocks.keys()) {
+        refreshPlot(plotId, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), false);
+    }
+}
+
+void OutOfCoreView::onXRangeChanged(int plotId, const QCPRange& range)
+{
+    if (!m_shownBlocks.contains(plotId)) return;
+    m_pending.insert(plotId, qMakePair(range.lower, range.upper));
+    m_refreshTimer.start();
+}
+
+void OutOfCoreView::refreshPending()
+{
+    QMap<int, QPair<double, double>> pending;
+    pending.swap(m_pending);
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+        refreshPlot(it.key(), it.value().first, it.value().second, false);
+    }
+}
+
+void OutOfCoreView::refreshPlot(int plotId, double lower, double upper, bool force)
+{
+    int first = 0, last = -1;
+    m_index.blocksInRange(m_keyColumn, lower, upper, &first, &last);
+    QPair<int, int> blocks(first, last);
+    if (!force && m_shownBlocks.value(plotId) == blocks) return;
+    m_shownBlocks.insert(plotId, blocks);
+
+    for (const Curve& curve : m_curves) {
+        if (curve.plotId != plotId) continue;
+        QVector<double> x, y;
+        samples(curve.column, first, last, x, y);
+        m_plots->setCurveData(plotId, curve.name, x, y);
+    }
+}
+
+void OutOfCoreView::samples(int column, int first, int last, QVector<double>& x, QVector<double>& y)
+{
+    if (m_index.getBlockRowCount(first, last) <= kMaxDecodedRows) {
+        m_index.rows(m_keyColumn, column, first, last, x, y);
+    } else {
+        m_index.envelope(m_keyColumn, column, first, last, kEnvelopeBuckets, x, y);
+    }
+}
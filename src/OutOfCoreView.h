@@ -0,0 +1,59 @@
+#ifndef OUTOFCOREVIEW_H
+#define OUTOFCOREVIEW_H
+
+#include <QObject>
+#include <QTimer>
+#include <QMap>
+#include <QPair>
+#include "SparseRowIndex.h"
+#include "PlotConfigDialog.h"
+#include "qcustomplot.h"
+
+class PlotManager;
+
+// Drives the plots of a file opened out of core. Curves show the LOD
+// envelope of the index; when the visible X range covers few enough rows,
+// the covering blocks are decoded and drawn at full resolution.
+class OutOfCoreView : public QObject
+{
+    Q_OBJECT
+public:
+    explicit OutOfCoreView(PlotManager* plots, QObject *parent = nullptr);
+
+    // Loads the saved index of the reader's file, or builds it in one pass
+    bool open(const CSVReader& settings, const std::function<bool(qint64, qint64)>& progress = nullptr);
+    void close();
+    bool isOpen() const { return m_index.getBlockCount() > 0; }
+    const SparseRowIndex& index() const { return m_index; }
+
+    // Adds the Y curves of `configs` to their (existing) plots
+    void setCurves(const QList<PlotConfig>& configs);
+    // Indexes rows appended to the file and refreshes the plots
+    bool extend();
+    // Puts every curve back to the whole-file envelope, before a reset zoom
+    void showAll();
+
+private slots:
+    void onXRangeChanged(int plotId, const QCPRange& range);
+    void refreshPending();
+
+private:
+    struct Curve {
+        int plotId;
+        QString name;
+        int column;
+    };
+
+    PlotManager* m_plots;
+    SparseRowIndex m_index;
+    int m_keyColumn;
+    QList<Curve> m_curves;
+    QMap<int, QPair<double, double>> m_pending;
+    QMap<int, QPair<int, int>> m_shownBlocks;
+    QTimer m_refreshTimer;
+
+    void refreshPlot(int plotId, double lower, double upper, bool force);
+    void samples(int column, int first, int last, QVector<double>& x, QVector<double>& y);
+};
+
+#endif // OUTOFCOREVIEW_H
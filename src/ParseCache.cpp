@@ -0,0 +1,171 @@
+#include "ParseCache.h"
+#include "CompressedFile.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+namespace {
+    const int kMaxEntries = 4;
+    // Entries beyond this many cached samples are dropped, oldest first
+    const qint64 kMaxValues = 64LL * 1024 * 1024;
+    const qint64 kSignatureBytes = 64 * 1024;
+    // Enough for the preview and dialect detection of files with wide rows
+    const qint64 kHeadSampleBytes = 256 * 1024;
+    const qint64 kTailSampleBytes = 64 * 1024;
+}
+
+ParseCache::ParseCache()
+{
+}
+
+QString ParseCache::key(const CSVReader& settings) const
+{
+    QJsonObject parser = settings.toJson();
+    parser.remove("filePath");
+    return QFileInfo(settings.getFilePath()).canonicalFilePath() + "\n"
+        + QString::fromUtf8(QJsonDocument(parser).toJson(QJsonDocument::Compact));
+}
+
+QByteArray ParseCache::fileSignature(const QString& filePath, qint64 length) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    return QCryptographicHash::hash(file.read(qMin(length, kSignatureBytes)), QCryptographicHash::Md5);
+}
+
+bool ParseCache::parse(CSVReader& reader, qint64 tailBytes)
+{
+    const QString k = key(reader);
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).key != k) continue;
+        Entry entry = m_entries.takeAt(i);
+        // A shrunk or rewritten file is parsed again; a grown one is caught up
+        if (QFileInfo(reader.getFilePath()).size() < entry.reader.getFileSize()
+            || fileSignature(reader.getFilePath(), entry.reader.getFileSize()) != entry.signature) {
+            break;
+        }
+        QList<DerivedChannel> channels = reader.getDerivedChannels();
+        // Imports parse before the plots set the segment key: the cached
+        // segments are recomputed for the caller's key if it differs
+        const QString segmentKey = reader.getSegmentKey();
+        reader = entry.reader;
+        reader.setDerivedChannels(channels);
+        reader.setSegmentKey(segmentKey);
+        if (!reader.readNewLines()) return false;
+        qDebug() << "Parse cache hit:" << reader.getFilePath() << reader.getRowCount() << "rows";
+        entry.reader = reader;
+        insert(entry);
+        return true;
+    }
+
+    if (!reader.parseTail(tailBytes)) return false;
+    Entry entry;
+    entry.key = k;
+    entry.reader = reader;
+    // The signature only covers bytes that existed at parse time
+    entry.signature = fileSignature(reader.getFilePath(), reader.getFileSize());
+    insert(entry);
+    return true;
+}
+
+void ParseCache::store(const CSVReader& reader)
+{
+    const QString k = key(reader);
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).key == k) {
+            Entry entry = m_entries.takeAt(i);
+            entry.reader = reader;
+            // A header-only entry signed no bytes; a grown file signs more
+            entry.signature = fileSignature(reader.getFilePath(), reader.getFileSize());
+            insert(entry);
+            return;
+        }
+    }
+    Entry entry;
+    entry.key = k;
+    entry.reader = reader;
+    entry.signature = fileSignature(reader.getFilePath(), reader.getFileSize());
+    insert(entry);
+}
+
+void ParseCache::sample(const QString& filePath, QByteArray& head, QByteArray& tail)
+{
+    QFileInfo info(filePath);
+    QString stamp = QString::number(info.size()) + "@" + info.lastModified().toString(Qt::ISODateWithMs);
+    if (filePath != m_samplePath || stamp != m_sampleStamp) {
+        m_samplePath = filePath;
+        m_sampleStamp = stamp;
+        m_head.clear();
+        m_tail.clear();
+        QFile file(filePath);
+        if (CompressedFile::detect(filePath) != CompressedFile::Plain) {
+            // Reaching the end would mean decoding everything: the second
+            // sample follows the head instead
+            CompressedFile source(filePath);
+            if (source.open()) {
+                m_head = source.read(kHeadSampleBytes);
+                m_tail = source.read(kTailSampleBytes);
+            }
+        } else if (file.open(QIODevice::ReadOnly)) {
+            m_head = file.read(kHeadSampleBytes);
+            if (file.size() > m_head.size()) {
+                file.seek(qMax<qint64>(m_head.size(), file.size() - kTailSampleBytes));
+                m_tail = file.read(kTailSampleBytes);
+            }
+        }
+    }
+    head = m_head;
+    tail = m_tail;
+}
+
+QStringList ParseCache::headLines(const QString& filePath, int count)
+{
+    QByteArray head;
+    QByteArray tail;
+    sample(filePath, head, tail);
+    QStringList lines;
+    int begin = 0;
+    while (begin < head.size() && lines.size() < count) {
+        int end = head.indexOf('\n', begin);
+        if (end < 0) {
+            if (!tail.isEmpty()) break; // cut by the sample boundary
+            end = head.size();
+        }
+        int length = end - begin;
+        if (length > 0 && head.at(end - 1) == '\r') --length;
+        lines.append(QString::fromUtf8(head.constData() + begin, length));
+        begin = end + 1;
+    }
+    return lines;
+}
+
+void ParseCache::clear()
+{
+    m_entries.clear();
+    m_samplePath.clear();
+    m_sampleStamp.clear();
+    m_head.clear();
+    m_tail.clear();
+}
+
+void ParseCache::insert(const Entry& entry)
+{
+    // An entry shares its columns with the open reader, whose next append
+    // copies them: one over the budget is not kept at all
+    if (qint64(entry.reader.getRowCount()) * entry.reader.getColumnCount() > kMaxValues) {
+        qDebug() << "Parse cache: not keeping" << entry.reader.getFilePath() << entry.reader.getRowCount() << "rows";
+        return;
+    }
+    m_entries.prepend(entry);
+    qint64 values = 0;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        values += qint64(m_entries.at(i).reader.getRowCount()) * m_entries.at(i).reader.getColumnCount();
+        if (i >= kMaxEntries || values > kMaxValues) {
+            m_entries.erase(m_entries.begin() + i, m_entries.end());
+            break;
+        }
+    }
+}
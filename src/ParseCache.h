@@ -0,0 +1,57 @@
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <QString>
+#include <QDateTime>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include "CSVReader.h"
+
+// Parse results of the session, shared by the parser dialog preview, imports,
+// sidecar restores and project opens. Entries are keyed by the file identity
+// (canonical path plus a hash of its first bytes) and the parser settings, so
+// a file is only parsed again when the settings change or it is replaced.
+// A file that only grew since its entry was made is caught up with
+// readNewLines() instead of being parsed again.
+class ParseCache
+{
+public:
+    ParseCache();
+
+    // Fills `reader` (a tail-first parse of at most `tailBytes`) from the
+    // cache, or parses it and stores the result. The reader's derived
+    // channels and segment key are kept and recomputed on the cached columns.
+    bool parse(CSVReader& reader, qint64 tailBytes);
+    // Replaces or adds the entry of the reader's file and settings, e.g. once
+    // its history has been backfilled. Readers of more than 64M values are
+    // not kept.
+    void store(const CSVReader& reader);
+    // First and last bytes of the file, read once per path, size and
+    // modification time. `tail` is empty when `head` holds the whole file.
+    // Compressed files are sampled decoded, `tail` right after `head`.
+    void sample(const QString& filePath, QByteArray& head, QByteArray& tail);
+    // First `count` complete lines of the head sample
+    QStringList headLines(const QString& filePath, int count);
+    void clear();
+
+private:
+    struct Entry {
+        QString key;
+        QByteArray signature;
+        CSVReader reader;
+    };
+
+    QList<Entry> m_entries; // most recently used first
+    QString m_samplePath;
+    QString m_sampleStamp;
+    QByteArray m_head;
+    QByteArray m_tail;
+
+    QString key(const CSVReader& settings) const;
+    // Hash of the first bytes (at most `length`) of the file
+    QByteArray fileSignature(const QString& filePath, qint64 length) const;
+    void insert(const Entry& entry);
+};
+
+#endif // PARSECACHE_H
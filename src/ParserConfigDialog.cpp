@@ -1,19 +1,26 @@
 #include "ParserConfigDialog.h"
 #include "ui_ParserConfigDialog.h"
+#include "DialectSniffer.h"
+#include "PreviewModel.h"
 #include <QFileDialog>
-#include <QFile>
-#include <QTextStream>
+#include <QJsonArray>
+#include <QRegularExpression>
 
 ParserConfigDialog::ParserConfigDialog(QWidget *parent) :
     QDialog(parent),
-    ui(new Ui::ParserConfigDialog)
+    ui(new Ui::ParserConfigDialog),
+    m_cache(&m_localCache),
+    m_preview(new PreviewModel(this))
 {
     ui->setupUi(this);
+    ui->previewTableView->setModel(m_preview);
 
     connect(ui->customSeparatorLineEdit, &QLineEdit::textChanged, this, &ParserConfigDialog::updatePreview);
     connect(ui->startLineSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ParserConfigDialog::updatePreview);
     connect(ui->headerCheckBox, &QCheckBox::checkStateChanged, this, &ParserConfigDialog::updatePreview);
     connect(ui->ignoreNonNumericCheckBox, &QCheckBox::checkStateChanged, this, &ParserConfigDialog::updatePreview);
+    connect(ui->commentPrefixLineEdit, &QLineEdit::textChanged, this, &ParserConfigDialog::updatePreview);
+    connect(ui->fixedWidthsLineEdit, &QLineEdit::textChanged, this, &ParserConfigDialog::updatePreview);
 }
 
 ParserConfigDialog::~ParserConfigDialog()
@@ -30,9 +37,20 @@ CSVReader ParserConfigDialog::getReader() const
         case 1: separator = ';'; break;
         case 2: separator = '\t'; break;
         case 3: separator = ' '; break;
-        case 4: separator = ui->customSeparatorLineEdit->text().at(0); break;
+        case 4: separator = ui->customSeparatorLineEdit->text().isEmpty() ? QChar(',') : ui->customSeparatorLineEdit->text().at(0); break;
+        case 5: separator = ' '; break;
+        case 6: separator = ' '; break;
     }
     m_reader.setSeparator(separator);
+    m_reader.setWhitespaceSeparated(ui->separatorComboBox->currentIndex() == 5);
+    m_reader.setCommentPrefix(ui->commentPrefixLineEdit->text());
+    QVector<int> widths;
+    if (ui->separatorComboBox->currentIndex() == 6) {
+        for (const QString& width : ui->fixedWidthsLineEdit->text().split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts)) {
+            widths.append(width.toInt());
+        }
+    }
+    m_reader.setFixedWidths(widths);
     m_reader.setStartLine(ui->startLineSpinBox->value());
     m_reader.setHasHeader(ui->headerCheckBox->isChecked());
     m_reader.setIgnoreNonNumeric(ui->ignoreNonNumericCheckBox->isChecked());
@@ -45,6 +63,11 @@ void ParserConfigDialog::setFilePath(const QString& path)
     previewFile(path);
 }
 
+void ParserConfigDialog::setParseCache(ParseCache* cache)
+{
+    m_cache = cache ? cache : &m_localCache;
+}
+
 void ParserConfigDialog::applySettings(const QJsonObject& settings)
 {
     if (settings.contains("filePath")) {
@@ -62,8 +85,16 @@ void ParserConfigDialog::applySettings(const QJsonObject& settings)
             idx = 4;
             ui->customSeparatorLineEdit->setText(sep);
         }
+        if (settings["whitespaceSeparated"].toBool()) idx = 5;
+        QStringList widths;
+        for (const QJsonValue& width : settings["fixedWidths"].toArray()) widths.append(QString::number(width.toInt()));
+        if (!widths.isEmpty()) {
+            idx = 6;
+            ui->fixedWidthsLineEdit->setText(widths.join(", "));
+        }
         ui->separatorComboBox->setCurrentIndex(idx);
     }
+    if (settings.contains("commentPrefix")) ui->commentPrefixLineEdit->setText(settings["commentPrefix"].toString());
     if (settings.contains("startLine")) ui->startLineSpinBox->setValue(settings["startLine"].toInt());
     if (settings.contains("hasHeader")) ui->headerCheckBox->setChecked(settings["hasHeader"].toBool());
     if (settings.contains("ignoreNonNumeric")) ui->ignoreNonNumericCheckBox->setChecked(settings["ignoreNonNumeric"].toBool());
@@ -73,7 +104,7 @@ void ParserConfigDialog::applySettings(const QJsonObject& settings)
 void ParserConfigDialog::on_browseButton_clicked()
 {
     qDebug() << "ParserConfigDialog: browse button clicked";
-    QString filePath = QFileDialog::getOpenFileName(this, tr("Open CSV File"), "", tr("CSV Files (*.csv);;Text Files (*.txt);;Data Files (*.dat);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
+    QString filePath = QFileDialog::getOpenFileName(this, tr("Open CSV File"), "", tr("CSV Files (*.csv *.csv.gz *.csv.zst);;Text Files (*.txt);;Data Files (*.dat);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
     if (!filePath.isEmpty()) {
         ui->filePathLineEdit->setText(filePath);
         previewFile(filePath);
@@ -83,6 +114,7 @@ void ParserConfigDialog::on_browseButton_clicked()
 void ParserConfigDialog::on_separatorComboBox_currentIndexChanged(int index)
 {
     ui->customSeparatorLineEdit->setEnabled(index == 4);
+    ui->fixedWidthsLineEdit->setEnabled(index == 6);
     updatePreview();
 }
 
@@ -91,42 +123,48 @@ void ParserConfigDialog::on_filePathLineEdit_textChanged(const QString &arg1)
     previewFile(arg1);
 }
 
-void ParserConfigDialog::updatePreview()
+void ParserConfigDialog::on_detectButton_clicked()
 {
-    previewFile(ui->filePathLineEdit->text());
+    detectDialect(ui->filePathLineEdit->text());
 }
 
-void ParserConfigDialog::previewFile(const QString& filePath)
+void ParserConfigDialog::detectDialect(const QString& filePath)
 {
-    ui->previewTableWidget->clear();
-    ui->previewTableWidget->setRowCount(0);
-    ui->previewTableWidget->setColumnCount(0);
-
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return;
+    m_detectedPath = filePath;
+    QByteArray head;
+    QByteArray tail;
+    m_cache->sample(filePath, head, tail);
+    if (head.isEmpty()) return;
+    Dialect dialect = DialectSniffer::sniff(head, tail);
+    qDebug() << "ParserConfigDialog: detected separator" << dialect.separator << "whitespace" << dialect.whitespaceSeparated
+             << "comment" << dialect.commentPrefix << "start line" << dialect.startLine << "header" << dialect.hasHeader;
+
+    int idx = QString(",;\t").indexOf(dialect.separator);
+    if (dialect.whitespaceSeparated) idx = 5;
+    else if (idx < 0) {
+        idx = 4;
+        ui->customSeparatorLineEdit->setText(dialect.separator);
     }
+    ui->separatorComboBox->setCurrentIndex(idx);
+    ui->commentPrefixLineEdit->setText(dialect.commentPrefix);
+    ui->startLineSpinBox->setValue(dialect.startLine);
+    ui->headerCheckBox->setChecked(dialect.hasHeader);
+    ui->ignoreNonNumericCheckBox->setChecked(dialect.ignoreNonNumeric);
+}
 
-    QTextStream in(&file);
-    int rowCount = 0;
-
-    QChar separator;
-    if (ui->separatorComboBox->currentIndex() == 4) {
-        separator = ui->customSeparatorLineEdit->text().at(0);
-    } else {
-        separator = QString(",;\t ").at(ui->separatorComboBox->currentIndex());
-    }
+void ParserConfigDialog::updatePreview()
+{
+    previewFile(ui->filePathLineEdit->text());
+}
 
-    while (!in.atEnd() && rowCount < 10) {
-        QString line = in.readLine();
-        ui->previewTableWidget->insertRow(rowCount);
-        QStringList fields = line.split(separator);
-        ui->previewTableWidget->setColumnCount(qMax(ui->previewTableWidget->columnCount(), fields.size()));
-        for (int i = 0; i < fields.size(); ++i) {
-            ui->previewTableWidget->setItem(rowCount, i, new QTableWidgetItem(fields.at(i)));
-        }
-        rowCount++;
+void ParserConfigDialog::previewFile(const QString& filePath)
+{
+    // A newly chosen file gets its dialect detected once; the signals of the
+    // updated widgets come back here with the same path
+    if (filePath != m_detectedPath) {
+        detectDialect(filePath);
     }
 
-    file.close();
+    // The first lines are read once per file; setting changes only re-split them
+    m_preview->setLines(m_cache->headLines(filePath, 10), getReader());
 }
@@ -3,12 +3,15 @@
 
 #include <QDialog>
 #include "CSVReader.h"
+#include "ParseCache.h"
 #include <QJsonObject>
 
 namespace Ui {
 class ParserConfigDialog;
 }
 
+class PreviewModel;
+
 class ParserConfigDialog : public QDialog
 {
     Q_OBJECT
@@ -20,18 +23,27 @@ public:
     CSVReader getReader() const;
     void setFilePath(const QString& path);
     void applySettings(const QJsonObject& settings);
+    // Session cache the preview reads the file through (a private one otherwise)
+    void setParseCache(ParseCache* cache);
 
 private slots:
     void on_browseButton_clicked();
     void on_separatorComboBox_currentIndexChanged(int index);
     void on_filePathLineEdit_textChanged(const QString &arg1);
+    void on_detectButton_clicked();
     void updatePreview();
 
 private:
     Ui::ParserConfigDialog *ui;
     mutable CSVReader m_reader;
+    ParseCache m_localCache;
+    ParseCache* m_cache;
+    QString m_detectedPath;
+    PreviewModel* m_preview;
 
     void previewFile(const QString& filePath);
+    // Sets the parsing options to the dialect sniffed from the file's samples
+    void detectDialect(const QString& filePath);
 };
 
 #endif // PARSERCONFIGDIALOG_H
@@ -1,18 +1,21 @@
 #include "PlotConfigDialog.h"
 #include "ui_PlotConfigDialog.h"
-#include <QComboBox>
-#include <QSpinBox>
-#include <QPushButton>
+#include "PlotConfigModel.h"
+#include <QSortFilterProxyModel>
+#include <QRegularExpression>
 #include <QColorDialog>
+#include <QHeaderView>
+#include <QHash>
+#include <QDebug>
 
 PlotConfigDialog::PlotConfigDialog(const QStringList& variables, const QList<PlotConfig>& initialConfigs, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::PlotConfigDialog),
-    m_variables(variables),
-    m_initialConfigs(initialConfigs)
+    m_model(nullptr),
+    m_filter(new QSortFilterProxyModel(this))
 {
     ui->setupUi(this);
-    setupTable();
+    setupTable(variables, initialConfigs);
 }
 
 PlotConfigDialog::~PlotConfigDialog()
@@ -20,99 +23,99 @@ PlotConfigDialog::~PlotConfigDialog()
     delete ui;
 }
 
-void PlotConfigDialog::setupTable()
+void PlotConfigDialog::setupTable(const QStringList& variables, const QList<PlotConfig>& initialConfigs)
 {
-    ui->plotConfigTableWidget->setRowCount(m_variables.size());
     // Palette of default colors to assign per variable (cycled)
     QVector<QColor> defaultColors = {Qt::red, Qt::green, Qt::blue, Qt::magenta, Qt::cyan, Qt::yellow, Qt::darkRed, Qt::darkGreen, Qt::darkBlue};
-    for (int i = 0; i < m_variables.size(); ++i) {
-        ui->plotConfigTableWidget->setItem(i, 0, new QTableWidgetItem(m_variables.at(i)));
+    // Initial configs are matched by name
+    QHash<QString, int> initialByName;
+    initialByName.reserve(initialConfigs.size());
+    for (int i = 0; i < initialConfigs.size(); ++i) initialByName.insert(initialConfigs.at(i).name, i);
 
-        QComboBox* roleComboBox = new QComboBox();
-        roleComboBox->addItems({"None", "X-Axis", "Y-Axis"});
-        ui->plotConfigTableWidget->setCellWidget(i, 1, roleComboBox);
+    QList<PlotConfig> configs;
+    configs.reserve(variables.size());
+    for (int i = 0; i < variables.size(); ++i) {
+        PlotConfig config;
+        config.name = variables.at(i);
+        config.role = PlotConfig::None;
+        config.graph = 0;
+        config.style = PlotConfig::Line;
+        config.thickness = 1;
+        config.color = defaultColors[i % defaultColors.size()];
+        auto initial = initialByName.constFind(config.name);
+        if (initial != initialByName.constEnd()) {
+            const PlotConfig& pc = initialConfigs.at(initial.value());
+            config.role = pc.role;
+            config.graph = pc.graph;
+            config.style = pc.style;
+            config.thickness = pc.thickness;
+            if (pc.color.isValid()) config.color = pc.color;
+        }
+        configs.append(config);
+    }
 
-        QSpinBox* graphSpinBox = new QSpinBox();
-        graphSpinBox->setMinimum(0);
-        ui->plotConfigTableWidget->setCellWidget(i, 2, graphSpinBox);
+    m_model = new PlotConfigModel(configs, this);
+    m_filter->setSourceModel(m_model);
+    m_filter->setFilterKeyColumn(PlotConfigModel::NameColumn);
+    ui->plotConfigTableView->setModel(m_filter);
+    ui->plotConfigTableView->setItemDelegate(new PlotConfigDelegate(this));
+    // Fixed row heights and no content-based column sizing: the view never
+    // has to look at rows that are not on screen
+    ui->plotConfigTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->plotConfigTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    ui->plotConfigTableView->setColumnWidth(PlotConfigModel::NameColumn, 180);
 
-        QComboBox* styleComboBox = new QComboBox();
-        styleComboBox->addItems({"Line", "Points", "Line+Points"});
-        ui->plotConfigTableWidget->setCellWidget(i, 3, styleComboBox);
+    ui->bulkRoleComboBox->addItem(tr("Role: keep"));
+    ui->bulkRoleComboBox->addItems(PlotConfigModel::roleNames());
+    ui->bulkStyleComboBox->addItem(tr("Style: keep"));
+    ui->bulkStyleComboBox->addItems(PlotConfigModel::styleNames());
+}
 
-        QSpinBox* thicknessSpinBox = new QSpinBox();
-        thicknessSpinBox->setMinimum(1);
-        thicknessSpinBox->setMaximum(10);
-        ui->plotConfigTableWidget->setCellWidget(i, 4, thicknessSpinBox);
+void PlotConfigDialog::on_filterLineEdit_textChanged(const QString& pattern)
+{
+    // Plain text matches anywhere in the name; * and ? are wildcards
+    m_filter->setFilterRegularExpression(QRegularExpression(
+        QRegularExpression::wildcardToRegularExpression(pattern, QRegularExpression::UnanchoredWildcardConversion),
+        QRegularExpression::CaseInsensitiveOption));
+}
 
-        QPushButton* colorButton = new QPushButton("Choose Color");
-        colorButton->setProperty("row", i);  // Store the row number for reference
-        QColor def = defaultColors[i % defaultColors.size()];
-        // Default color first
-        m_colors[i] = def;
-        // If initial configs supplied, use those values (match by name)
-        if (!m_initialConfigs.isEmpty()) {
-            for (const PlotConfig &pc : m_initialConfigs) {
-                if (pc.name == m_variables.at(i)) {
-                    roleComboBox->setCurrentIndex(static_cast<int>(pc.role));
-                    graphSpinBox->setValue(pc.graph);
-                    styleComboBox->setCurrentIndex(static_cast<int>(pc.style));
-                    thicknessSpinBox->setValue(pc.thickness);
-                    if (pc.color.isValid()) m_colors[i] = pc.color;
-                    break;
-                }
-            }
-        }
-        updateColorButtonDisplay(i, m_colors[i]);
-        connect(colorButton, &QPushButton::clicked, this, &PlotConfigDialog::onColorButtonClicked);
-        ui->plotConfigTableWidget->setCellWidget(i, 5, colorButton);
+QList<int> PlotConfigDialog::targetRows() const
+{
+    QList<int> rows;
+    const QModelIndexList selected = ui->plotConfigTableView->selectionModel()->selectedRows();
+    if (!selected.isEmpty()) {
+        for (const QModelIndex& index : selected) rows.append(m_filter->mapToSource(index).row());
+    } else {
+        for (int row = 0; row < m_filter->rowCount(); ++row) rows.append(m_filter->mapToSource(m_filter->index(row, 0)).row());
     }
+    return rows;
 }
 
-void PlotConfigDialog::updateColorButtonDisplay(int row, const QColor& color)
+void PlotConfigDialog::on_applyButton_clicked()
 {
-    QPushButton* button = qobject_cast<QPushButton*>(ui->plotConfigTableWidget->cellWidget(row, 5));
-    if (button) {
-        // Create a small colored pixmap to use as an icon so the color is visible on all styles
-        QPixmap pix(16,16);
-        pix.fill(color);
-        button->setIcon(QIcon(pix));
-        button->setIconSize(QSize(16,16));
-        // Keep a short tooltip with the hex color
-        button->setToolTip(color.name());
-        // Set minimal stylesheet so text doesn't obscure icon
-        button->setStyleSheet("padding:2px;");
-    }
+    const QList<int> rows = targetRows();
+    qDebug() << "PlotConfigDialog: applying bulk settings to" << rows.size() << "variables";
+    // Index 0 of the combo boxes and the minimum of the spin boxes mean "keep"
+    if (ui->bulkRoleComboBox->currentIndex() > 0) m_model->assign(rows, PlotConfigModel::RoleColumn, ui->bulkRoleComboBox->currentIndex() - 1);
+    if (ui->bulkGraphSpinBox->value() >= 0) m_model->assign(rows, PlotConfigModel::GraphColumn, ui->bulkGraphSpinBox->value());
+    if (ui->bulkStyleComboBox->currentIndex() > 0) m_model->assign(rows, PlotConfigModel::StyleColumn, ui->bulkStyleComboBox->currentIndex() - 1);
+    if (ui->bulkThicknessSpinBox->value() > 0) m_model->assign(rows, PlotConfigModel::ThicknessColumn, ui->bulkThicknessSpinBox->value());
 }
 
-QList<PlotConfig> PlotConfigDialog::getPlotConfig() const
+void PlotConfigDialog::on_plotConfigTableView_doubleClicked(const QModelIndex& index)
 {
-    QList<PlotConfig> configs;
-    for (int i = 0; i < m_variables.size(); ++i) {
-        PlotConfig config;
-        config.name = m_variables.at(i);
-        config.role = static_cast<PlotConfig::Role>(static_cast<QComboBox*>(ui->plotConfigTableWidget->cellWidget(i, 1))->currentIndex());
-        config.graph = static_cast<QSpinBox*>(ui->plotConfigTableWidget->cellWidget(i, 2))->value();
-        config.style = static_cast<PlotConfig::Style>(static_cast<QComboBox*>(ui->plotConfigTableWidget->cellWidget(i, 3))->currentIndex());
-        config.thickness = static_cast<QSpinBox*>(ui->plotConfigTableWidget->cellWidget(i, 4))->value();
-        config.color = m_colors.value(i, Qt::blue);  // Récupérer la couleur stockée
-        configs.append(config);
+    if (index.column() != PlotConfigModel::ColorColumn) return;
+    QModelIndex source = m_filter->mapToSource(index);
+    QColor initialColor = source.data(Qt::EditRole).value<QColor>();
+    QColor color = QColorDialog::getColor(initialColor, this, "Choisir une couleur");
+    if (color.isValid()) {
+        m_model->setData(source, color);
     }
-    return configs;
 }
 
-void PlotConfigDialog::onColorButtonClicked()
+QList<PlotConfig> PlotConfigDialog::getPlotConfig() const
 {
-    QPushButton* button = qobject_cast<QPushButton*>(sender());
-    if (button) {
-        int row = button->property("row").toInt();
-        QColor initialColor = m_colors.value(row, Qt::blue);
-        QColor color = QColorDialog::getColor(initialColor, this, "Choisir une couleur");
-        if (color.isValid()) {
-            m_colors[row] = color;  // Stocker la couleur sélectionnée
-            updateColorButtonDisplay(row, color);
-        }
-    }
+    return m_model->getConfigs();
 }
 
 bool PlotConfigDialog::isLogarithmicYAxis() const
@@ -4,11 +4,15 @@
 #include <QDialog>
 #include <QStringList>
 #include <QColor>
+#include <QModelIndex>
 
 namespace Ui {
 class PlotConfigDialog;
 }
 
+class PlotConfigModel;
+class QSortFilterProxyModel;
+
 struct PlotConfig {
     QString name;
     enum Role { None, XAxis, YAxis };
@@ -37,16 +41,18 @@ public:
     void setLogarithmicXAxis(bool value);
 
 private slots:
-    void onColorButtonClicked();
+    void on_filterLineEdit_textChanged(const QString& pattern);
+    void on_applyButton_clicked();
+    void on_plotConfigTableView_doubleClicked(const QModelIndex& index);
 
 private:
     Ui::PlotConfigDialog *ui;
-    QStringList m_variables;
-    QMap<int, QColor> m_colors;
-    QList<PlotConfig> m_initialConfigs;
+    PlotConfigModel* m_model;
+    QSortFilterProxyModel* m_filter;
 
-    void setupTable();
-    void updateColorButtonDisplay(int row, const QColor& color);
+    void setupTable(const QStringList& variables, const QList<PlotConfig>& initialConfigs);
+    // Model rows the bulk settings apply to: the selected rows, else every row the filter shows
+    QList<int> targetRows() const;
 };
 
 #endif // PLOTCONFIGDIALOG_H
@@ -0,0 +1,162 @@
+#include "PlotConfigModel.h"
+#include <QComboBox>
+#include <QSpinBox>
+#include <algorithm>
+
+PlotConfigModel::PlotConfigModel(const QList<PlotConfig>& configs, QObject* parent) :
+    QAbstractTableModel(parent),
+    m_configs(configs)
+{
+}
+
+QStringList PlotConfigModel::roleNames()
+{
+    return {"None", "X-Axis", "Y-Axis"};
+}
+
+QStringList PlotConfigModel::styleNames()
+{
+    return {"Line", "Points", "Line+Points"};
+}
+
+int PlotConfigModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_configs.size();
+}
+
+int PlotConfigModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant PlotConfigModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_configs.size()) return QVariant();
+    const PlotConfig& config = m_configs.at(index.row());
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case NameColumn: return config.name;
+        case RoleColumn: return roleNames().value(config.role);
+        case GraphColumn: return config.graph;
+        case StyleColumn: return styleNames().value(config.style);
+        case ThicknessColumn: return config.thickness;
+        case ColorColumn: return config.color.name();
+        }
+    } else if (role == Qt::EditRole) {
+        switch (index.column()) {
+        case NameColumn: return config.name;
+        case RoleColumn: return int(config.role);
+        case GraphColumn: return config.graph;
+        case StyleColumn: return int(config.style);
+        case ThicknessColumn: return config.thickness;
+        case ColorColumn: return config.color;
+        }
+    } else if (role == Qt::DecorationRole && index.column() == ColorColumn) {
+        return config.color;
+    } else if (role == Qt::ToolTipRole && index.column() == ColorColumn) {
+        return tr("Double-click to choose a color");
+    }
+    return QVariant();
+}
+
+void PlotConfigModel::setField(PlotConfig& config, int column, const QVariant& value)
+{
+    switch (column) {
+    case RoleColumn: config.role = static_cast<PlotConfig::Role>(qBound(0, value.toInt(), 2)); break;
+    case GraphColumn: config.graph = qMax(0, value.toInt()); break;
+    case StyleColumn: config.style = static_cast<PlotConfig::Style>(qBound(0, value.toInt(), 2)); break;
+    case ThicknessColumn: config.thickness = qBound(1, value.toInt(), 10); break;
+    case ColorColumn: config.color = value.value<QColor>(); break;
+    }
+}
+
+bool PlotConfigModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!index.isValid() || role != Qt::EditRole || index.column() == NameColumn) return false;
+    setField(m_configs[index.row()], index.column(), value);
+    emit dataChanged(index, index);
+    return true;
+}
+
+void PlotConfigModel::assign(const QList<int>& rows, int column, const QVariant& value)
+{
+    if (rows.isEmpty() || column == NameColumn) return;
+    for (int row : rows) setField(m_configs[row], column, value);
+    const auto range = std::minmax_element(rows.begin(), rows.end());
+    emit dataChanged(index(*range.first, column), index(*range.second, column));
+}
+
+Qt::ItemFlags PlotConfigModel::flags(const QModelIndex& index) const
+{
+    Qt::ItemFlags flags = QAbstractTableModel::flags(index);
+    if (index.isValid() && index.column() != NameColumn && index.column() != ColorColumn) flags |= Qt::ItemIsEditable;
+    return flags;
+}
+
+QVariant PlotConfigModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QAbstractTableModel::headerData(section, orientation, role);
+    switch (section) {
+    case NameColumn: return tr("Variable");
+    case RoleColumn: return tr("Role");
+    case GraphColumn: return tr("Graph");
+    case StyleColumn: return tr("Style");
+    case ThicknessColumn: return tr("Thickness");
+    case ColorColumn: return tr("Color");
+    }
+    return QVariant();
+}
+
+QWidget* PlotConfigDelegate::createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    switch (index.column()) {
+    case PlotConfigModel::RoleColumn:
+    case PlotConfigModel::StyleColumn: {
+        QComboBox* comboBox = new QComboBox(parent);
+        comboBox->addItems(index.column() == PlotConfigModel::RoleColumn ? PlotConfigModel::roleNames() : PlotConfigModel::styleNames());
+        // Commit as soon as an entry is picked rather than on focus loss
+        connect(comboBox, QOverload<int>::of(&QComboBox::activated), this, [this, comboBox]() {
+            PlotConfigDelegate* self = const_cast<PlotConfigDelegate*>(this);
+            emit self->commitData(comboBox);
+            emit self->closeEditor(comboBox);
+        });
+        return comboBox;
+    }
+    case PlotConfigModel::GraphColumn: {
+        QSpinBox* spinBox = new QSpinBox(parent);
+        spinBox->setMinimum(0);
+        return spinBox;
+    }
+    case PlotConfigModel::ThicknessColumn: {
+        QSpinBox* spinBox = new QSpinBox(parent);
+        spinBox->setRange(1, 10);
+        return spinBox;
+    }
+    }
+    return QStyledItemDelegate::createEditor(parent, option, index);
+}
+
+void PlotConfigDelegate::setEditorData(QWidget* editor, const QModelIndex& index) const
+{
+    const int value = index.data(Qt::EditRole).toInt();
+    if (QComboBox* comboBox = qobject_cast<QComboBox*>(editor)) {
+        comboBox->setCurrentIndex(value);
+    } else if (QSpinBox* spinBox = qobject_cast<QSpinBox*>(editor)) {
+        spinBox->setValue(value);
+    } else {
+        QStyledItemDelegate::setEditorData(editor, index);
+    }
+}
+
+void PlotConfigDelegate::setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const
+{
+    if (QComboBox* comboBox = qobject_cast<QComboBox*>(editor)) {
+        model->setData(index, comboBox->currentIndex());
+    } else if (QSpinBox* spinBox = qobject_cast<QSpinBox*>(editor)) {
+        spinBox->interpretText();
+        model->setData(index, spinBox->value());
+    } else {
+        QStyledItemDelegate::setModelData(editor, model, index);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef PLOTCONFIGMODEL_H
+#define PLOTCONFIGMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
+#include <QList>
+#include "PlotConfigDialog.h"
+
+// One row per variable of the plot configuration dialog. The view only asks
+// for the visible cells, and editors are created by PlotConfigDelegate for
+// the cell being edited, so wide files (thousands of columns) open at once.
+class PlotConfigModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn, RoleColumn, GraphColumn, StyleColumn, ThicknessColumn, ColorColumn, ColumnCount };
+
+    explicit PlotConfigModel(const QList<PlotConfig>& configs, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    const QList<PlotConfig>& getConfigs() const { return m_configs; }
+    // Sets one column of many rows with a single change notification
+    void assign(const QList<int>& rows, int column, const QVariant& value);
+
+    static QStringList roleNames();
+    static QStringList styleNames();
+
+private:
+    QList<PlotConfig> m_configs;
+
+    void setField(PlotConfig& config, int column, const QVariant& value);
+};
+
+// Combo and spin box editors for the role, graph, style and thickness cells.
+// Colors are picked with a color dialog by the owning dialog.
+class PlotConfigDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    void setEditorData(QWidget* editor, const QModelIndex& index) const override;
+    void setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const override;
+};
+
+#endif // PLOTCONFIGMODEL_H
@@ -0,0 +1,136 @@
+#include "PlotGrid.h"
+#include "PlotManager.h"
+#include "qcustomplot.h"
+#include <QScrollBar>
+#include <QResizeEvent>
+
+// Extra rows created above and below the viewport so that slow scrolling
+// does not expose empty tiles
+static const int kOverscanRows = 1;
+
+PlotGrid::PlotGrid(PlotManager* manager, QWidget *parent) :
+    QScrollArea(parent),
+    m_manager(manager),
+    m_canvas(new QWidget()),
+    m_tileHeight(220),
+    m_minTileWidth(360)
+{
+    setWidgetResizable(false);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setWidget(m_canvas);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &PlotGrid::updateVisibleTiles);
+}
+
+void PlotGrid::setPlotIds(const QList<int>& plotIds)
+{
+    clear();
+    m_plotIds = plotIds;
+    verticalScrollBar()->setValue(0);
+    updateVisibleTiles();
+}
+
+void PlotGrid::clear()
+{
+    const QList<int> indices = m_visibleTiles.keys();
+    for (int index : indices) {
+        releaseTile(index);
+    }
+    qDeleteAll(m_pool);
+    m_pool.clear();
+    m_plotIds.clear();
+    m_canvas->resize(0, 0);
+}
+
+QCustomPlot* PlotGrid::firstVisiblePlot() const
+{
+    return m_visibleTiles.isEmpty() ? nullptr : m_visibleTiles.first();
+}
+
+void PlotGrid::setTileHeight(int height)
+{
+    m_tileHeight = qMax(80, height);
+    updateVisibleTiles();
+}
+
+void PlotGrid::setMinimumTileWidth(int width)
+{
+    m_minTileWidth = qMax(80, width);
+    updateVisibleTiles();
+}
+
+void PlotGrid::resizeEvent(QResizeEvent* event)
+{
+    QScrollArea::resizeEvent(event);
+    updateVisibleTiles();
+}
+
+int PlotGrid::columnCount() const
+{
+    return qMax(1, viewport()->width() / m_minTileWidth);
+}
+
+QRect PlotGrid::tileRect(int index, int columns) const
+{
+    int tileWidth = viewport()->width() / columns;
+    int row = index / columns;
+    int column = index % columns;
+    return QRect(column * tileWidth, row * m_tileHeight, tileWidth, m_tileHeight);
+}
+
+QCustomPlot* PlotGrid::acquirePlot()
+{
+    if (!m_pool.isEmpty()) {
+        return m_pool.takeLast();
+    }
+    QCustomPlot* plot = new QCustomPlot(m_canvas);
+    plot->setInteraction(QCP::iRangeDrag, true);
+    plot->setInteraction(QCP::iRangeZoom, true);
+    plot->legend->setVisible(true);
+    return plot;
+}
+
+void PlotGrid::releaseTile(int index)
+{
+    QCustomPlot* plot = m_visibleTiles.take(index);
+    if (!plot) return;
+    if (index < m_plotIds.size()) {
+        m_manager->detachPlot(m_plotIds.at(index));
+    }
+    plot->hide();
+    m_pool.append(plot);
+}
+
+void PlotGrid::updateVisibleTiles()
+{
+    int count = m_plotIds.size();
+    int columns = columnCount();
+    int rows = (count + columns - 1) / columns;
+    m_canvas->resize(viewport()->width(), rows * m_tileHeight);
+
+    if (count == 0) return;
+
+    int top = verticalScrollBar()->value();
+    int firstRow = qMax(0, top / m_tileHeight - kOverscanRows);
+    int lastRow = qMin(rows - 1, (top + viewport()->height()) / m_tileHeight + kOverscanRows);
+    int first = firstRow * columns;
+    int last = qMin(count - 1, (lastRow + 1) * columns - 1);
+
+    // Recycle the widgets of tiles that left the visible range
+    const QList<int> indices = m_visibleTiles.keys();
+    for (int index : indices) {
+        if (index < first || index > last) {
+            releaseTile(index);
+        }
+    }
+
+    for (int index = first; index <= last; ++index) {
+        QCustomPlot* plot = m_visibleTiles.value(index, nullptr);
+        if (!plot) {
+            plot = acquirePlot();
+            m_visibleTiles.insert(index, plot);
+            m_manager->attachPlot(m_plotIds.at(index), plot);
+        }
+        plot->setGeometry(tileRect(index, columns));
+        plot->show();
+    }
+}
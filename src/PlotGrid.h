@@ -0,0 +1,49 @@
+#ifndef PLOTGRID_H
+#define PLOTGRID_H
+
+#include <QScrollArea>
+#include <QMap>
+#include <QList>
+
+class QCustomPlot;
+class PlotManager;
+
+// Scrollable grid of plot tiles for dashboards with many graphs. Only the
+// tiles intersecting the viewport own a QCustomPlot; widgets scrolled out of
+// view are detached from the PlotManager and recycled for the next tiles.
+class PlotGrid : public QScrollArea
+{
+    Q_OBJECT
+public:
+    explicit PlotGrid(PlotManager* manager, QWidget *parent = nullptr);
+
+    void setPlotIds(const QList<int>& plotIds);
+    void clear();
+    int plotCount() const { return m_plotIds.size(); }
+    QCustomPlot* firstVisiblePlot() const;
+
+    void setTileHeight(int height);
+    void setMinimumTileWidth(int width);
+
+protected:
+    void resizeEvent(QResizeEvent* event) override;
+
+private slots:
+    void updateVisibleTiles();
+
+private:
+    PlotManager* m_manager;
+    QWidget* m_canvas;
+    QList<int> m_plotIds;
+    QMap<int, QCustomPlot*> m_visibleTiles;   // tile index -> widget
+    QList<QCustomPlot*> m_pool;
+    int m_tileHeight;
+    int m_minTileWidth;
+
+    int columnCount() const;
+    QRect tileRect(int index, int columns) const;
+    QCustomPlot* acquirePlot();
+    void releaseTile(int index);
+};
+
+#endif // PLOTGRID_H
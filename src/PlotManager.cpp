@@ -1,18 +1,238 @@
 #include "PlotManager.h"
 #include <QDebug>
 #include <stdexcept>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
-PlotManager::PlotManager(QObject *parent) : QObject(parent)
+// Beyond this many runs a curve is drawn as a single one: each run is a graph
+static const int kMaxSegments = 32;
+
+// Converts rows [first, last) to graph points. Missing values are NaN:
+// a NaN value is kept and QCustomPlot draws it as a gap in the line and
+// leaves it out of the value range, while a row without a key cannot be
+// placed and is dropped. The output index only advances on a valid key, so
+// the loop has no branch.
+static QVector<QCPGraphData> toPoints(const QVector<double>& x, const QVector<double>& y, int first, int last)
+{
+    QVector<QCPGraphData> points(qMax(0, last - first));
+    int count = 0;
+    for (int i = first; i < last; ++i) {
+        points[count].key = x[i];
+        points[count].value = y[i];
+        count += x[i] == x[i];
+    }
+    points.resize(count);
+    return points;
+}
+
+static bool isSorted(const QVector<QCPGraphData>& points)
+{
+    return std::is_sorted(points.constBegin(), points.constEnd(), [](const QCPGraphData& a, const QCPGraphData& b) {
+        return a.key < b.key;
+    });
+}
+
+// Fill a graph data container from rows [first, last) of parallel
+// key/value vectors. Runs from CSVReader are usually ascending, which a
+// linear check confirms so that the container skips its sort.
+static void fillContainer(QCPGraphDataContainer* container, const QVector<double>& x, const QVector<double>& y, int first, int last)
+{
+    QVector<QCPGraphData> points = toPoints(x, y, first, last);
+    container->set(points, isSorted(points));
+}
+
+// Adds rows [first, last); the container only merges when they do not
+// follow its last key. Returns whether the points went after the existing
+// ones, so that indices into the container are still valid.
+static bool appendContainer(QCPGraphDataContainer* container, const QVector<double>& x, const QVector<double>& y, int first, int last)
+{
+    QVector<QCPGraphData> points = toPoints(x, y, first, last);
+    const bool sorted = isSorted(points);
+    const bool atTail = sorted && (points.isEmpty() || container->isEmpty() || points.constFirst().key >= (container->constEnd() - 1)->key);
+    container->add(points, sorted);
+    return atTail;
+}
+
+static void fillContainer(QCPGraphDataContainer* container, const QVector<double>& x, const QVector<double>& y)
+{
+    fillContainer(container, x, y, 0, x.size());
+}
+
+PlotManager::PlotManager(QObject *parent) : QObject(parent),
+    m_crosshairEnabled(false),
+    m_linkedXAxes(false),
+    m_syncingXRange(false),
+    m_hasSharedXRange(false),
+    m_followSpan(0.0),
+    m_segmentMode(OverlaySegments)
 {
 
 }
 
 void PlotManager::addPlot(int plotId, QCustomPlot* plot)
 {
-    m_plots[plotId] = plot;
+    declarePlot(plotId);
+    attachPlot(plotId, plot);
+}
+
+void PlotManager::declarePlot(int plotId)
+{
+    if (!m_plots.contains(plotId)) {
+        m_plots.insert(plotId, PlotBinding());
+    }
+}
+
+void PlotManager::attachPlot(int plotId, QCustomPlot* plot)
+{
+    if (!m_plots.contains(plotId) || !plot) {
+        qWarning() << "Cannot attach widget: plot" << plotId << "does not exist";
+        return;
+    }
+
+    // PlotGrid recycles widgets: one still bound elsewhere, or attached
+    // again, must not forward its range changes twice
+    for (auto it = m_plots.begin(); it != m_plots.end(); ++it) {
+        if (it.value().widget == plot || (it.key() == plotId && it.value().widget)) {
+            detachPlot(it.key());
+        }
+    }
+    PlotBinding& binding = m_plots[plotId];
+    binding.widget = plot;
+
+    // Graphs share the binding's data containers, so attaching never copies samples
+    plot->clearGraphs();
+    for (const CurveBinding& curve : binding.curves) {
+        createGraph(plot, curve);
+    }
+    applyAxisScales(binding);
+    if (m_crosshairEnabled) {
+        installCrosshair(binding);
+    }
+    rescalePlot(plot);
+    if (isFollowing()) {
+        for (CurveBinding& curve : binding.curves) curve.followSeeded = false;
+        followPlot(binding, lastKey(binding));
+    } else if (m_linkedXAxes && m_hasSharedXRange) {
+        // Plots scrolled into view (PlotGrid) join the shared window
+        m_syncingXRange = true;
+        plot->xAxis->setRange(m_sharedXRange);
+        m_syncingXRange = false;
+    }
+    binding.xRangeConnection = connect(plot->xAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged), this, [this, plot, plotId](const QCPRange& range) {
+        onXRangeChanged(plot, range);
+        emit xRangeChanged(plotId, range);
+    });
+    plot->replot(QCustomPlot::rpQueuedReplot);
 }
 
-void PlotManager::addCurve(int plotId, const PlotConfig& config, const QVector<double>& x, const QVector<double>& y)
+void PlotManager::detachPlot(int plotId)
+{
+    if (!m_plots.contains(plotId)) return;
+
+    PlotBinding& binding = m_plots[plotId];
+    if (binding.widget) {
+        removeCrosshair(binding);
+        disconnect(binding.xRangeConnection);
+        binding.widget->clearGraphs();
+        binding.widget = nullptr;
+    }
+}
+
+QCustomPlot* PlotManager::plotWidget(int plotId) const
+{
+    return m_plots.value(plotId).widget;
+}
+
+QList<int> PlotManager::plotIds() const
+{
+    return m_plots.keys();
+}
+
+void PlotManager::createGraph(QCustomPlot* plot, const CurveBinding& curve)
+{
+    const PlotConfig& config = curve.config;
+    // Earlier runs first, so that the last run is drawn on top of them
+    if (m_segmentMode == OverlaySegments) {
+        QColor faded = config.color;
+        faded.setAlpha(90);
+        for (int k = 0; k < curve.earlierSegments.size(); ++k) {
+            QCPGraph* run = plot->addGraph();
+            run->setName(QString("%1 (run %2)").arg(config.name).arg(k + 1));
+            run->setData(curve.earlierSegments.at(k));
+            run->setPen(QPen(faded, config.thickness));
+            if (config.style == PlotConfig::Points) run->setLineStyle(QCPGraph::lsNone);
+            if (config.style != PlotConfig::Line) run->setScatterStyle(QCPScatterStyle::ssCircle);
+            run->removeFromLegend();
+        }
+    }
+
+    QCPGraph* graph = plot->addGraph();
+    graph->setName(config.name);
+    graph->setData(curve.data);
+
+    QPen pen;
+    pen.setColor(config.color);
+    pen.setWidth(config.thickness);
+    graph->setPen(pen);
+
+    if (config.style == PlotConfig::LineAndPoints)
+    {
+        graph->setScatterStyle(QCPScatterStyle::ssCircle);
+    }
+    else if (config.style == PlotConfig::Points)
+    {
+        graph->setLineStyle(QCPGraph::lsNone);
+        graph->setScatterStyle(QCPScatterStyle::ssCircle);
+    }
+}
+
+void PlotManager::rebuildGraphs(PlotBinding& binding)
+{
+    QCustomPlot* plot = binding.widget;
+    if (!plot) return;
+    plot->clearGraphs();
+    for (const CurveBinding& curve : binding.curves) {
+        createGraph(plot, curve);
+    }
+}
+
+bool PlotManager::fillSegments(CurveBinding& curve, const QVector<double>& x, const QVector<double>& y, const QVector<int>& segmentStarts)
+{
+    // Containers are refilled in place, so graphs showing them stay valid
+    const int earlier = segmentStarts.size() > kMaxSegments ? 0 : qMax(0, segmentStarts.size() - 1);
+    const bool changed = earlier != curve.earlierSegments.size();
+    while (curve.earlierSegments.size() > earlier) curve.earlierSegments.removeLast();
+    while (curve.earlierSegments.size() < earlier) curve.earlierSegments.append(QSharedPointer<QCPGraphDataContainer>::create());
+    for (int k = 0; k < earlier; ++k) {
+        fillContainer(curve.earlierSegments[k].data(), x, y, segmentStarts.at(k), segmentStarts.at(k + 1));
+    }
+    fillContainer(curve.data.data(), x, y, earlier > 0 ? segmentStarts.last() : 0, x.size());
+    return changed;
+}
+
+void PlotManager::setSegmentMode(SegmentMode mode)
+{
+    if (mode == m_segmentMode) return;
+    m_segmentMode = mode;
+    for (PlotBinding& binding : m_plots) {
+        if (!binding.widget) continue;
+        rebuildGraphs(binding);
+        for (CurveBinding& curve : binding.curves) curve.followSeeded = false;
+    }
+    if (isFollowing()) followTail();
+    else resetZoomAll();
+}
+
+void PlotManager::applyAxisScales(const PlotBinding& binding)
+{
+    QCustomPlot* plot = binding.widget;
+    if (!plot) return;
+    plot->yAxis->setScaleType(binding.logarithmicYAxis ? QCPAxis::stLogarithmic : QCPAxis::stLinear);
+    plot->xAxis->setScaleType(binding.logarithmicXAxis ? QCPAxis::stLogarithmic : QCPAxis::stLinear);
+}
+
+void PlotManager::addCurve(int plotId, const PlotConfig& config, const QVector<double>& x, const QVector<double>& y, const QVector<int>& segmentStarts)
 {
     qDebug() << "Adding curve:" << config.name << "to plot" << plotId;
     qDebug() << "x data size:" << x.size();
@@ -35,28 +255,20 @@ void PlotManager::addCurve(int plotId, const PlotConfig& config, const QVector<d
     }
     
     try {
-        QCustomPlot* plot = m_plots[plotId];
-        plot->addGraph();
-        plot->graph()->setName(config.name);
-        plot->graph()->setData(x, y);
+        CurveBinding curve;
+        curve.config = config;
+        curve.data = QSharedPointer<QCPGraphDataContainer>::create();
+        fillSegments(curve, x, y, segmentStarts);
 
-        QPen pen;
-        pen.setColor(config.color);
-        pen.setWidth(config.thickness);
-        plot->graph()->setPen(pen);
+        PlotBinding& binding = m_plots[plotId];
+        binding.curves.append(curve);
 
-        if (config.style == PlotConfig::LineAndPoints)
-        {
-            plot->graph()->setScatterStyle(QCPScatterStyle::ssCircle);
-        }
-        else if (config.style == PlotConfig::Points)
-        {
-            plot->graph()->setLineStyle(QCPGraph::lsNone);
-            plot->graph()->setScatterStyle(QCPScatterStyle::ssCircle);
+        // Off-screen plots only keep the binding; the graph is created on attach
+        if (QCustomPlot* plot = binding.widget) {
+            createGraph(plot, curve);
+            rescalePlot(plot);
+            plot->replot(QCustomPlot::rpQueuedReplot);
         }
-
-        plot->rescaleAxes();
-        plot->replot();
     } catch (const std::exception& e) {
         qCritical() << "Exception while adding curve:" << e.what();
     } catch (...) {
@@ -64,7 +276,7 @@ void PlotManager::addCurve(int plotId, const PlotConfig& config, const QVector<d
     }
 }
 
-void PlotManager::updateCurve(int plotId, const QString& name, const QVector<double>& newX, const QVector<double>& newY)
+void PlotManager::updateCurve(int plotId, const QString& name, const QVector<double>& newX, const QVector<double>& newY, const QVector<int>& segmentStarts)
 {
     qDebug() << "Updating curve:" << name << "in plot" << plotId;
     qDebug() << "newX data size:" << newX.size();
@@ -87,14 +299,18 @@ void PlotManager::updateCurve(int plotId, const QString& name, const QVector<dou
     }
     
     try {
-        QCustomPlot* plot = m_plots[plotId];
-        for (int i = 0; i < plot->graphCount(); ++i)
+        PlotBinding& binding = m_plots[plotId];
+        for (CurveBinding& curve : binding.curves)
         {
-            if (plot->graph(i)->name() == name)
+            if (curve.config.name == name)
             {
-                plot->graph(i)->setData(newX, newY);
-                plot->rescaleAxes();
-                plot->replot();
+                bool runsChanged = fillSegments(curve, newX, newY, segmentStarts);
+                curve.followSeeded = false;
+                if (QCustomPlot* plot = binding.widget) {
+                    if (runsChanged && m_segmentMode == OverlaySegments) rebuildGraphs(binding);
+                    rescalePlot(plot);
+                    plot->replot(QCustomPlot::rpQueuedReplot);
+                }
                 return;
             }
         }
@@ -106,18 +322,236 @@ void PlotManager::updateCurve(int plotId, const QString& name, const QVector<dou
     }
 }
 
+void PlotManager::appendCurve(int plotId, const QString& name, const QVector<double>& x, const QVector<double>& y, int firstRow, const QVector<int>& segmentStarts)
+{
+    if (x.size() != y.size() || firstRow < 0 || firstRow >= x.size()) return;
+    if (!m_plots.contains(plotId)) {
+        qWarning() << "Cannot append to curve: plot" << plotId << "does not exist";
+        return;
+    }
+
+    PlotBinding& binding = m_plots[plotId];
+    for (CurveBinding& curve : binding.curves) {
+        if (curve.config.name != name) continue;
+        bool newRuns = false;
+        bool atTail = true;
+        if (segmentStarts.size() > kMaxSegments) {
+            // Past the cap the runs are merged once, then only appended to
+            if (!curve.earlierSegments.isEmpty()) {
+                fillSegments(curve, x, y, segmentStarts);
+                newRuns = true;
+            } else {
+                atTail = appendContainer(curve.data.data(), x, y, firstRow, x.size());
+            }
+        } else {
+            // Runs starting among the new rows close the current one
+            int from = firstRow;
+            for (auto start = std::lower_bound(segmentStarts.constBegin(), segmentStarts.constEnd(), firstRow); start != segmentStarts.constEnd(); ++start) {
+                if (*start == 0) continue;
+                appendContainer(curve.data.data(), x, y, from, *start);
+                curve.earlierSegments.append(curve.data);
+                curve.data = QSharedPointer<QCPGraphDataContainer>::create();
+                from = *start;
+                newRuns = true;
+            }
+            atTail = appendContainer(curve.data.data(), x, y, from, x.size());
+        }
+        // Follow-tail resumes at an index of the container, which points
+        // merged before the end shift
+        if (newRuns || !atTail) curve.followSeeded = false;
+        if (newRuns) rebuildGraphs(binding);
+        if (QCustomPlot* plot = binding.widget) {
+            plot->replot(QCustomPlot::rpQueuedReplot);
+        }
+        return;
+    }
+    qWarning() << "Curve not found:" << name;
+}
+
+void PlotManager::setCurveData(int plotId, const QString& name, const QVector<double>& x, const QVector<double>& y)
+{
+    if (x.size() != y.size() || !m_plots.contains(plotId)) return;
+
+    PlotBinding& binding = m_plots[plotId];
+    for (CurveBinding& curve : binding.curves) {
+        if (curve.config.name != name) continue;
+        fillContainer(curve.data.data(), x, y);
+        curve.followSeeded = false;
+        if (QCustomPlot* plot = binding.widget) {
+            plot->replot(QCustomPlot::rpQueuedReplot);
+        }
+        return;
+    }
+    qWarning() << "Curve not found:" << name;
+}
+
+void PlotManager::setFollowSpan(double span)
+{
+    m_followSpan = qMax(0.0, span);
+    for (PlotBinding& binding : m_plots) {
+        for (CurveBinding& curve : binding.curves) curve.followSeeded = false;
+    }
+    if (isFollowing()) followTail();
+    else resetZoomAll();
+}
+
+double PlotManager::lastKey(const PlotBinding& binding)
+{
+    double xmax = -std::numeric_limits<double>::infinity();
+    for (const CurveBinding& curve : binding.curves) {
+        if (!curve.data->isEmpty()) xmax = qMax(xmax, (curve.data->constEnd() - 1)->key);
+    }
+    return xmax;
+}
+
+void PlotManager::followTail()
+{
+    if (!isFollowing()) return;
+    // Linked plots follow the same window, ending at the overall last key
+    double sharedXmax = -std::numeric_limits<double>::infinity();
+    if (m_linkedXAxes) {
+        for (const PlotBinding& binding : m_plots) {
+            if (binding.widget) sharedXmax = qMax(sharedXmax, lastKey(binding));
+        }
+    }
+    for (PlotBinding& binding : m_plots) {
+        if (!binding.widget) continue;
+        followPlot(binding, m_linkedXAxes ? sharedXmax : lastKey(binding));
+    }
+}
+
+void PlotManager::followPlot(PlotBinding& binding, double xmax)
+{
+    QCustomPlot* plot = binding.widget;
+    if (!plot || !std::isfinite(xmax)) return;
+    const double xmin = xmax - m_followSpan;
+
+    QCPRange yRange;
+    bool hasY = false;
+    for (CurveBinding& curve : binding.curves) {
+        const QCPGraphDataContainer& data = *curve.data;
+        if (!curve.followSeeded) {
+            // Start from the first point inside the window; older points are never read
+            curve.followMinimum.reset();
+            curve.followMaximum.reset();
+            curve.followedPoints = data.findBegin(xmin, false) - data.constBegin();
+            curve.followSeeded = true;
+        }
+        QCPGraphDataContainer::const_iterator it = data.constBegin() + curve.followedPoints;
+        for (; it != data.constEnd(); ++it) {
+            double value = it->value;
+            if (!std::isfinite(value) || (binding.logarithmicYAxis && value <= 0.0)) continue;
+            curve.followMinimum.push(it->key, value);
+            curve.followMaximum.push(it->key, value);
+        }
+        curve.followedPoints = data.size();
+        curve.followMinimum.expireBefore(xmin);
+        curve.followMaximum.expireBefore(xmin);
+        if (curve.followMinimum.isEmpty()) continue;
+
+        QCPRange curveRange(curve.followMinimum.value(), curve.followMaximum.value());
+        if (hasY) yRange.expand(curveRange);
+        else yRange = curveRange;
+        hasY = true;
+    }
+
+    m_syncingXRange = true;
+    plot->xAxis->setRange(xmin, xmax);
+    m_syncingXRange = false;
+    if (hasY) {
+        if (binding.logarithmicYAxis) {
+            yRange = QCPRange(yRange.lower / 1.1, yRange.upper * 1.1);
+        } else {
+            double margin = yRange.size() > 0.0 ? 0.05 * yRange.size() : qMax(1e-12, 0.05 * qAbs(yRange.upper));
+            yRange = QCPRange(yRange.lower - margin, yRange.upper + margin);
+        }
+        plot->yAxis->setRange(yRange);
+    }
+    plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
 void PlotManager::resetZoom(int plotId)
 {
-    if (m_plots.contains(plotId))
+    if (QCustomPlot* plot = plotWidget(plotId))
     {
-        m_plots[plotId]->rescaleAxes();
-        m_plots[plotId]->replot();
+        rescalePlot(plot);
+        plot->replot(QCustomPlot::rpQueuedReplot);
+    }
+}
+
+void PlotManager::resetZoomAll()
+{
+    QCPRange xRange;
+    bool hasXRange = false;
+    for (const PlotBinding& binding : m_plots) {
+        if (!binding.widget) continue;
+        rescalePlot(binding.widget);
+        if (hasXRange) {
+            xRange.expand(binding.widget->xAxis->range());
+        } else {
+            xRange = binding.widget->xAxis->range();
+            hasXRange = true;
+        }
+    }
+
+    if (m_linkedXAxes && hasXRange) {
+        m_sharedXRange = xRange;
+        m_hasSharedXRange = true;
+        applySharedXRange(xRange);
+    } else {
+        for (const PlotBinding& binding : m_plots) {
+            if (binding.widget) binding.widget->replot(QCustomPlot::rpQueuedReplot);
+        }
+    }
+}
+
+void PlotManager::rescalePlot(QCustomPlot* plot)
+{
+    // Fitting one plot to its own data must not drag the linked plots along
+    m_syncingXRange = true;
+    plot->rescaleAxes();
+    m_syncingXRange = false;
+}
+
+void PlotManager::setLinkedXAxes(bool linked)
+{
+    if (linked == m_linkedXAxes) return;
+    m_linkedXAxes = linked;
+    m_hasSharedXRange = false;
+    if (linked) {
+        resetZoomAll();
     }
 }
 
+void PlotManager::onXRangeChanged(QCustomPlot* source, const QCPRange& range)
+{
+    // Ranges set while propagating come back through this slot; ignore them
+    if (!m_linkedXAxes || m_syncingXRange) return;
+    m_sharedXRange = range;
+    m_hasSharedXRange = true;
+    applySharedXRange(range, source);
+}
+
+void PlotManager::applySharedXRange(const QCPRange& range, QCustomPlot* except)
+{
+    m_syncingXRange = true;
+    for (const PlotBinding& binding : m_plots) {
+        QCustomPlot* plot = binding.widget;
+        if (!plot || plot == except) continue;
+        plot->xAxis->setRange(range);
+        // Queued replots coalesce, so a drag costs one repaint per plot per frame
+        plot->replot(QCustomPlot::rpQueuedReplot);
+    }
+    m_syncingXRange = false;
+}
+
 QList<QCustomPlot*> PlotManager::getPlots() const
 {
-    return m_plots.values();
+    QList<QCustomPlot*> plots;
+    for (const PlotBinding& binding : m_plots) {
+        if (binding.widget) plots.append(binding.widget);
+    }
+    return plots;
 }
 
 void PlotManager::clearPlots()
@@ -125,6 +559,7 @@ void PlotManager::clearPlots()
     // Do not delete widgets here: the MainWindow is responsible for removing
     // and deleting splitter child widgets. Just clear the internal map.
     m_plots.clear();
+    m_hasSharedXRange = false;
 }
 
 void PlotManager::setLogarithmicYAxis(int plotId, bool logarithmic)
@@ -134,13 +569,14 @@ void PlotManager::setLogarithmicYAxis(int plotId, bool logarithmic)
         return;
     }
     
-    QCustomPlot* plot = m_plots[plotId];
-    if (logarithmic) {
-        plot->yAxis->setScaleType(QCPAxis::stLogarithmic);
-    } else {
-        plot->yAxis->setScaleType(QCPAxis::stLinear);
+    PlotBinding& binding = m_plots[plotId];
+    binding.logarithmicYAxis = logarithmic;
+    // Non-positive values are excluded from the follow window on log axes
+    for (CurveBinding& curve : binding.curves) curve.followSeeded = false;
+    if (binding.widget) {
+        applyAxisScales(binding);
+        binding.widget->replot(QCustomPlot::rpQueuedReplot);
     }
-    plot->replot();
 }
 
 void PlotManager::setLogarithmicXAxis(int plotId, bool logarithmic)
@@ -150,11 +586,134 @@ void PlotManager::setLogarithmicXAxis(int plotId, bool logarithmic)
         return;
     }
     
-    QCustomPlot* plot = m_plots[plotId];
-    if (logarithmic) {
-        plot->xAxis->setScaleType(QCPAxis::stLogarithmic);
-    } else {
-        plot->xAxis->setScaleType(QCPAxis::stLinear);
+    PlotBinding& binding = m_plots[plotId];
+    binding.logarithmicXAxis = logarithmic;
+    if (binding.widget) {
+        applyAxisScales(binding);
+        binding.widget->replot(QCustomPlot::rpQueuedReplot);
+    }
+}
+
+void PlotManager::setCrosshairEnabled(bool enabled)
+{
+    if (enabled == m_crosshairEnabled) return;
+    m_crosshairEnabled = enabled;
+    for (PlotBinding& binding : m_plots) {
+        if (!binding.widget) continue;
+        if (enabled) installCrosshair(binding);
+        else removeCrosshair(binding);
+        binding.widget->replot(QCustomPlot::rpQueuedReplot);
+    }
+}
+
+void PlotManager::installCrosshair(PlotBinding& binding)
+{
+    QCustomPlot* plot = binding.widget;
+    if (!plot || binding.crosshairLine) return;
+
+    // Items live on their own buffered layer: moving them repaints only that
+    // layer and never re-renders the graphs
+    QCPLayer* layer = plot->layer("crosshair");
+    if (!layer) {
+        plot->addLayer("crosshair", plot->layer("main"), QCustomPlot::limAbove);
+        layer = plot->layer("crosshair");
+        layer->setMode(QCPLayer::lmBuffered);
+    }
+
+    QCPItemStraightLine* line = new QCPItemStraightLine(plot);
+    line->setLayer(layer);
+    line->setPen(QPen(Qt::gray, 1, Qt::DashLine));
+    line->setSelectable(false);
+    line->setVisible(false);
+
+    QCPItemText* label = new QCPItemText(plot);
+    label->setLayer(layer);
+    label->position->setType(QCPItemPosition::ptAxisRectRatio);
+    label->position->setCoords(0.01, 0.01);
+    label->setPositionAlignment(Qt::AlignTop | Qt::AlignLeft);
+    label->setTextAlignment(Qt::AlignLeft);
+    label->setPadding(QMargins(4, 2, 4, 2));
+    label->setBrush(QBrush(QColor(255, 255, 255, 210)));
+    label->setPen(QPen(Qt::gray));
+    label->setSelectable(false);
+    label->setVisible(false);
+
+    binding.crosshairLine = line;
+    binding.crosshairLabel = label;
+    plot->installEventFilter(this);
+}
+
+void PlotManager::removeCrosshair(PlotBinding& binding)
+{
+    QCustomPlot* plot = binding.widget;
+    if (!plot) return;
+    plot->removeEventFilter(this);
+    if (binding.crosshairLine) plot->removeItem(binding.crosshairLine);
+    if (binding.crosshairLabel) plot->removeItem(binding.crosshairLabel);
+    binding.crosshairLine = nullptr;
+    binding.crosshairLabel = nullptr;
+}
+
+bool PlotManager::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::MouseMove || event->type() == QEvent::Leave) {
+        if (QCustomPlot* plot = qobject_cast<QCustomPlot*>(watched)) {
+            if (event->type() == QEvent::MouseMove) {
+                QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+                updateCrosshair(plot->xAxis->pixelToCoord(mouseEvent->position().x()));
+            } else {
+                hideCrosshair();
+            }
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+bool PlotManager::valueAt(const QCPGraphDataContainer& data, double key, double* value)
+{
+    // Binary search on the sorted keys, then linear interpolation
+    if (data.isEmpty()) return false;
+    if (key < data.constBegin()->key || key > (data.constEnd() - 1)->key) return false;
+    QCPGraphDataContainer::const_iterator it = data.findBegin(key, false);
+    if (it == data.constEnd()) return false;
+    if (it->key == key || it == data.constBegin()) {
+        *value = it->value;
+        return !std::isnan(*value);
+    }
+    QCPGraphDataContainer::const_iterator previous = it - 1;
+    double t = (key - previous->key) / (it->key - previous->key);
+    *value = previous->value + t * (it->value - previous->value);
+    // Next to a gap there is no value to show
+    return !std::isnan(*value);
+}
+
+void PlotManager::updateCrosshair(double key)
+{
+    for (PlotBinding& binding : m_plots) {
+        if (!binding.widget || !binding.crosshairLine) continue;
+        binding.crosshairLine->point1->setCoords(key, 0.0);
+        binding.crosshairLine->point2->setCoords(key, 1.0);
+        binding.crosshairLine->setVisible(true);
+
+        QStringList lines;
+        lines.append(QString("x = %1").arg(QString::number(key, 'g', 8)));
+        for (const CurveBinding& curve : binding.curves) {
+            double value = 0.0;
+            bool found = valueAt(*curve.data, key, &value);
+            lines.append(QString("%1: %2").arg(curve.config.name, found ? QString::number(value, 'g', 6) : QStringLiteral("-")));
+        }
+        binding.crosshairLabel->setText(lines.join('\n'));
+        binding.crosshairLabel->setVisible(true);
+        binding.widget->layer("crosshair")->replot();
+    }
+}
+
+void PlotManager::hideCrosshair()
+{
+    for (PlotBinding& binding : m_plots) {
+        if (!binding.widget || !binding.crosshairLine) continue;
+        binding.crosshairLine->setVisible(false);
+        binding.crosshairLabel->setVisible(false);
+        binding.widget->layer("crosshair")->replot();
     }
-    plot->replot();
 }
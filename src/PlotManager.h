@@ -3,25 +3,120 @@
 
 #include <QObject>
 #include <QMap>
+#include <QSharedPointer>
 #include "qcustomplot.h"
 #include "PlotConfigDialog.h"
+#include "RollingWindow.h"
 
 class PlotManager : public QObject
 {
     Q_OBJECT
 public:
+    // Runs of a restarted job (see CSVReader::getSegmentStarts): only the
+    // last one, or all of them with the earlier runs faded
+    enum SegmentMode { LatestSegment, OverlaySegments };
+
     explicit PlotManager(QObject *parent = nullptr);
     void addPlot(int plotId, QCustomPlot* plot);
-    void addCurve(int plotId, const PlotConfig& config, const QVector<double>& x, const QVector<double>& y);
-    void updateCurve(int plotId, const QString& name, const QVector<double>& newX, const QVector<double>& newY);
+    // Registers a plot without a widget; curves added to it are kept as data
+    // bindings until a widget is attached (see PlotGrid).
+    void declarePlot(int plotId);
+    void attachPlot(int plotId, QCustomPlot* plot);
+    void detachPlot(int plotId);
+    QCustomPlot* plotWidget(int plotId) const;
+    QList<int> plotIds() const;
+    // `segmentStarts` holds the first row of each run; empty for a single
+    // run. A curve with more than 32 runs is drawn as a single one.
+    void addCurve(int plotId, const PlotConfig& config, const QVector<double>& x, const QVector<double>& y, const QVector<int>& segmentStarts = QVector<int>());
+    void updateCurve(int plotId, const QString& name, const QVector<double>& newX, const QVector<double>& newY, const QVector<int>& segmentStarts = QVector<int>());
+    // Appends rows [firstRow, x.size()) to the curve without touching older
+    // points; a run starting among them closes the current one
+    void appendCurve(int plotId, const QString& name, const QVector<double>& x, const QVector<double>& y, int firstRow, const QVector<int>& segmentStarts = QVector<int>());
+    // Replaces the points of a curve but keeps the axis ranges, for views
+    // that resample their data when the user zooms (see OutOfCoreView)
+    void setCurveData(int plotId, const QString& name, const QVector<double>& x, const QVector<double>& y);
     void resetZoom(int plotId);
+    // Rescales every plot once; with linked X axes all plots get the union
+    // of their X ranges
+    void resetZoomAll();
     QList<QCustomPlot*> getPlots() const;
     void clearPlots();
     void setLogarithmicYAxis(int plotId, bool logarithmic);
     void setLogarithmicXAxis(int plotId, bool logarithmic);
+    // Hover crosshair with the value of every curve at the cursor X, shown
+    // in all attached plots at once
+    void setCrosshairEnabled(bool enabled);
+    bool isCrosshairEnabled() const { return m_crosshairEnabled; }
+    // Shares one X range between all plots: a pan/zoom in one plot is
+    // applied to the others with a single queued replot each
+    void setLinkedXAxes(bool linked);
+    bool isLinkedXAxes() const { return m_linkedXAxes; }
+    void setSegmentMode(SegmentMode mode);
+    SegmentMode segmentMode() const { return m_segmentMode; }
+    // Follow-tail mode: X tracks [xmax - span, xmax] and Y fits the points in
+    // that window only. A span of 0 turns it off.
+    void setFollowSpan(double span);
+    double followSpan() const { return m_followSpan; }
+    bool isFollowing() const { return m_followSpan > 0.0; }
+    // Applies the follow window after an append; costs O(new points)
+    void followTail();
+
+signals:
+    // Any X range change of an attached plot, including propagated ones
+    void xRangeChanged(int plotId, const QCPRange& range);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
 
 private:
-    QMap<int, QCustomPlot*> m_plots;
+    struct CurveBinding {
+        PlotConfig config;
+        // Points of the last run; follow-tail and the crosshair read these
+        QSharedPointer<QCPGraphDataContainer> data;
+        // Runs before the last restart, oldest first
+        QList<QSharedPointer<QCPGraphDataContainer>> earlierSegments;
+        // Follow-tail state: extrema of the points inside the window
+        bool followSeeded = false;
+        int followedPoints = 0;
+        RollingMinimum followMinimum;
+        RollingMaximum followMaximum;
+    };
+    struct PlotBinding {
+        QList<CurveBinding> curves;
+        QCustomPlot* widget = nullptr;
+        bool logarithmicYAxis = false;
+        bool logarithmicXAxis = false;
+        QCPItemStraightLine* crosshairLine = nullptr;
+        QCPItemText* crosshairLabel = nullptr;
+        // X range forwarding of the attached widget, dropped on detach
+        QMetaObject::Connection xRangeConnection;
+    };
+
+    QMap<int, PlotBinding> m_plots;
+    bool m_crosshairEnabled;
+    bool m_linkedXAxes;
+    bool m_syncingXRange;
+    bool m_hasSharedXRange;
+    QCPRange m_sharedXRange;
+    double m_followSpan;
+    SegmentMode m_segmentMode;
+
+    void createGraph(QCustomPlot* plot, const CurveBinding& curve);
+    void rebuildGraphs(PlotBinding& binding);
+    // Splits rows into the runs of the curve; returns whether the number of
+    // earlier runs changed
+    static bool fillSegments(CurveBinding& curve, const QVector<double>& x, const QVector<double>& y, const QVector<int>& segmentStarts);
+    void applyAxisScales(const PlotBinding& binding);
+    void rescalePlot(QCustomPlot* plot);
+    void followPlot(PlotBinding& binding, double xmax);
+    static double lastKey(const PlotBinding& binding);
+    void onXRangeChanged(QCustomPlot* source, const QCPRange& range);
+    void applySharedXRange(const QCPRange& range, QCustomPlot* except = nullptr);
+    void installCrosshair(PlotBinding& binding);
+    void removeCrosshair(PlotBinding& binding);
+    void updateCrosshair(double key);
+    void hideCrosshair();
+    static bool valueAt(const QCPGraphDataContainer& data, double key, double* value);
 };
 
 #endif // PLOTMANAGER_H
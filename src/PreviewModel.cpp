@@ -0,0 +1,38 @@
+#include "PreviewModel.h"
+#include "CSVReader.h"
+
+PreviewModel::PreviewModel(QObject* parent) :
+    QAbstractTableModel(parent),
+    m_columnCount(0)
+{
+}
+
+void PreviewModel::setLines(const QStringList& lines, const CSVReader& settings)
+{
+    beginResetModel();
+    m_rows.clear();
+    m_rows.reserve(lines.size());
+    m_columnCount = 0;
+    for (const QString& line : lines) {
+        QStringList fields = settings.isCommentLine(line) ? QStringList(line) : settings.splitFields(line);
+        m_columnCount = qMax(m_columnCount, int(fields.size()));
+        m_rows.append(fields);
+    }
+    endResetModel();
+}
+
+int PreviewModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int PreviewModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_columnCount;
+}
+
+QVariant PreviewModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole)) return QVariant();
+    return m_rows.at(index.row()).value(index.column());
+}
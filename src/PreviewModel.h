@@ -0,0 +1,32 @@
+#ifndef PREVIEWMODEL_H
+#define PREVIEWMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+
+class CSVReader;
+
+// First lines of a file split with the parser settings, for the parser
+// dialog preview. Cells are served from the split fields on demand instead
+// of one table item per cell.
+class PreviewModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit PreviewModel(QObject* parent = nullptr);
+
+    // Comment lines are kept whole in the first column
+    void setLines(const QStringList& lines, const CSVReader& settings);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<QStringList> m_rows;
+    int m_columnCount;
+};
+
+#endif // PREVIEWMODEL_H
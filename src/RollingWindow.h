@@ -0,0 +1,254 @@
+#ifndef ROLLINGWINDOW_H
+#define ROLLINGWINDOW_H
+
+#include <QVector>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <utility>
+
+// Missing samples are stored as NaN. The accumulators below skip them with
+// selects rather than branches: a gap adds 0 to the sums and 0 to the count.
+inline double valueOrZero(double value)
+{
+    return value == value ? value : 0.0;
+}
+
+// Running sum over the last N pushed values, O(1) per push. The sum is
+// recomputed from the ring each time it wraps around, which keeps rounding
+// drift bounded at an amortized O(1) cost. NaN values count towards the
+// window length but not towards the sum or the mean.
+class RollingSum
+{
+public:
+    explicit RollingSum(int window = 1) { reset(window); }
+
+    void reset(int window)
+    {
+        m_values = QVector<double>(qMax(1, window), 0.0);
+        m_pos = 0;
+        m_count = 0;
+        m_valid = 0;
+        m_sum = 0.0;
+    }
+
+    void push(double value)
+    {
+        if (m_count == m_values.size()) {
+            const double oldest = m_values[m_pos];
+            m_sum -= valueOrZero(oldest);
+            m_valid -= oldest == oldest;
+        } else {
+            ++m_count;
+        }
+        m_values[m_pos] = value;
+        m_sum += valueOrZero(value);
+        m_valid += value == value;
+        if (++m_pos == m_values.size()) {
+            m_pos = 0;
+            if (m_count == m_values.size()) {
+                double exact = 0.0;
+                for (double v : m_values) exact += valueOrZero(v);
+                m_sum = exact;
+            }
+        }
+    }
+
+    int window() const { return m_values.size(); }
+    int count() const { return m_count; }
+    bool isFull() const { return m_count == m_values.size(); }
+    double sum() const { return m_sum; }
+    // NaN while the window holds gaps only
+    double mean() const { return m_valid > 0 ? m_sum / m_valid : std::numeric_limits<double>::quiet_NaN(); }
+    // Value that the next push will evict (only meaningful when full)
+    double oldest() const { return m_values[m_pos]; }
+
+private:
+    QVector<double> m_values;
+    int m_pos;
+    int m_count;
+    int m_valid;
+    double m_sum;
+};
+
+// Sliding-window extremum using a monotonic deque. Each value is pushed and
+// popped at most once, so push/expire are amortized O(1). Positions must be
+// pushed in non-decreasing order; they can be row indices or X values.
+// NaN values are gaps and are not pushed.
+template <typename Compare>
+class MonotonicDeque
+{
+public:
+    void reset() { m_entries.clear(); }
+
+    void push(double position, double value)
+    {
+        if (value != value) return;
+        Compare keep;
+        while (!m_entries.empty() && !keep(m_entries.back().second, value)) {
+            m_entries.pop_back();
+        }
+        m_entries.emplace_back(position, value);
+    }
+
+    // Drops entries whose position is strictly before `position`
+    void expireBefore(double position)
+    {
+        while (!m_entries.empty() && m_entries.front().first < position) {
+            m_entries.pop_front();
+        }
+    }
+
+    bool isEmpty() const { return m_entries.empty(); }
+    // NaN when the window holds no value
+    double value() const { return m_entries.empty() ? std::numeric_limits<double>::quiet_NaN() : m_entries.front().second; }
+
+private:
+    std::deque<std::pair<double, double>> m_entries;
+};
+
+// Mean of the values whose position lies in a trailing span (row indices or
+// X values). Positions must be pushed in non-decreasing order. The sum is
+// re-accumulated once as many entries have expired as remain, which bounds
+// rounding drift at an amortized O(1) cost. NaN values are kept as entries
+// so that they expire in order, but are left out of the sum and the count.
+class SlidingMean
+{
+public:
+    void reset()
+    {
+        m_entries.clear();
+        m_sum = 0.0;
+        m_valid = 0;
+        m_expired = 0;
+    }
+
+    void push(double position, double value)
+    {
+        m_entries.emplace_back(position, value);
+        m_sum += valueOrZero(value);
+        m_valid += value == value;
+    }
+
+    void expireBefore(double position)
+    {
+        while (!m_entries.empty() && m_entries.front().first < position) {
+            const double value = m_entries.front().second;
+            m_sum -= valueOrZero(value);
+            m_valid -= value == value;
+            m_entries.pop_front();
+            ++m_expired;
+        }
+        if (m_expired > m_entries.size()) {
+            m_sum = 0.0;
+            for (const auto& entry : m_entries) m_sum += valueOrZero(entry.second);
+            m_expired = 0;
+        }
+    }
+
+    // Values in the window, gaps excluded
+    int count() const { return m_valid; }
+    double mean() const { return m_valid > 0 ? m_sum / m_valid : 0.0; }
+
+private:
+    std::deque<std::pair<double, double>> m_entries;
+    double m_sum = 0.0;
+    int m_valid = 0;
+    size_t m_expired = 0;
+};
+
+// Least-squares slope of the last N values against their sample index,
+// O(1) per push. Both sums are recomputed from the ring on wrap-around.
+class RollingSlope
+{
+public:
+    explicit RollingSlope(int window = 2) { reset(window); }
+
+    void reset(int window)
+    {
+        m_values = QVector<double>(qMax(2, window), 0.0);
+        m_pos = 0;
+        m_count = 0;
+        m_sum = 0.0;
+        m_weighted = 0.0;
+    }
+
+    void push(double value)
+    {
+        const int n = m_values.size();
+        if (m_count == n) {
+            // Every remaining sample moves one index down
+            double oldest = m_values[m_pos];
+            m_weighted += (n - 1) * value - (m_sum - oldest);
+            m_sum += value - oldest;
+        } else {
+            m_weighted += m_count * value;
+            m_sum += value;
+            ++m_count;
+        }
+        m_values[m_pos] = value;
+        if (++m_pos == n) {
+            m_pos = 0;
+            if (m_count == n) {
+                m_sum = 0.0;
+                m_weighted = 0.0;
+                for (int j = 0; j < n; ++j) {
+                    m_sum += m_values[j];
+                    m_weighted += j * m_values[j];
+                }
+            }
+        }
+    }
+
+    int count() const { return m_count; }
+    bool isFull() const { return m_count == m_values.size(); }
+    double slope() const
+    {
+        if (m_count < 2) return std::numeric_limits<double>::quiet_NaN();
+        double k = m_count;
+        double sxx = k * (k * k - 1.0) / 12.0;
+        return (m_weighted - 0.5 * (k - 1.0) * m_sum) / sxx;
+    }
+
+private:
+    QVector<double> m_values;
+    int m_pos;
+    int m_count;
+    double m_sum;
+    double m_weighted;
+};
+
+// Count, extrema, mean and variance of a stream (Welford's algorithm).
+// NaN values are skipped: fmin/fmax ignore them and the Welford update of a
+// gap is a zero step, so the loop feeding it needs no test.
+struct RunningStatistics
+{
+    qint64 count = 0;
+    double minimum = std::numeric_limits<double>::quiet_NaN();
+    double maximum = std::numeric_limits<double>::quiet_NaN();
+    double mean = 0.0;
+    double m2 = 0.0;
+    double last = std::numeric_limits<double>::quiet_NaN();
+
+    void add(double value)
+    {
+        const bool valid = value == value;
+        minimum = std::fmin(minimum, value);
+        maximum = std::fmax(maximum, value);
+        count += valid;
+        const double sample = valid ? value : mean;
+        double delta = sample - mean;
+        mean += delta / (count > 0 ? count : 1);
+        m2 += delta * (sample - mean);
+        last = valid ? value : last;
+    }
+
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    double standardDeviation() const { return std::sqrt(variance()); }
+};
+
+typedef MonotonicDeque<std::less<double>> RollingMinimum;
+typedef MonotonicDeque<std::greater<double>> RollingMaximum;
+
+#endif // ROLLINGWINDOW_H
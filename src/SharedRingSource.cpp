@@ -0,0 +1,149 @@
+#include "SharedRingSource.h"
+#include "rtplotter/SharedRingLayout.h"
+#include "CSVReader.h"
+#include <QDebug>
+#include <cerrno>
+#include <cstring>
+
+#ifndef Q_OS_WIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Interval between two looks at the head index
+    const int kPollMs = 20;
+}
+
+SharedRingSource::SharedRingSource(QObject* parent) :
+    QObject(parent),
+    m_header(nullptr),
+    m_records(nullptr),
+    m_mappedBytes(0),
+    m_endReported(false)
+{
+    m_poll.setInterval(kPollMs);
+    connect(&m_poll, &QTimer::timeout, this, &SharedRingSource::poll);
+}
+
+SharedRingSource::~SharedRingSource()
+{
+    detach();
+}
+
+bool SharedRingSource::attach(const QString& name)
+{
+    detach();
+    m_error.clear();
+    m_name = name.startsWith('/') ? name : "/" + name;
+#ifdef Q_OS_WIN
+    m_error = "shared-memory rings are not supported on this platform";
+    return false;
+#else
+    const QByteArray localName = m_name.toLocal8Bit();
+    const int fd = ::shm_open(localName.constData(), O_RDWR, 0);
+    if (fd < 0) {
+        m_error = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(SharedRingHeader)) {
+        m_error = "not a ring: too small";
+        ::close(fd);
+        return false;
+    }
+    // The tail index is written by the consumer, so the mapping is writable
+    void* base = ::mmap(nullptr, size_t(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        m_error = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+    m_header = static_cast<SharedRingHeader*>(base);
+    m_mappedBytes = size_t(info.st_size);
+
+    const SharedRingHeader& header = *m_header;
+    if (header.magic.load(std::memory_order_acquire) != SharedRingHeader::kMagic) {
+        m_error = "not a ring, or the producer has not finished creating it";
+    } else if (header.version != SharedRingHeader::kVersion) {
+        m_error = QString("ring version %1, expected %2").arg(header.version).arg(SharedRingHeader::kVersion);
+    } else if (header.columnCount == 0 || header.capacity == 0
+               || header.recordsOffset < SharedRingHeader::recordsOffsetFor(header.columnCount)
+               || header.recordsOffset + header.capacity * header.columnCount * sizeof(double) > m_mappedBytes) {
+        m_error = "ring header does not match its size";
+    }
+    if (!m_error.isEmpty()) {
+        detach();
+        return false;
+    }
+
+    const char* names = static_cast<const char*>(base) + SharedRingHeader::namesOffset();
+    for (uint32_t c = 0; c < header.columnCount; ++c) {
+        const char* name = names + c * SharedRingHeader::kNameBytes;
+        m_columns.append(QString::fromUtf8(name, int(strnlen(name, SharedRingHeader::kNameBytes))));
+    }
+    m_records = reinterpret_cast<const double*>(static_cast<const char*>(base) + header.recordsOffset);
+    m_endReported = false;
+    m_poll.start();
+    qDebug() << "SharedRingSource: attached" << m_name << header.columnCount << "columns," << header.capacity << "records";
+    return true;
+#endif
+}
+
+void SharedRingSource::detach()
+{
+    m_poll.stop();
+#ifndef Q_OS_WIN
+    if (m_header) ::munmap(m_header, m_mappedBytes);
+#endif
+    m_header = nullptr;
+    m_records = nullptr;
+    m_mappedBytes = 0;
+    m_columns.clear();
+}
+
+qint64 SharedRingSource::pending() const
+{
+    if (!m_header) return 0;
+    return qint64(m_header->head.load(std::memory_order_acquire) - m_header->tail.load(std::memory_order_relaxed));
+}
+
+bool SharedRingSource::atEnd() const
+{
+    return m_header && m_header->closed.load(std::memory_order_acquire) && pending() == 0;
+}
+
+int SharedRingSource::consume(CSVReader& reader, int maxRecords)
+{
+    if (!m_header || maxRecords <= 0) return 0;
+    // The records up to head were written before head was stored
+    const uint64_t head = m_header->head.load(std::memory_order_acquire);
+    const uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+    const uint64_t capacity = m_header->capacity;
+    if (head - tail > capacity) {
+        qWarning() << "SharedRingSource:" << m_name << "head is" << head - tail << "records ahead of tail, capacity" << capacity;
+        m_error = "producer overwrote unread records";
+        detach();
+        return 0;
+    }
+
+    const uint64_t slot = tail % capacity;
+    const int count = int(qMin<uint64_t>(qMin<uint64_t>(head - tail, capacity - slot), uint64_t(maxRecords)));
+    if (count == 0) return 0;
+    reader.appendRecords(m_records + slot * m_header->columnCount, count);
+    // The slots are free for the producer only once copied
+    m_header->tail.store(tail + uint64_t(count), std::memory_order_release);
+    return count;
+}
+
+void SharedRingSource::poll()
+{
+    if (pending() > 0) {
+        emit readyRead();
+    } else if (atEnd() && !m_endReported) {
+        m_endReported = true;
+        emit readyRead();
+    }
+}
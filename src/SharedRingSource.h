@@ -0,0 +1,58 @@
+#ifndef SHAREDRINGSOURCE_H
+#define SHAREDRINGSOURCE_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+class CSVReader;
+struct SharedRingHeader;
+
+// Consumer side of the shared-memory ring (SharedRingLayout.h): a solver
+// writes binary records, RTPlotter copies them into the column store without
+// any text. The ring is polled from the GUI thread; reading is one acquire
+// load, a copy per record and one release store, with no lock on either
+// side. Records left in the ring while RTPlotter is paused hold the producer
+// back once the ring is full.
+class SharedRingSource : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SharedRingSource(QObject* parent = nullptr);
+    ~SharedRingSource();
+
+    // Maps the ring the producer created under `name` ("/solver")
+    bool attach(const QString& name);
+    void detach();
+    bool isAttached() const { return m_header != nullptr; }
+    QString errorString() const { return m_error; }
+    QString name() const { return m_name; }
+    QStringList columnNames() const { return m_columns; }
+
+    // Copies at most `maxRecords` pending records, up to the end of the ring
+    // (a wrapped range takes two calls), into the raw columns of `reader`
+    // (see CSVReader::beginRecords); returns how many
+    int consume(CSVReader& reader, int maxRecords);
+    qint64 pending() const;
+    // The producer closed the ring and every record has been consumed
+    bool atEnd() const;
+
+signals:
+    // Records are pending, or the producer closed the ring; sent on each
+    // poll until they have been consumed
+    void readyRead();
+
+private:
+    QString m_name;
+    QString m_error;
+    QStringList m_columns;
+    SharedRingHeader* m_header;
+    const double* m_records;
+    size_t m_mappedBytes;
+    bool m_endReported;
+    QTimer m_poll;
+
+    void poll();
+};
+
+#endif // SHAREDRINGSOURCE_H
@@ -0,0 +1,413 @@
+#include "SparseRowIndex.h"
+#include "CSVReader.h"
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+namespace {
+    const quint32 kIndexMagic = 0x52545049; // "RTPI"
+    // 2: parser settings stored as JSON (whitespace, comments, fixed widths)
+    // 3: unparsable fields are gaps and no longer count as 0 in the extrema
+    const quint32 kIndexVersion = 3;
+    const qint64 kReadChunk = 4 * 1024 * 1024;
+    const qint64 kSignatureBytes = 64 * 1024;
+    const qint64 kDefaultCacheBudget = 256LL * 1024 * 1024;
+}
+
+SparseRowIndex::SparseRowIndex() :
+    m_startLine(1),
+    m_hasHeader(true),
+    m_ignoreNonNumeric(false),
+    m_rowCount(0),
+    m_indexedBytes(0),
+    m_dataOffset(-1)
+{
+    setCacheBudget(kDefaultCacheBudget);
+}
+
+void SparseRowIndex::setParser(const CSVReader& settings)
+{
+    m_filePath = settings.getFilePath();
+    m_tokenizer = LineTokenizer(settings);
+    // Everything that changes how lines are read; an index is only reused
+    // with the same settings
+    QJsonObject parser = settings.toJson();
+    parser.remove("filePath");
+    m_parserKey = QJsonDocument(parser).toJson(QJsonDocument::Compact);
+    m_startLine = settings.getStartLine();
+    m_hasHeader = settings.getHasHeader();
+    m_ignoreNonNumeric = settings.getIgnoreNonNumeric();
+    clear();
+}
+
+void SparseRowIndex::clear()
+{
+    m_headers.clear();
+    m_blocks.clear();
+    m_ascending.clear();
+    m_rowCount = 0;
+    m_indexedBytes = 0;
+    m_dataOffset = -1;
+    m_signature.clear();
+    m_cache.clear();
+    m_file.close();
+}
+
+void SparseRowIndex::setCacheBudget(qint64 bytes)
+{
+    // Costs are counted in KiB so that budgets above 2 GiB still fit an int
+    m_cache.setMaxCost(int(qMin<qint64>(bytes / 1024, std::numeric_limits<int>::max())));
+}
+
+QString SparseRowIndex::indexPath() const
+{
+    return m_filePath + ".rtplotter.idx";
+}
+
+QByteArray SparseRowIndex::fileSignature(QFile& file) const
+{
+    if (!file.seek(0)) return QByteArray();
+    return QCryptographicHash::hash(file.read(qMin(kSignatureBytes, m_indexedBytes)), QCryptographicHash::Md5);
+}
+
+bool SparseRowIndex::isAscending(int column) const
+{
+    return column >= 0 && column < m_ascending.size() && m_ascending.at(column);
+}
+
+qint64 SparseRowIndex::getBlockRowCount(int first, int last) const
+{
+    qint64 rows = 0;
+    for (int b = qMax(0, first); b <= last && b < m_blocks.size(); ++b) {
+        rows += m_blocks.at(b).rowCount;
+    }
+    return rows;
+}
+
+bool SparseRowIndex::build(const std::function<bool(qint64, qint64)>& progress)
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open file:" << m_filePath;
+        return false;
+    }
+    const qint64 fileSize = file.size();
+
+    // A shorter or rewritten file invalidates everything indexed so far
+    if (fileSize < m_indexedBytes || (m_indexedBytes > 0 && fileSignature(file) != m_signature)) {
+        qDebug() << "SparseRowIndex: file changed, rebuilding" << m_filePath;
+        m_blocks.clear();
+        m_headers.clear();
+        m_ascending.clear();
+        m_rowCount = 0;
+        m_indexedBytes = 0;
+        m_dataOffset = -1;
+    }
+    m_cache.clear();
+
+    // The last block may end on a partial line or hold fewer rows: rescan it
+    qint64 position = 0;
+    if (!m_blocks.isEmpty()) {
+        const Block& tail = m_blocks.last();
+        position = tail.offset;
+        m_rowCount -= tail.rowCount;
+        m_blocks.removeLast();
+    } else if (m_dataOffset >= 0) {
+        position = m_dataOffset;
+    }
+
+    int columnCount = m_headers.size();
+    QVector<double> last(columnCount, -std::numeric_limits<double>::infinity());
+    if (!m_blocks.isEmpty()) {
+        // For ascending columns the block maximum is the last value
+        last = m_blocks.last().maximum;
+    }
+    int lineNumber = 0;
+    QVector<double> row(columnCount);
+
+    Block current;
+    auto startBlock = [&](qint64 offset) {
+        current = Block();
+        current.offset = offset;
+        current.firstRow = m_rowCount;
+        current.minimum = QVector<double>(columnCount, std::numeric_limits<double>::infinity());
+        current.maximum = QVector<double>(columnCount, -std::numeric_limits<double>::infinity());
+    };
+    auto sealBlock = [&](qint64 end) {
+        current.length = end - current.offset;
+        if (current.rowCount > 0) m_blocks.append(current);
+        startBlock(end);
+    };
+    auto processLine = [&](const char* begin, const char* end, qint64 lineOffset, qint64 nextOffset) {
+        if (end > begin && end[-1] == '\r') --end;
+        if (m_dataOffset < 0) {
+            // Lines up to the header (or the start line) are skipped
+            ++lineNumber;
+            if (lineNumber < m_startLine) return;
+            if (m_hasHeader && lineNumber == m_startLine) {
+                m_headers = m_tokenizer.header(begin, end);
+                m_dataOffset = nextOffset;
+                return;
+            }
+            m_dataOffset = lineOffset;
+        }
+        if (begin == end || m_tokenizer.isComment(begin, end)) return;
+        if (columnCount == 0) {
+            // Without a header, columns are named after the first data row
+            int fields = m_tokenizer.fieldCount(begin, end);
+            if (fields == 0) return;
+            for (int i = m_headers.size(); i < fields; ++i) {
+                m_headers.append(QString("Col%1").arg(i + 1));
+            }
+        }
+        if (m_ascending.isEmpty() || columnCount != m_headers.size()) {
+            columnCount = m_headers.size();
+            m_ascending = QVector<bool>(columnCount, true);
+            last = QVector<double>(columnCount, -std::numeric_limits<double>::infinity());
+            row.resize(columnCount);
+            startBlock(lineOffset);
+        }
+
+        bool isNumeric = m_tokenizer.tokenize(begin, end, row) > 0;
+        if (m_ignoreNonNumeric && !isNumeric) return;
+        // Gaps (NaN) compare false and fmax keeps the last valid value, so
+        // they leave the block extrema and the ordering untouched
+        for (int c = 0; c < columnCount; ++c) {
+            double value = row[c];
+            if (value < current.minimum[c]) current.minimum[c] = value;
+            if (value > current.maximum[c]) current.maximum[c] = value;
+            if (value < last[c]) m_ascending[c] = false;
+            last[c] = std::fmax(last[c], value);
+        }
+        ++current.rowCount;
+        ++m_rowCount;
+        if (current.rowCount == kRowsPerBlock) sealBlock(nextOffset);
+    };
+
+    startBlock(position);
+    if (!file.seek(position)) {
+        qWarning() << "Could not seek to position" << position << "in file" << m_filePath;
+        return false;
+    }
+
+    QByteArray buffer;
+    qint64 bufferOffset = position;
+    while (!file.atEnd()) {
+        QByteArray chunk = file.read(kReadChunk);
+        if (chunk.isEmpty()) break;
+        buffer.append(chunk);
+
+        const char* data = buffer.constData();
+        const char* end = data + buffer.size();
+        const char* line = data;
+        while (const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line))) {
+            qint64 lineOffset = bufferOffset + (line - data);
+            processLine(line, newline, lineOffset, lineOffset + (newline - line) + 1);
+            line = newline + 1;
+        }
+        // The unterminated remainder is carried over to the next chunk
+        qint64 consumed = line - data;
+        buffer.remove(0, int(consumed));
+        bufferOffset += consumed;
+
+        if (progress && !progress(bufferOffset, fileSize)) {
+            // Completed blocks stay valid; the next build resumes after them
+            if (m_blocks.isEmpty()) {
+                m_headers.clear();
+                m_ascending.clear();
+                m_rowCount = 0;
+                m_indexedBytes = 0;
+                m_dataOffset = -1;
+            } else {
+                m_rowCount = m_blocks.last().firstRow + m_blocks.last().rowCount;
+                m_indexedBytes = m_blocks.last().offset + m_blocks.last().length;
+            }
+            m_signature = fileSignature(file);
+            return false;
+        }
+    }
+    if (!buffer.isEmpty()) {
+        processLine(buffer.constData(), buffer.constData() + buffer.size(), bufferOffset, fileSize);
+    }
+    sealBlock(fileSize);
+
+    m_indexedBytes = fileSize;
+    m_signature = fileSignature(file);
+    qDebug() << "SparseRowIndex:" << m_rowCount << "rows in" << m_blocks.size() << "blocks for" << m_filePath;
+    return true;
+}
+
+bool SparseRowIndex::save() const
+{
+    QFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write index:" << indexPath();
+        return false;
+    }
+    QDataStream out(&file);
+    out << kIndexMagic << kIndexVersion;
+    out << m_parserKey;
+    out << m_headers << m_ascending << m_rowCount << m_indexedBytes << m_dataOffset << m_signature;
+    out << qint32(m_blocks.size());
+    for (const Block& block : m_blocks) {
+        out << block.offset << block.length << block.firstRow << qint32(block.rowCount) << block.minimum << block.maximum;
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+bool SparseRowIndex::load()
+{
+    clear();
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != kIndexMagic || version != kIndexVersion) return false;
+
+    QByteArray parserKey;
+    in >> parserKey;
+    if (parserKey != m_parserKey) {
+        qDebug() << "SparseRowIndex: index built with other parser settings, ignoring" << indexPath();
+        return false;
+    }
+
+    qint32 blockCount = 0;
+    in >> m_headers >> m_ascending >> m_rowCount >> m_indexedBytes >> m_dataOffset >> m_signature >> blockCount;
+    m_blocks.resize(qMax(0, blockCount));
+    for (Block& block : m_blocks) {
+        qint32 rowCount = 0;
+        in >> block.offset >> block.length >> block.firstRow >> rowCount >> block.minimum >> block.maximum;
+        block.rowCount = rowCount;
+    }
+    if (in.status() != QDataStream::Ok) {
+        clear();
+        return false;
+    }
+
+    // The index only applies to the file it was built from
+    QFile data(m_filePath);
+    if (!data.open(QIODevice::ReadOnly) || data.size() < m_indexedBytes || fileSignature(data) != m_signature) {
+        qDebug() << "SparseRowIndex: stale index" << indexPath();
+        clear();
+        return false;
+    }
+    return true;
+}
+
+const SparseRowIndex::DecodedBlock* SparseRowIndex::decode(int block)
+{
+    if (DecodedBlock* cached = m_cache.object(block)) return cached;
+
+    if (!m_file.isOpen()) {
+        m_file.setFileName(m_filePath);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Could not open file:" << m_filePath;
+            return nullptr;
+        }
+    }
+    const Block& info = m_blocks.at(block);
+    if (!m_file.seek(info.offset)) return nullptr;
+    QByteArray bytes = m_file.read(info.length);
+
+    const int columnCount = m_headers.size();
+    DecodedBlock* decoded = new DecodedBlock;
+    decoded->columns = QVector<QVector<double>>(columnCount);
+    for (QVector<double>& column : decoded->columns) column.reserve(info.rowCount);
+    QVector<double> row(columnCount);
+
+    const char* line = bytes.constData();
+    const char* end = line + bytes.size();
+    while (line < end) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        const char* stop = newline ? newline : end;
+        const char* lineEnd = (stop > line && stop[-1] == '\r') ? stop - 1 : stop;
+        if (lineEnd > line && !m_tokenizer.isComment(line, lineEnd)) {
+            bool isNumeric = m_tokenizer.tokenize(line, lineEnd, row) > 0;
+            if (!m_ignoreNonNumeric || isNumeric) {
+                for (int c = 0; c < columnCount; ++c) decoded->columns[c].append(row[c]);
+            }
+        }
+        line = stop + 1;
+    }
+
+    // A block larger than the whole budget still has to be returned once
+    int cost = int(qMax<qint64>(1, qint64(info.rowCount) * columnCount * qint64(sizeof(double)) / 1024));
+    if (cost > m_cache.maxCost()) m_cache.setMaxCost(cost);
+    m_cache.insert(block, decoded, cost);
+    return decoded;
+}
+
+void SparseRowIndex::blocksInRange(int keyColumn, double lower, double upper, int* first, int* last) const
+{
+    const int count = m_blocks.size();
+    *first = 0;
+    *last = count - 1;
+    if (count == 0 || !isAscending(keyColumn)) return;
+
+    auto begin = std::lower_bound(m_blocks.constBegin(), m_blocks.constEnd(), lower, [keyColumn](const Block& block, double key) {
+        return block.maximum.at(keyColumn) < key;
+    });
+    auto end = std::upper_bound(m_blocks.constBegin(), m_blocks.constEnd(), upper, [keyColumn](double key, const Block& block) {
+        return key < block.minimum.at(keyColumn);
+    });
+    // One extra block on each side so that lines run to the plot edges
+    *first = qBound(0, int(begin - m_blocks.constBegin()) - 1, count - 1);
+    *last = qBound(*first, int(end - m_blocks.constBegin()), count - 1);
+}
+
+void SparseRowIndex::envelope(int keyColumn, int column, int first, int last, int buckets, QVector<double>& x, QVector<double>& y) const
+{
+    x.clear();
+    y.clear();
+    first = qMax(0, first);
+    last = qMin(last, m_blocks.size() - 1);
+    if (first > last || keyColumn < 0 || column < 0 || column >= m_headers.size()) return;
+
+    const int blocks = last - first + 1;
+    const int perBucket = (blocks + qMax(1, buckets) - 1) / qMax(1, buckets);
+    x.reserve(2 * (blocks / perBucket + 1));
+    y.reserve(x.capacity());
+    for (int b = first, bucket = 0; b <= last; b += perBucket, ++bucket) {
+        const int stop = qMin(last, b + perBucket - 1);
+        double minimum = m_blocks.at(b).minimum.at(column);
+        double maximum = m_blocks.at(b).maximum.at(column);
+        for (int i = b + 1; i <= stop; ++i) {
+            minimum = qMin(minimum, m_blocks.at(i).minimum.at(column));
+            maximum = qMax(maximum, m_blocks.at(i).maximum.at(column));
+        }
+        // A bucket of gaps only keeps its initial +inf/-inf; it is drawn as a gap
+        if (minimum > maximum) minimum = maximum = std::numeric_limits<double>::quiet_NaN();
+        // Both extrema at the bucket centre; alternating their order keeps
+        // the connecting lines inside the band
+        double key = 0.5 * (m_blocks.at(b).minimum.at(keyColumn) + m_blocks.at(stop).maximum.at(keyColumn));
+        x << key << key;
+        if (bucket % 2 == 0) y << minimum << maximum;
+        else y << maximum << minimum;
+    }
+}
+
+void SparseRowIndex::rows(int keyColumn, int column, int first, int last, QVector<double>& x, QVector<double>& y)
+{
+    x.clear();
+    y.clear();
+    first = qMax(0, first);
+    last = qMin(last, m_blocks.size() - 1);
+    if (first > last || keyColumn < 0 || column < 0 || column >= m_headers.size()) return;
+
+    qint64 total = getBlockRowCount(first, last);
+    x.reserve(total);
+    y.reserve(total);
+    for (int b = first; b <= last; ++b) {
+        const DecodedBlock* decoded = decode(b);
+        if (!decoded) break;
+        x += decoded->columns.at(keyColumn);
+        y += decoded->columns.at(column);
+    }
+}
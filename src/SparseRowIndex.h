@@ -0,0 +1,95 @@
+#ifndef SPARSEROWINDEX_H
+#define SPARSEROWINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QCache>
+#include <QFile>
+#include <functional>
+#include "LineTokenizer.h"
+
+class CSVReader;
+
+// Out-of-core view of a delimited file. One streaming pass records, every
+// kRowsPerBlock rows, the byte range of the block and the min/max of every
+// column (the LOD summary); the samples themselves stay on disk. Blocks are
+// decoded on demand through an LRU cache with a byte budget, so memory is
+// bounded by the cache plus 16 bytes per column per block.
+class SparseRowIndex
+{
+public:
+    static const int kRowsPerBlock = 8192;
+
+    SparseRowIndex();
+
+    // File path and parser settings (line format, comments, start line,
+    // header, non-numeric rows)
+    void setParser(const CSVReader& settings);
+    QString getFilePath() const { return m_filePath; }
+    void clear();
+
+    // Reads the `<file>.rtplotter.idx` sidecar; fails if it was built with
+    // other settings or the file was replaced
+    bool load();
+    bool save() const;
+    // Indexes the file from the end of the last complete block, so a grown
+    // file is only scanned from there. `progress(done, total)` returning
+    // false aborts the pass.
+    bool build(const std::function<bool(qint64, qint64)>& progress = nullptr);
+
+    QStringList getHeaders() const { return m_headers; }
+    int getColumnCount() const { return m_headers.size(); }
+    qint64 getRowCount() const { return m_rowCount; }
+    int getBlockCount() const { return m_blocks.size(); }
+    qint64 getIndexedBytes() const { return m_indexedBytes; }
+    // True when the column never decreases, i.e. it can serve as a key
+    bool isAscending(int column) const;
+    qint64 getBlockRowCount(int first, int last) const;
+
+    // Blocks whose `keyColumn` values may fall inside [lower, upper]. Keys
+    // must be ascending; otherwise every block is returned.
+    void blocksInRange(int keyColumn, double lower, double upper, int* first, int* last) const;
+    // Min/max envelope of `column` over blocks [first, last], merged into at
+    // most `buckets` key intervals (two points each)
+    void envelope(int keyColumn, int column, int first, int last, int buckets, QVector<double>& x, QVector<double>& y) const;
+    // Full-resolution samples of blocks [first, last]
+    void rows(int keyColumn, int column, int first, int last, QVector<double>& x, QVector<double>& y);
+
+    void setCacheBudget(qint64 bytes);
+
+private:
+    struct Block {
+        qint64 offset = 0;   // byte offset of the first line
+        qint64 length = 0;   // bytes up to the next block
+        qint64 firstRow = 0;
+        int rowCount = 0;
+        QVector<double> minimum;
+        QVector<double> maximum;
+    };
+    struct DecodedBlock {
+        QVector<QVector<double>> columns;
+    };
+
+    QString m_filePath;
+    LineTokenizer m_tokenizer;
+    QByteArray m_parserKey;  // parser settings the index was built with
+    int m_startLine;
+    bool m_hasHeader;
+    bool m_ignoreNonNumeric;
+    QStringList m_headers;
+    QVector<Block> m_blocks;
+    QVector<bool> m_ascending;
+    qint64 m_rowCount;
+    qint64 m_indexedBytes;
+    qint64 m_dataOffset;     // first byte after the header and skipped lines
+    QByteArray m_signature;  // hash of the first bytes, to detect a replaced file
+    QCache<int, DecodedBlock> m_cache;
+    QFile m_file;
+
+    QString indexPath() const;
+    QByteArray fileSignature(QFile& file) const;
+    const DecodedBlock* decode(int block);
+};
+
+#endif // SPARSEROWINDEX_H
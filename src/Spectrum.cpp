@@ -0,0 +1,183 @@
+#include "Spectrum.h"
+#include "RollingWindow.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const double kPi = 3.14159265358979323846;
+}
+
+int FFT::nextPowerOfTwo(int n)
+{
+    int size = 1;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+void FFT::setSize(int size)
+{
+    m_size = size > 1 ? nextPowerOfTwo(size) : 0;
+    m_reversed.clear();
+    m_twiddles.clear();
+    if (m_size == 0) return;
+
+    int bits = 0;
+    while ((1 << bits) < m_size) ++bits;
+    m_reversed.resize(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        m_reversed[i] = r;
+    }
+    m_twiddles.resize(m_size / 2);
+    for (int k = 0; k < m_size / 2; ++k) {
+        m_twiddles[k] = std::polar(1.0, -2.0 * kPi * k / m_size);
+    }
+}
+
+void FFT::transform(QVector<std::complex<double>>& data) const
+{
+    if (m_size == 0 || data.size() != m_size) return;
+    std::complex<double>* a = data.data();
+    for (int i = 0; i < m_size; ++i) {
+        int j = m_reversed[i];
+        if (i < j) std::swap(a[i], a[j]);
+    }
+    for (int length = 2; length <= m_size; length <<= 1) {
+        int half = length / 2;
+        int stride = m_size / length;
+        for (int start = 0; start < m_size; start += length) {
+            for (int k = 0; k < half; ++k) {
+                std::complex<double> t = m_twiddles[k * stride] * a[start + k + half];
+                a[start + k + half] = a[start + k] - t;
+                a[start + k] += t;
+            }
+        }
+    }
+}
+
+WelchEstimator::WelchEstimator() :
+    m_windowPower(0.0),
+    m_fill(0),
+    m_next(0),
+    m_count(0)
+{
+    configure(1024, 8);
+}
+
+void WelchEstimator::configure(int segmentLength, int averagedSegments)
+{
+    m_fft.setSize(qMax(8, segmentLength));
+    const int n = m_fft.size();
+    m_window.resize(n);
+    m_windowPower = 0.0;
+    for (int i = 0; i < n; ++i) {
+        m_window[i] = 0.5 - 0.5 * std::cos(2.0 * kPi * i / n);
+        m_windowPower += m_window[i] * m_window[i];
+    }
+    m_periodograms = QVector<QVector<double>>(qMax(1, averagedSegments));
+    m_scratch.resize(n);
+    reset();
+}
+
+void WelchEstimator::reset()
+{
+    m_pending = QVector<double>(m_fft.size(), 0.0);
+    m_fill = 0;
+    for (QVector<double>& periodogram : m_periodograms) {
+        periodogram.clear();
+    }
+    m_sum = QVector<double>(m_fft.size() / 2 + 1, 0.0);
+    m_next = 0;
+    m_count = 0;
+}
+
+int WelchEstimator::append(const double* values, int count)
+{
+    const int n = m_fft.size();
+    int completed = 0;
+    while (count > 0) {
+        int take = qMin(count, n - m_fill);
+        std::memcpy(m_pending.data() + m_fill, values, take * sizeof(double));
+        m_fill += take;
+        values += take;
+        count -= take;
+        if (m_fill == n) {
+            processSegment();
+            ++completed;
+            // Keep the second half as the start of the next segment
+            std::memmove(m_pending.data(), m_pending.constData() + hop(), (n - hop()) * sizeof(double));
+            m_fill = n - hop();
+        }
+    }
+    return completed;
+}
+
+void WelchEstimator::processSegment()
+{
+    const int n = m_fft.size();
+    const double* samples = m_pending.constData();
+    // Gaps (NaN) are replaced by the mean of the valid samples, i.e. they
+    // contribute zero once the mean is removed
+    double mean = 0.0;
+    int valid = 0;
+    for (int i = 0; i < n; ++i) {
+        mean += valueOrZero(samples[i]);
+        valid += samples[i] == samples[i];
+    }
+    mean = valid > 0 ? mean / valid : 0.0;
+    for (int i = 0; i < n; ++i) {
+        m_scratch[i] = std::complex<double>(valueOrZero(samples[i] - mean) * m_window[i], 0.0);
+    }
+    m_fft.transform(m_scratch);
+
+    // Evict the oldest periodogram from the running sum
+    QVector<double>& slot = m_periodograms[m_next];
+    const int bins = n / 2 + 1;
+    if (!slot.isEmpty()) {
+        for (int k = 0; k < bins; ++k) m_sum[k] -= slot[k];
+    } else {
+        slot.resize(bins);
+        ++m_count;
+    }
+    for (int k = 0; k < bins; ++k) {
+        slot[k] = std::norm(m_scratch[k]);
+        m_sum[k] += slot[k];
+    }
+    if (++m_next == m_periodograms.size()) {
+        m_next = 0;
+        // Re-sum once per cycle to bound rounding drift
+        if (m_count == m_periodograms.size()) {
+            m_sum.fill(0.0);
+            for (const QVector<double>& periodogram : m_periodograms) {
+                for (int k = 0; k < bins; ++k) m_sum[k] += periodogram[k];
+            }
+        }
+    }
+}
+
+QVector<double> WelchEstimator::density(double sampleSpacing) const
+{
+    const int n = m_fft.size();
+    const int bins = n / 2 + 1;
+    QVector<double> psd(bins, 0.0);
+    if (m_count == 0 || m_windowPower <= 0.0) return psd;
+    // One-sided: every bin except DC and Nyquist carries both signs
+    double scale = sampleSpacing / (m_windowPower * m_count);
+    for (int k = 0; k < bins; ++k) {
+        psd[k] = m_sum[k] * scale * ((k == 0 || k == n / 2) ? 1.0 : 2.0);
+    }
+    return psd;
+}
+
+QVector<double> WelchEstimator::frequencies(double sampleSpacing) const
+{
+    const int n = m_fft.size();
+    QVector<double> f(n / 2 + 1);
+    for (int k = 0; k < f.size(); ++k) {
+        f[k] = k / (n * sampleSpacing);
+    }
+    return f;
+}
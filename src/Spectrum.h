@@ -0,0 +1,67 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <QVector>
+#include <complex>
+
+// In-place iterative radix-2 FFT. The size must be a power of two; the bit
+// reversal table and twiddle factors are computed once per size.
+class FFT
+{
+public:
+    explicit FFT(int size = 0) { setSize(size); }
+
+    void setSize(int size);
+    int size() const { return m_size; }
+    void transform(QVector<std::complex<double>>& data) const;
+
+    static int nextPowerOfTwo(int n);
+
+private:
+    int m_size = 0;
+    QVector<int> m_reversed;
+    QVector<std::complex<double>> m_twiddles;
+};
+
+// Welch power spectral density over a sliding window of segments. Samples
+// are buffered until a segment fills (50 % overlap, Hann window, mean
+// removed); each completed segment costs one FFT, and the average over the
+// last `averagedSegments` periodograms is kept as a running sum, so the cost
+// never depends on the history length.
+class WelchEstimator
+{
+public:
+    WelchEstimator();
+
+    void configure(int segmentLength, int averagedSegments);
+    void reset();
+    // Returns the number of segments completed by these samples
+    int append(const double* values, int count);
+
+    int segmentLength() const { return m_fft.size(); }
+    int hop() const { return m_fft.size() / 2; }
+    int segmentCount() const { return m_count; }
+    // Samples needed to fill the whole averaging window
+    int span() const { return segmentLength() + (m_periodograms.size() - 1) * hop(); }
+
+    // One-sided PSD (N/2+1 bins) and matching frequencies, in units of
+    // 1 / sampleSpacing
+    QVector<double> density(double sampleSpacing) const;
+    QVector<double> frequencies(double sampleSpacing) const;
+
+private:
+    FFT m_fft;
+    QVector<double> m_window;
+    double m_windowPower;
+    QVector<double> m_pending;
+    int m_fill;
+    QVector<QVector<double>> m_periodograms;
+    QVector<double> m_sum;
+    int m_next;
+    int m_count;
+    QVector<std::complex<double>> m_scratch;
+
+    void processSegment();
+};
+
+#endif // SPECTRUM_H
@@ -0,0 +1,197 @@
+#include "SpectrumPanel.h"
+#include "CSVReader.h"
+#include "qcustomplot.h"
+#include <QComboBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+void SpectrumWorker::configure(int generation, int segmentLength, int averagedSegments)
+{
+    m_generation = generation;
+    m_estimator.configure(segmentLength, averagedSegments);
+}
+
+void SpectrumWorker::appendSamples(int generation, const QVector<double>& samples, double sampleSpacing)
+{
+    // Batches queued before a reconfiguration are dropped
+    if (generation != m_generation) return;
+    if (m_estimator.append(samples.constData(), samples.size()) > 0) {
+        emit spectrumReady(generation, m_estimator.frequencies(sampleSpacing), m_estimator.density(sampleSpacing), m_estimator.segmentCount());
+    }
+}
+
+SpectrumPanel::SpectrumPanel(QWidget *parent) :
+    QDockWidget(tr("Spectrum"), parent),
+    m_reader(nullptr),
+    m_keyIndex(-1),
+    m_columnIndex(-1),
+    m_firstRow(0),
+    m_sentRows(0),
+    m_generation(0),
+    m_stale(false)
+{
+    QWidget* content = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(content);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    QHBoxLayout* settingsLayout = new QHBoxLayout();
+    m_columnComboBox = new QComboBox(content);
+    settingsLayout->addWidget(m_columnComboBox);
+    settingsLayout->addWidget(new QLabel(tr("Segment:"), content));
+    m_segmentComboBox = new QComboBox(content);
+    for (int n = 64; n <= 65536; n *= 2) {
+        m_segmentComboBox->addItem(QString::number(n), n);
+    }
+    m_segmentComboBox->setCurrentIndex(m_segmentComboBox->findData(1024));
+    settingsLayout->addWidget(m_segmentComboBox);
+    settingsLayout->addWidget(new QLabel(tr("Averaged:"), content));
+    m_averageSpinBox = new QSpinBox(content);
+    m_averageSpinBox->setRange(1, 256);
+    m_averageSpinBox->setValue(8);
+    settingsLayout->addWidget(m_averageSpinBox);
+    m_logCheckBox = new QCheckBox(tr("Log scale"), content);
+    m_logCheckBox->setChecked(true);
+    settingsLayout->addWidget(m_logCheckBox);
+    settingsLayout->addStretch();
+    layout->addLayout(settingsLayout);
+
+    m_plot = new QCustomPlot(content);
+    m_plot->setInteraction(QCP::iRangeDrag, true);
+    m_plot->setInteraction(QCP::iRangeZoom, true);
+    m_plot->addGraph();
+    m_plot->xAxis->setLabel(tr("Frequency"));
+    m_plot->yAxis->setLabel(tr("PSD"));
+    m_plot->yAxis->setScaleType(QCPAxis::stLogarithmic);
+    m_plot->yAxis->setTicker(QSharedPointer<QCPAxisTickerLog>(new QCPAxisTickerLog));
+    m_plot->setMinimumHeight(200);
+    layout->addWidget(m_plot);
+    setWidget(content);
+
+    m_worker = new SpectrumWorker();
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(this, &SpectrumPanel::configureWorker, m_worker, &SpectrumWorker::configure);
+    connect(this, &SpectrumPanel::samplesAvailable, m_worker, &SpectrumWorker::appendSamples);
+    connect(m_worker, &SpectrumWorker::spectrumReady, this, &SpectrumPanel::onSpectrumReady);
+    m_thread.start();
+
+    connect(m_columnComboBox, &QComboBox::currentIndexChanged, this, &SpectrumPanel::onSettingsChanged);
+    connect(m_segmentComboBox, &QComboBox::currentIndexChanged, this, &SpectrumPanel::onSettingsChanged);
+    connect(m_averageSpinBox, &QSpinBox::valueChanged, this, &SpectrumPanel::onSettingsChanged);
+    connect(m_logCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        m_plot->yAxis->setScaleType(checked ? QCPAxis::stLogarithmic : QCPAxis::stLinear);
+        if (checked) m_plot->yAxis->setTicker(QSharedPointer<QCPAxisTickerLog>(new QCPAxisTickerLog));
+        else m_plot->yAxis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
+        m_plot->rescaleAxes();
+        m_plot->replot(QCustomPlot::rpQueuedReplot);
+    });
+    connect(this, &QDockWidget::visibilityChanged, this, &SpectrumPanel::onVisibilityChanged);
+}
+
+SpectrumPanel::~SpectrumPanel()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void SpectrumPanel::setSource(const CSVReader* reader, const QStringList& columns, const QString& defaultColumn, const QString& keyColumn)
+{
+    m_reader = reader;
+    m_keyIndex = reader ? reader->getColumnIndex(keyColumn) : -1;
+
+    // Keep the current selection when it still exists
+    QString current = m_columnComboBox->currentText();
+    {
+        QSignalBlocker blocker(m_columnComboBox);
+        m_columnComboBox->clear();
+        m_columnComboBox->addItems(columns);
+        int index = columns.indexOf(current);
+        if (index < 0) index = columns.indexOf(defaultColumn);
+        m_columnComboBox->setCurrentIndex(qMax(0, index));
+    }
+    m_plot->xAxis->setLabel(keyColumn.isEmpty() ? tr("Frequency (1/sample)") : tr("Frequency (1/%1)").arg(keyColumn));
+    restart();
+}
+
+void SpectrumPanel::appendRows(int firstRow)
+{
+    if (!m_reader) return;
+    if (firstRow == 0) {
+        restart();
+        return;
+    }
+    // While hidden nothing is computed; the tail is re-read when shown again
+    if (!isVisible()) {
+        m_stale = true;
+        return;
+    }
+    send(m_sentRows, m_reader->getRowCount());
+}
+
+void SpectrumPanel::onSettingsChanged()
+{
+    restart();
+}
+
+void SpectrumPanel::onVisibilityChanged(bool visible)
+{
+    if (visible && m_stale) restart();
+}
+
+void SpectrumPanel::restart()
+{
+    ++m_generation;
+    m_plot->graph(0)->data()->clear();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+    m_columnIndex = m_reader ? m_reader->getColumnIndex(m_columnComboBox->currentText()) : -1;
+    m_sentRows = 0;
+    if (!isVisible()) {
+        m_stale = true;
+        return;
+    }
+    m_stale = false;
+
+    int segmentLength = m_segmentComboBox->currentData().toInt();
+    int averaged = m_averageSpinBox->value();
+    emit configureWorker(m_generation, segmentLength, averaged);
+    if (!m_reader || m_columnIndex < 0) return;
+
+    // Only the rows covered by the averaging window are needed
+    int rowCount = m_reader->getRowCount();
+    int span = segmentLength + (averaged - 1) * (segmentLength / 2);
+    m_firstRow = qMax(0, rowCount - span);
+    m_sentRows = m_firstRow;
+    send(m_firstRow, rowCount);
+}
+
+double SpectrumPanel::sampleSpacing(int lastRow) const
+{
+    // Mean spacing of the key column over the rows fed since the restart
+    if (m_keyIndex < 0 || lastRow - m_firstRow < 2) return 1.0;
+    const QVector<double>& x = m_reader->getColumn(m_keyIndex);
+    if (x.size() < lastRow) return 1.0;
+    double spacing = (x[lastRow - 1] - x[m_firstRow]) / (lastRow - 1 - m_firstRow);
+    return spacing > 0.0 ? spacing : 1.0;
+}
+
+void SpectrumPanel::send(int firstRow, int lastRow)
+{
+    if (m_columnIndex < 0 || firstRow >= lastRow) return;
+    const QVector<double>& values = m_reader->getColumn(m_columnIndex);
+    if (values.size() < lastRow) return;
+    emit samplesAvailable(m_generation, values.mid(firstRow, lastRow - firstRow), sampleSpacing(lastRow));
+    m_sentRows = lastRow;
+}
+
+void SpectrumPanel::onSpectrumReady(int generation, const QVector<double>& frequencies, const QVector<double>& density, int segments)
+{
+    if (generation != m_generation) return;
+    // Skip the DC bin, which is zero after mean removal
+    m_plot->graph(0)->setData(frequencies.mid(1), density.mid(1), true);
+    m_plot->graph(0)->setName(tr("%1 (%2 segments)").arg(m_columnComboBox->currentText()).arg(segments));
+    m_plot->rescaleAxes();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
@@ -0,0 +1,76 @@
+#ifndef SPECTRUMPANEL_H
+#define SPECTRUMPANEL_H
+
+#include <QDockWidget>
+#include <QThread>
+#include <QVector>
+#include <QStringList>
+#include "Spectrum.h"
+
+class QComboBox;
+class QSpinBox;
+class QCheckBox;
+class QCustomPlot;
+class CSVReader;
+
+// Runs the Welch estimator off the GUI thread. Samples arrive in batches and
+// a spectrum is published only when a new segment has been completed.
+class SpectrumWorker : public QObject
+{
+    Q_OBJECT
+public slots:
+    void configure(int generation, int segmentLength, int averagedSegments);
+    void appendSamples(int generation, const QVector<double>& samples, double sampleSpacing);
+
+signals:
+    void spectrumReady(int generation, const QVector<double>& frequencies, const QVector<double>& density, int segments);
+
+private:
+    WelchEstimator m_estimator;
+    int m_generation = 0;
+};
+
+// Dockable PSD view of one column, drawn in its own QCustomPlot
+class SpectrumPanel : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit SpectrumPanel(QWidget *parent = nullptr);
+    ~SpectrumPanel();
+
+    // `keyColumn` gives the sample spacing; without it frequencies are per sample
+    void setSource(const CSVReader* reader, const QStringList& columns, const QString& defaultColumn, const QString& keyColumn);
+    // Forwards rows appended since the last call; firstRow == 0 restarts
+    void appendRows(int firstRow);
+
+signals:
+    void configureWorker(int generation, int segmentLength, int averagedSegments);
+    void samplesAvailable(int generation, const QVector<double>& samples, double sampleSpacing);
+
+private slots:
+    void onSettingsChanged();
+    void onSpectrumReady(int generation, const QVector<double>& frequencies, const QVector<double>& density, int segments);
+    void onVisibilityChanged(bool visible);
+
+private:
+    const CSVReader* m_reader;
+    int m_keyIndex;
+    int m_columnIndex;
+    int m_firstRow;     // first row sent since the last restart
+    int m_sentRows;
+    int m_generation;
+    bool m_stale;
+    QThread m_thread;
+    SpectrumWorker* m_worker;
+    QComboBox* m_columnComboBox;
+    QComboBox* m_segmentComboBox;
+    QSpinBox* m_averageSpinBox;
+    QCheckBox* m_logCheckBox;
+    QCustomPlot* m_plot;
+
+    void restart();
+    void send(int firstRow, int lastRow);
+    double sampleSpacing(int lastRow) const;
+};
+
+#endif // SPECTRUMPANEL_H
@@ -0,0 +1,220 @@
+#include "StatisticsPanel.h"
+#include "CSVReader.h"
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <cmath>
+
+namespace {
+    enum StatisticsColumn { NameColumn, CountColumn, MinColumn, MaxColumn, MeanColumn, StdDevColumn, LastColumn, WindowMeanColumn, StatisticsColumnCount };
+
+    QString formatValue(double value)
+    {
+        return std::isnan(value) ? QStringLiteral("-") : QString::number(value, 'g', 6);
+    }
+}
+
+StatisticsPanel::StatisticsPanel(QWidget *parent) :
+    QDockWidget(tr("Statistics"), parent),
+    m_reader(nullptr),
+    m_keyIndex(-1),
+    m_consumedRows(0),
+    m_dirty(false)
+{
+    QWidget* content = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(content);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    QHBoxLayout* windowLayout = new QHBoxLayout();
+    windowLayout->addWidget(new QLabel(tr("Window:"), content));
+    m_windowModeComboBox = new QComboBox(content);
+    m_windowModeComboBox->addItem(tr("Last N rows"));
+    m_windowModeComboBox->addItem(tr("Last X span"));
+    windowLayout->addWidget(m_windowModeComboBox);
+    m_windowSpinBox = new QDoubleSpinBox(content);
+    m_windowSpinBox->setRange(1.0, 1e12);
+    m_windowSpinBox->setDecimals(3);
+    m_windowSpinBox->setValue(100.0);
+    windowLayout->addWidget(m_windowSpinBox);
+    windowLayout->addStretch();
+    layout->addLayout(windowLayout);
+
+    m_table = new QTableWidget(0, StatisticsColumnCount, content);
+    m_table->setHorizontalHeaderLabels({tr("Column"), tr("Count"), tr("Min"), tr("Max"), tr("Mean"), tr("Std dev"), tr("Last"), tr("Window mean")});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    layout->addWidget(m_table);
+    setWidget(content);
+
+    connect(m_windowModeComboBox, &QComboBox::currentIndexChanged, this, &StatisticsPanel::onWindowSettingsChanged);
+    connect(m_windowSpinBox, &QDoubleSpinBox::valueChanged, this, &StatisticsPanel::onWindowSettingsChanged);
+
+    // The table is redrawn at most twice a second, whatever the append rate
+    m_refreshTimer.setInterval(500);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &StatisticsPanel::refresh);
+    m_refreshTimer.start();
+    connect(this, &QDockWidget::visibilityChanged, this, &StatisticsPanel::refresh);
+}
+
+void StatisticsPanel::setRefreshInterval(int msec)
+{
+    m_refreshTimer.setInterval(msec);
+}
+
+void StatisticsPanel::setColumns(const CSVReader* reader, const QStringList& columns, const QString& keyColumn)
+{
+    m_reader = reader;
+    m_columns.clear();
+    for (const QString& name : columns) {
+        int index = reader ? reader->getColumnIndex(name) : -1;
+        if (index < 0) continue;
+        TrackedColumn column;
+        column.name = name;
+        column.index = index;
+        m_columns.append(column);
+    }
+    m_keyIndex = reader ? reader->getColumnIndex(keyColumn) : -1;
+    rebuildTable();
+    resetAccumulators();
+    if (m_reader) {
+        consume(0, m_reader->getRowCount());
+    }
+}
+
+void StatisticsPanel::clear()
+{
+    m_reader = nullptr;
+    m_columns.clear();
+    m_keyIndex = -1;
+    m_consumedRows = 0;
+    rebuildTable();
+}
+
+void StatisticsPanel::appendRows(int firstRow)
+{
+    if (!m_reader) return;
+    if (firstRow == 0 || m_reader->getRowCount() < m_consumedRows) {
+        resetAccumulators();
+    }
+    consume(m_consumedRows, m_reader->getRowCount());
+}
+
+bool StatisticsPanel::useKeyWindow() const
+{
+    return m_windowModeComboBox->currentIndex() == 1 && m_keyIndex >= 0;
+}
+
+void StatisticsPanel::resetAccumulators()
+{
+    for (TrackedColumn& column : m_columns) {
+        column.stats = RunningStatistics();
+        column.window.reset();
+    }
+    m_consumedRows = 0;
+    m_dirty = true;
+}
+
+void StatisticsPanel::consume(int firstRow, int lastRow)
+{
+    if (firstRow >= lastRow) return;
+
+    const bool keyWindow = useKeyWindow();
+    const double span = m_windowSpinBox->value();
+    const double* x = keyWindow ? m_reader->getColumn(m_keyIndex).constData() : nullptr;
+    // Rows that can no longer fall in a row-count window are not pushed at all
+    const int windowStart = keyWindow ? firstRow : qMax(firstRow, lastRow - static_cast<int>(span));
+
+    // Column-major: each accumulator streams over one contiguous column
+    for (TrackedColumn& column : m_columns) {
+        const QVector<double>& values = m_reader->getColumn(column.index);
+        if (values.size() < lastRow) continue;
+        const double* y = values.constData();
+        for (int r = firstRow; r < lastRow; ++r) {
+            column.stats.add(y[r]);
+        }
+        for (int r = windowStart; r < lastRow; ++r) {
+            if (keyWindow) {
+                column.window.push(x[r], y[r]);
+                column.window.expireBefore(x[r] - span);
+            } else {
+                column.window.push(r, y[r]);
+            }
+        }
+        if (!keyWindow) {
+            column.window.expireBefore(lastRow - span);
+        }
+    }
+    m_consumedRows = lastRow;
+    m_dirty = true;
+}
+
+void StatisticsPanel::reseedWindows()
+{
+    // Only the trailing window is re-read; the cumulative statistics are kept
+    for (TrackedColumn& column : m_columns) {
+        column.window.reset();
+    }
+    if (!m_reader || m_consumedRows == 0) return;
+
+    const double span = m_windowSpinBox->value();
+    const double* x = useKeyWindow() ? m_reader->getColumn(m_keyIndex).constData() : nullptr;
+    int start = 0;
+    if (x) {
+        double threshold = x[m_consumedRows - 1] - span;
+        start = m_consumedRows;
+        while (start > 0 && x[start - 1] >= threshold) --start;
+    } else {
+        start = qMax(0, m_consumedRows - static_cast<int>(span));
+    }
+
+    for (TrackedColumn& column : m_columns) {
+        const QVector<double>& values = m_reader->getColumn(column.index);
+        if (values.size() < m_consumedRows) continue;
+        for (int r = start; r < m_consumedRows; ++r) {
+            column.window.push(x ? x[r] : r, values[r]);
+        }
+    }
+    m_dirty = true;
+}
+
+void StatisticsPanel::onWindowSettingsChanged()
+{
+    reseedWindows();
+    refresh();
+}
+
+void StatisticsPanel::rebuildTable()
+{
+    m_table->setRowCount(m_columns.size());
+    for (int i = 0; i < m_columns.size(); ++i) {
+        for (int c = 0; c < StatisticsColumnCount; ++c) {
+            m_table->setItem(i, c, new QTableWidgetItem());
+        }
+        m_table->item(i, NameColumn)->setText(m_columns.at(i).name);
+    }
+    m_dirty = true;
+}
+
+void StatisticsPanel::refresh()
+{
+    if (!m_dirty || !isVisible()) return;
+    m_dirty = false;
+
+    for (int i = 0; i < m_columns.size(); ++i) {
+        const TrackedColumn& column = m_columns.at(i);
+        const RunningStatistics& stats = column.stats;
+        bool empty = stats.count == 0;
+        m_table->item(i, CountColumn)->setText(QString::number(stats.count));
+        m_table->item(i, MinColumn)->setText(formatValue(stats.minimum));
+        m_table->item(i, MaxColumn)->setText(formatValue(stats.maximum));
+        m_table->item(i, MeanColumn)->setText(empty ? QStringLiteral("-") : formatValue(stats.mean));
+        m_table->item(i, StdDevColumn)->setText(empty ? QStringLiteral("-") : formatValue(stats.standardDeviation()));
+        m_table->item(i, LastColumn)->setText(formatValue(stats.last));
+        m_table->item(i, WindowMeanColumn)->setText(column.window.count() > 0 ? formatValue(column.window.mean()) : QStringLiteral("-"));
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef STATISTICSPANEL_H
+#define STATISTICSPANEL_H
+
+#include <QDockWidget>
+#include <QTimer>
+#include <QVector>
+#include <QStringList>
+#include "RollingWindow.h"
+
+class QTableWidget;
+class QComboBox;
+class QDoubleSpinBox;
+class CSVReader;
+
+// Live per-column statistics. Accumulators are fed only with the rows
+// appended since the last update, and the table is refreshed on its own
+// timer so that it never slows down plot updates.
+class StatisticsPanel : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit StatisticsPanel(QWidget *parent = nullptr);
+
+    // Tracks `columns` of `reader` and accumulates the rows already loaded
+    void setColumns(const CSVReader* reader, const QStringList& columns, const QString& keyColumn);
+    // Accumulates rows appended since the last call; firstRow == 0 means the
+    // reader was reloaded and the statistics start over
+    void appendRows(int firstRow);
+    void clear();
+    void setRefreshInterval(int msec);
+
+private slots:
+    void refresh();
+    void onWindowSettingsChanged();
+
+private:
+    struct TrackedColumn {
+        QString name;
+        int index = -1;
+        RunningStatistics stats;
+        SlidingMean window;
+    };
+
+    const CSVReader* m_reader;
+    int m_keyIndex;
+    int m_consumedRows;
+    QVector<TrackedColumn> m_columns;
+    QTableWidget* m_table;
+    QComboBox* m_windowModeComboBox;
+    QDoubleSpinBox* m_windowSpinBox;
+    QTimer m_refreshTimer;
+    bool m_dirty;
+
+    bool useKeyWindow() const;
+    void consume(int firstRow, int lastRow);
+    void resetAccumulators();
+    void reseedWindows();
+    void rebuildTable();
+};
+
+#endif // STATISTICSPANEL_H
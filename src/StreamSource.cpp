@@ -0,0 +1,170 @@
+#include "StreamSource.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+#include <cerrno>
+#include <cstring>
+
+#ifndef Q_OS_WIN
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Bytes read from the descriptor at a time
+    const int kReadBytes = 64 * 1024;
+    // Bytes waiting for the GUI thread before the reads stop
+    const int kCapacity = 16 * 1024 * 1024;
+    // Longest poll, so that close() is noticed
+    const int kPollMs = 100;
+}
+
+StreamSource::StreamSource(QObject* parent) :
+    QObject(parent),
+    m_fd(-1),
+    m_isFifo(false),
+    m_savedFlags(-1),
+    m_thread(nullptr),
+    m_received(0),
+    m_ended(false),
+    m_stopping(false)
+{
+}
+
+StreamSource::~StreamSource()
+{
+    close();
+}
+
+bool StreamSource::open(const QString& path)
+{
+    close();
+    m_error.clear();
+    m_buffer.clear();
+    m_received = 0;
+    m_ended = false;
+    m_stopping = false;
+#ifdef Q_OS_WIN
+    Q_UNUSED(path);
+    m_error = "streams are not supported on this platform";
+    return false;
+#else
+    if (path == "-") {
+        m_name = "stdin";
+        m_fd = STDIN_FILENO;
+        m_isFifo = false;
+        m_savedFlags = ::fcntl(m_fd, F_GETFL);
+        if (m_savedFlags < 0 || ::fcntl(m_fd, F_SETFL, m_savedFlags | O_NONBLOCK) < 0) {
+            m_error = QString::fromLocal8Bit(std::strerror(errno));
+            m_fd = -1;
+            return false;
+        }
+    } else {
+        struct stat info;
+        const QByteArray localPath = QFile::encodeName(path);
+        if (::stat(localPath.constData(), &info) != 0 || !S_ISFIFO(info.st_mode)) {
+            m_error = QString("%1 is not a named pipe").arg(path);
+            return false;
+        }
+        m_name = QFileInfo(path).absoluteFilePath();
+        m_isFifo = true;
+        // O_RDWR keeps a writer on the pipe ourselves: reads do not see an
+        // end of file between two producers and poll() blocks while none is
+        // connected
+        m_fd = ::open(localPath.constData(), O_RDWR | O_NONBLOCK);
+        if (m_fd < 0) {
+            m_error = QString::fromLocal8Bit(std::strerror(errno));
+            return false;
+        }
+    }
+
+    m_thread = QThread::create([this]() { ingest(); });
+    m_thread->start();
+    qDebug() << "StreamSource: reading" << m_name;
+    return true;
+#endif
+}
+
+void StreamSource::close()
+{
+    if (!m_thread) return;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_room.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+#ifndef Q_OS_WIN
+    if (m_isFifo) {
+        ::close(m_fd);
+    } else if (m_savedFlags >= 0) {
+        ::fcntl(m_fd, F_SETFL, m_savedFlags);
+    }
+#endif
+    m_fd = -1;
+    m_savedFlags = -1;
+}
+
+QByteArray StreamSource::take()
+{
+    QMutexLocker locker(&m_mutex);
+    QByteArray bytes;
+    bytes.swap(m_buffer);
+    m_room.wakeAll();
+    return bytes;
+}
+
+bool StreamSource::atEnd() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_ended && m_buffer.isEmpty();
+}
+
+qint64 StreamSource::bytesReceived() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_received;
+}
+
+void StreamSource::ingest()
+{
+#ifndef Q_OS_WIN
+    QByteArray chunk(kReadBytes, Qt::Uninitialized);
+    for (;;) {
+        {
+            QMutexLocker locker(&m_mutex);
+            // Backpressure: the pipe fills up while the buffer is full
+            while (m_buffer.size() >= kCapacity && !m_stopping) m_room.wait(&m_mutex);
+            if (m_stopping) return;
+        }
+
+        pollfd pending = { m_fd, POLLIN, 0 };
+        const int ready = ::poll(&pending, 1, kPollMs);
+        if (ready == 0 || (ready < 0 && errno == EINTR)) continue;
+        const ssize_t count = ready < 0 ? -1 : ::read(m_fd, chunk.data(), size_t(chunk.size()));
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+
+        QMutexLocker locker(&m_mutex);
+        if (count <= 0) {
+            if (count < 0) m_error = QString::fromLocal8Bit(std::strerror(errno));
+            m_ended = true;
+            locker.unlock();
+            qDebug() << "StreamSource:" << m_name << "ended after" << m_received << "bytes" << m_error;
+            emit readyRead();
+            return;
+        }
+        const bool wasEmpty = m_buffer.isEmpty();
+        m_buffer.append(chunk.constData(), int(count));
+        m_received += count;
+        locker.unlock();
+        // Delivered queued to the GUI thread; later chunks join the buffer
+        if (wasEmpty) emit readyRead();
+    }
+#endif
+}
@@ -0,0 +1,62 @@
+#ifndef STREAMSOURCE_H
+#define STREAMSOURCE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+
+class QThread;
+
+// Rows piped into RTPlotter (`solver | RTPlotter --stdin`) or written to a
+// named pipe. An ingest thread polls the non-blocking descriptor and never
+// seeks; bytes wait in a bounded buffer until the GUI thread takes them. A
+// full buffer stops the reads, so the pipe fills up and the producer blocks
+// instead of RTPlotter growing without bound.
+//
+// Standard input ends when the producer closes it. A FIFO is kept open across
+// writers: the next one to open it continues the same data.
+class StreamSource : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StreamSource(QObject* parent = nullptr);
+    ~StreamSource();
+
+    // "-" is standard input; any other path must be a FIFO
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_thread != nullptr; }
+    QString errorString() const { return m_error; }
+    // Name shown for the data: "stdin" or the FIFO path
+    QString name() const { return m_name; }
+
+    // Moves the buffered bytes out, making room for the ingest thread
+    QByteArray take();
+    // The producer closed standard input and every byte has been taken
+    bool atEnd() const;
+    qint64 bytesReceived() const;
+
+signals:
+    // Bytes arrived in an empty buffer; sent once until take() is called
+    void readyRead();
+
+private:
+    QString m_name;
+    QString m_error;
+    int m_fd;
+    bool m_isFifo;
+    int m_savedFlags;
+    QThread* m_thread;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_room;
+    QByteArray m_buffer;
+    qint64 m_received;
+    bool m_ended;
+    bool m_stopping;
+
+    void ingest();
+};
+
+#endif // STREAMSOURCE_H
@@ -0,0 +1,231 @@
+#include "WaterfallPanel.h"
+#include "CSVReader.h"
+#include "qcustomplot.h"
+#include <QLineEdit>
+#include <QLabel>
+#include <QRegularExpression>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <cmath>
+#include <limits>
+
+WaterfallPanel::WaterfallPanel(QWidget *parent) :
+    QDockWidget(tr("Waterfall"), parent),
+    m_reader(nullptr),
+    m_keyIndex(-1),
+    m_firstRow(0),
+    m_consumedRows(0),
+    m_stride(1),
+    m_slices(0),
+    m_minimum(0.0),
+    m_maximum(0.0),
+    m_stale(false)
+{
+    QWidget* content = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(content);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    QHBoxLayout* settingsLayout = new QHBoxLayout();
+    settingsLayout->addWidget(new QLabel(tr("Columns:"), content));
+    m_patternEdit = new QLineEdit(content);
+    m_patternEdit->setPlaceholderText(tr("plotted columns, or wildcards such as probe_*"));
+    settingsLayout->addWidget(m_patternEdit);
+    layout->addLayout(settingsLayout);
+
+    m_plot = new QCustomPlot(content);
+    m_plot->setInteraction(QCP::iRangeDrag, true);
+    m_plot->setInteraction(QCP::iRangeZoom, true);
+    m_colorMap = new QCPColorMap(m_plot->xAxis, m_plot->yAxis);
+    m_colorScale = new QCPColorScale(m_plot);
+    m_plot->plotLayout()->addElement(0, 1, m_colorScale);
+    m_colorMap->setColorScale(m_colorScale);
+    QCPColorGradient gradient(QCPColorGradient::gpJet);
+    // Slices not written yet are NaN and stay transparent
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    m_colorMap->setGradient(gradient);
+    m_colorMap->setInterpolate(false);
+    m_plot->yAxis->setLabel(tr("Probe"));
+    m_plot->setMinimumHeight(200);
+    layout->addWidget(m_plot);
+    setWidget(content);
+
+    connect(m_patternEdit, &QLineEdit::editingFinished, this, &WaterfallPanel::rebuild);
+    connect(this, &QDockWidget::visibilityChanged, this, &WaterfallPanel::onVisibilityChanged);
+}
+
+void WaterfallPanel::setSource(const CSVReader* reader, const QStringList& defaultColumns, const QString& keyColumn)
+{
+    m_reader = reader;
+    m_defaultColumns = defaultColumns;
+    m_keyIndex = reader ? reader->getColumnIndex(keyColumn) : -1;
+    m_plot->xAxis->setLabel(keyColumn);
+    rebuild();
+}
+
+QStringList WaterfallPanel::matchingColumns() const
+{
+    QStringList patterns = m_patternEdit->text().split(QRegularExpression("[\\s,;]+"), Qt::SkipEmptyParts);
+    if (patterns.isEmpty() || !m_reader) return m_defaultColumns;
+
+    QList<QRegularExpression> expressions;
+    for (const QString& pattern : patterns) {
+        expressions.append(QRegularExpression(QRegularExpression::wildcardToRegularExpression(pattern)));
+    }
+    QStringList columns;
+    for (const QString& header : m_reader->getHeaders()) {
+        for (const QRegularExpression& expression : expressions) {
+            if (expression.match(header).hasMatch()) {
+                columns.append(header);
+                break;
+            }
+        }
+    }
+    return columns;
+}
+
+void WaterfallPanel::appendRows(int firstRow)
+{
+    if (!m_reader) return;
+    if (firstRow == 0 || m_reader->getRowCount() < m_consumedRows) {
+        rebuild();
+        return;
+    }
+    if (!isVisible()) {
+        m_stale = true;
+        return;
+    }
+    consume(m_consumedRows, m_reader->getRowCount());
+    updateAxes();
+}
+
+void WaterfallPanel::onVisibilityChanged(bool visible)
+{
+    if (visible && m_stale) rebuild();
+}
+
+void WaterfallPanel::rebuild()
+{
+    m_probeIndices.clear();
+    m_firstRow = 0;
+    m_consumedRows = 0;
+    m_stride = 1;
+    m_slices = 0;
+    m_minimum = std::numeric_limits<double>::infinity();
+    m_maximum = -std::numeric_limits<double>::infinity();
+    if (!isVisible()) {
+        m_stale = true;
+        return;
+    }
+    m_stale = false;
+
+    QStringList columns = matchingColumns();
+    QSharedPointer<QCPAxisTickerText> ticker(new QCPAxisTickerText);
+    for (const QString& name : columns) {
+        int index = m_reader ? m_reader->getColumnIndex(name) : -1;
+        if (index < 0) continue;
+        // Names are only readable as tick labels for a modest probe count
+        if (columns.size() <= 40) ticker->addTick(m_probeIndices.size(), name);
+        m_probeIndices.append(index);
+    }
+    if (columns.size() <= 40) m_plot->yAxis->setTicker(ticker);
+    else m_plot->yAxis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
+
+    QCPColorMapData* data = m_colorMap->data();
+    data->setSize(kInitialSlices, qMax(1, m_probeIndices.size()));
+    data->fill(std::numeric_limits<double>::quiet_NaN());
+
+    if (m_reader && !m_probeIndices.isEmpty()) {
+        consume(0, m_reader->getRowCount());
+    }
+    updateAxes();
+}
+
+void WaterfallPanel::reserveRow(int row)
+{
+    QCPColorMapData* data = m_colorMap->data();
+    const int probes = m_probeIndices.size();
+    while ((row - m_firstRow) / m_stride >= data->keySize()) {
+        const int capacity = data->keySize();
+        if (capacity < kMaxSlices) {
+            // Double the capacity; the copy is amortised over the new slices
+            QCPColorMapData grown(capacity * 2, probes, data->keyRange(), data->valueRange());
+            grown.fill(std::numeric_limits<double>::quiet_NaN());
+            for (int p = 0; p < probes; ++p) {
+                for (int k = 0; k < m_slices; ++k) {
+                    grown.setCell(k, p, data->cell(k, p));
+                }
+            }
+            *data = grown;
+        } else {
+            // Keep one slice out of two (the later one) and double the stride
+            for (int p = 0; p < probes; ++p) {
+                for (int k = 0; k < capacity / 2; ++k) {
+                    int source = 2 * k + 1 < m_slices ? 2 * k + 1 : 2 * k;
+                    data->setCell(k, p, data->cell(source, p));
+                }
+                for (int k = capacity / 2; k < capacity; ++k) {
+                    data->setCell(k, p, std::numeric_limits<double>::quiet_NaN());
+                }
+            }
+            m_stride *= 2;
+            m_slices = (m_slices + 1) / 2;
+        }
+    }
+}
+
+void WaterfallPanel::consume(int firstRow, int lastRow)
+{
+    if (m_probeIndices.isEmpty() || firstRow >= lastRow) return;
+    QCPColorMapData* data = m_colorMap->data();
+    QVector<const double*> probes;
+    for (int index : m_probeIndices) {
+        const QVector<double>& values = m_reader->getColumn(index);
+        if (values.size() < lastRow) return;
+        probes.append(values.constData());
+    }
+
+    for (int r = firstRow; r < lastRow; ++r) {
+        reserveRow(r);
+        int slice = (r - m_firstRow) / m_stride;
+        // One image column per slice; with a stride the latest row wins
+        for (int p = 0; p < probes.size(); ++p) {
+            double value = probes[p][r];
+            data->setCell(slice, p, value);
+            if (value < m_minimum) m_minimum = value;
+            if (value > m_maximum) m_maximum = value;
+        }
+        m_slices = slice + 1;
+    }
+    m_consumedRows = lastRow;
+}
+
+void WaterfallPanel::updateAxes()
+{
+    QCPColorMapData* data = m_colorMap->data();
+    const int probes = m_probeIndices.size();
+    data->setValueRange(QCPRange(0, qMax(0, probes - 1)));
+
+    // Slices are evenly spaced in rows; map them onto the mean X spacing
+    double x0 = 0.0;
+    double spacing = 1.0;
+    int rowCount = m_consumedRows - m_firstRow;
+    if (m_keyIndex >= 0 && rowCount > 0) {
+        const QVector<double>& x = m_reader->getColumn(m_keyIndex);
+        if (x.size() >= m_consumedRows) {
+            x0 = x[m_firstRow];
+            if (rowCount > 1) spacing = (x[m_consumedRows - 1] - x0) / (rowCount - 1);
+        }
+    } else {
+        x0 = m_firstRow;
+    }
+    if (spacing == 0.0) spacing = 1.0;
+    double sliceWidth = spacing * m_stride;
+    data->setKeyRange(QCPRange(x0, x0 + sliceWidth * (data->keySize() - 1)));
+
+    if (m_minimum <= m_maximum) {
+        m_colorMap->setDataRange(QCPRange(m_minimum, m_maximum));
+    }
+    m_plot->xAxis->setRange(x0, x0 + sliceWidth * qMax(1, m_slices - 1));
+    m_plot->yAxis->setRange(-0.5, qMax(0, probes - 1) + 0.5);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
@@ -0,0 +1,59 @@
+#ifndef WATERFALLPANEL_H
+#define WATERFALLPANEL_H
+
+#include <QDockWidget>
+#include <QStringList>
+#include <QVector>
+
+class QLineEdit;
+class QCustomPlot;
+class QCPColorMap;
+class QCPColorScale;
+class CSVReader;
+
+// Renders a set of probe columns as a colour map: X (time) on the key axis,
+// probe index on the value axis and the value as colour. Appended rows only
+// write their own time slice; the slice capacity doubles as the run grows
+// and, past kMaxSlices, adjacent slices are merged so memory stays bounded.
+class WaterfallPanel : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit WaterfallPanel(QWidget *parent = nullptr);
+
+    // `defaultColumns` are shown when the pattern is empty
+    void setSource(const CSVReader* reader, const QStringList& defaultColumns, const QString& keyColumn);
+    // Writes rows appended since the last call; firstRow == 0 restarts
+    void appendRows(int firstRow);
+
+private slots:
+    void rebuild();
+    void onVisibilityChanged(bool visible);
+
+private:
+    static const int kInitialSlices = 256;
+    static const int kMaxSlices = 4096;
+
+    const CSVReader* m_reader;
+    QStringList m_defaultColumns;
+    int m_keyIndex;
+    QVector<int> m_probeIndices;
+    int m_firstRow;
+    int m_consumedRows;
+    int m_stride;       // rows per slice
+    int m_slices;       // slices written so far
+    double m_minimum;
+    double m_maximum;
+    bool m_stale;
+    QLineEdit* m_patternEdit;
+    QCustomPlot* m_plot;
+    QCPColorMap* m_colorMap;
+    QCPColorScale* m_colorScale;
+
+    QStringList matchingColumns() const;
+    void consume(int firstRow, int lastRow);
+    void reserveRow(int row);
+    void updateAxes();
+};
+
+#endif // WATERFALLPANEL_H
@@ -32,6 +32,19 @@ int main(int argc, char *argv[])
                                         QCoreApplication::translate("main", "file"));
         parser.addOption(projectOption);
 
+        // Streaming sources: `solver | RTPlotter --stdin`, or a named pipe
+        QCommandLineOption stdinOption(QStringList() << "stdin",
+                                       QCoreApplication::translate("main", "Plot rows read from standard input"));
+        parser.addOption(stdinOption);
+        QCommandLineOption fifoOption(QStringList() << "fifo",
+                                      QCoreApplication::translate("main", "Plot rows written to the named pipe <path>"),
+                                      QCoreApplication::translate("main", "path"));
+        parser.addOption(fifoOption);
+        QCommandLineOption shmOption(QStringList() << "shm",
+                                     QCoreApplication::translate("main", "Plot binary records from the shared-memory ring <name>"),
+                                     QCoreApplication::translate("main", "name"));
+        parser.addOption(shmOption);
+
         // Process the actual command line arguments given by the user
         parser.process(app);
 
@@ -47,6 +60,18 @@ int main(int argc, char *argv[])
             w->addRecentProject(projectFile);
         }
 
+        if (parser.isSet(stdinOption) || parser.isSet(fifoOption)) {
+            QString source = parser.isSet(fifoOption) ? parser.value(fifoOption) : QString("-");
+            if (!w->openStream(source)) {
+                qCritical() << "Failed to read stream:" << source;
+                return -1;
+            }
+        }
+        if (parser.isSet(shmOption) && !w->openSharedRing(parser.value(shmOption))) {
+            qCritical() << "Failed to attach shared-memory ring:" << parser.value(shmOption);
+            return -1;
+        }
+
         w->show();
         return app.exec();
     } catch (const std::exception& e) {
@@ -0,0 +1,163 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cmath>
+#include "CSVReader.h"
+#include "ParseCache.h"
+
+class TestCSVReader : public QObject
+{
+    Q_OBJECT
+private slots:
+    void trailingSeparator();
+    void parseCacheKeepsSegmentKey();
+    void fixedWidthSidecarRoundTrip();
+    void overflowRow();
+    void derivedChannelsAcrossAddedColumns();
+};
+
+void TestCSVReader::trailingSeparator()
+{
+    // Every line, the header included, is closed by a separator
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("trailing_separator.csv");
+    QVERIFY(QFile::copy(RTPLOTTER_TEST_DATA "/trailing_separator.csv", path));
+    QFile::setPermissions(path, QFile::ReadOwner | QFile::WriteOwner);
+
+    CSVReader reader;
+    reader.setFile(path);
+    reader.setSeparator(',');
+    reader.setHasHeader(true);
+    QVERIFY(reader.parse());
+    QCOMPARE(reader.getRawHeaders(), QStringList({ "time", "p", "U" }));
+    QCOMPARE(reader.getColumnCount(), 3);
+    QCOMPARE(reader.getRowCount(), 3);
+    QCOMPARE(reader.getColumn(2).last(), 4.0);
+    const int schemaVersion = reader.getSchemaVersion();
+
+    // Appended rows extend the columns without adding an empty one
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::Append));
+    file.write("3,4,5,\n4,5,6,  \n");
+    file.close();
+    QVERIFY(reader.readNewLines());
+    QCOMPARE(reader.getRowCount(), 5);
+    QCOMPARE(reader.getColumnCount(), 3);
+    QCOMPARE(reader.getSchemaVersion(), schemaVersion);
+    QCOMPARE(reader.getColumn(2).last(), 6.0);
+}
+
+void TestCSVReader::parseCacheKeepsSegmentKey()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("history.csv");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("time,p\n");
+    for (int row = 0; row < 1000; ++row) file.write(QByteArray::number(row) + "," + QByteArray::number(2 * row) + "\n");
+    file.close();
+
+    // An import parses tail-first before the plots set the segment key
+    ParseCache cache;
+    CSVReader imported;
+    imported.setFile(path);
+    QVERIFY(cache.parse(imported, 256));
+    QVERIFY(!imported.isComplete());
+
+    // The backfilled history is stored once the X column is known
+    imported.setSegmentKey("time");
+    QVERIFY(imported.parse());
+    cache.store(imported);
+
+    // Opening the file again is served the whole history
+    CSVReader reopened;
+    reopened.setFile(path);
+    QVERIFY(cache.parse(reopened, 256));
+    QVERIFY(reopened.isComplete());
+    QCOMPARE(reopened.getRowCount(), 1000);
+    QCOMPARE(reopened.getSegmentKey(), QString());
+    QCOMPARE(reopened.getSegmentStarts(), QVector<int>({ 0 }));
+}
+
+void TestCSVReader::fixedWidthSidecarRoundTrip()
+{
+    // Fortran output: fixed-width columns under a "#" header, comments between rows
+    const QString path = RTPLOTTER_TEST_DATA "/fixed_width.dat";
+    CSVReader configured;
+    configured.setFile(path);
+    configured.setStartLine(2);
+    configured.setHasHeader(true);
+    configured.setCommentPrefix("#");
+    configured.setFixedWidths({ 7, 10, 10 });
+
+    // Written and read back like the "parser" object of a sidecar
+    QJsonObject parser = configured.toJson();
+    parser.remove("filePath");
+    const QByteArray sidecar = QJsonDocument(parser).toJson();
+    CSVReader restored;
+    restored.fromJson(QJsonDocument::fromJson(sidecar).object());
+    restored.setFile(path);
+    QCOMPARE(restored.getCommentPrefix(), QString("#"));
+    QCOMPARE(restored.getFixedWidths(), QVector<int>({ 7, 10, 10 }));
+
+    QVERIFY(restored.parse());
+    QCOMPARE(restored.getRawHeaders(), QStringList({ "step", "resid", "cfl" }));
+    QCOMPARE(restored.getRowCount(), 3);
+    QCOMPARE(restored.getColumn(1).at(1), 0.05);
+    QCOMPARE(restored.getColumn(2).at(2), 0.125);
+}
+
+void TestCSVReader::overflowRow()
+{
+    // A row of Fortran overflow markers is a row of gaps, not a header
+    CSVReader reader;
+    reader.setFile(RTPLOTTER_TEST_DATA "/overflow_row.csv");
+    reader.setSegmentKey("time");
+    QVERIFY(reader.parse());
+    QCOMPARE(reader.getRawHeaders(), QStringList({ "time", "p" }));
+    QCOMPARE(reader.getRowCount(), 4);
+    QVERIFY(std::isnan(reader.getColumn(0).at(2)));
+    QVERIFY(std::isnan(reader.getColumn(1).at(2)));
+    QCOMPARE(reader.getColumn(1).at(3), 4.0);
+    QCOMPARE(reader.getSegmentStarts(), QVector<int>({ 0 }));
+}
+
+void TestCSVReader::derivedChannelsAcrossAddedColumns()
+{
+    // A header line adds a column in the middle of the first parse, then of an append
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("added_column.csv");
+    QVERIFY(QFile::copy(RTPLOTTER_TEST_DATA "/added_column.csv", path));
+    QFile::setPermissions(path, QFile::ReadOwner | QFile::WriteOwner);
+
+    DerivedChannel average;
+    average.name = "p_avg";
+    average.source = "p";
+    average.kind = DerivedChannel::MovingAverage;
+    average.window = 2;
+    CSVReader reader;
+    reader.setFile(path);
+    reader.setDerivedChannels({ average });
+    QVERIFY(reader.parse());
+    QCOMPARE(reader.getHeaders(), QStringList({ "time", "p", "U", "p_avg" }));
+    QCOMPARE(reader.getRowCount(), 4);
+    for (int c = 0; c < reader.getColumnCount(); ++c) QCOMPARE(int(reader.getColumn(c).size()), reader.getRowCount());
+    QCOMPARE(reader.getColumn(reader.getColumnIndex("p_avg")).last(), 3.5);
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::Append));
+    file.write("5,5,50\ntime,p,U,V\n6,6,60,600\n");
+    file.close();
+    QVERIFY(reader.readNewLines());
+    QCOMPARE(reader.getRowCount(), 6);
+    QCOMPARE(reader.getColumnCount(), 5);
+    for (int c = 0; c < reader.getColumnCount(); ++c) QCOMPARE(int(reader.getColumn(c).size()), reader.getRowCount());
+    QCOMPARE(reader.getColumn(reader.getColumnIndex("p_avg")).last(), 5.5);
+}
+
+QTEST_APPLESS_MAIN(TestCSVReader)
+#include "tst_csvreader.moc"